@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A pattern of bytes where some of the bytes can have any value, written as hex bytes with wildcards,
+// e.g. "48 8B 05 ?? ?? ?? ?? 89"
+// '??' matches any byte, and a '?' in place of one digit matches any value of that digit (e.g. "4?").
+// The spaces between the bytes are optional.
+class AobPattern
+{
+public:
+    AobPattern(const std::string& patternStr);
+    // The mask has the bits which have to match set, a mask of 0 makes the byte a wildcard
+    AobPattern(const std::vector<uint8_t>& bytes, const std::vector<uint8_t>& mask);
+
+    // Returns the first match which is fully inside [begin, end), or nullptr if there is none
+    const uint8_t* FindNext(const uint8_t* begin, const uint8_t* end) const;
+    // Expects at least GetSize() bytes
+    bool Matches(const uint8_t* data) const;
+
+    size_t GetSize() const;
+    bool HasWildcards() const;
+    const std::vector<uint8_t>& GetBytes() const;
+    const std::vector<uint8_t>& GetMask() const;
+    std::string ToString() const;
+
+private:
+    void ChooseAnchors();
+
+    std::vector<uint8_t> m_Bytes; // The bytes are stored masked
+    std::vector<uint8_t> m_Mask;
+
+    // The positions of the two fixed bytes which are the least common in machine code
+    // Searches only check the whole pattern where both of them match.
+    size_t m_FirstAnchor;
+    size_t m_SecondAnchor;
+};
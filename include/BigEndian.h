@@ -0,0 +1,112 @@
+#pragma once
+#include <bit>
+#include <compare>
+#include <cstdint>
+#include <type_traits>
+
+// A number which is stored in memory in big-endian byte order
+// It has the size and the memory representation of the stored value, so it can be used as the type
+// of the templates which read, compare and write values. The bytes are swapped to the native order
+// only when the value is compared.
+template <typename T>
+class BigEndian
+{
+    static_assert(std::is_arithmetic_v<T> && sizeof(T) > 1, "Only numbers of at least 2 bytes have a byte order.");
+
+public:
+    using ValueType = T;
+
+    BigEndian() = default;
+    explicit BigEndian(T value);
+
+    T GetValue() const;
+
+    bool operator==(const BigEndian& rhs) const;
+    std::partial_ordering operator<=>(const BigEndian& rhs) const;
+
+    // Swaps the bytes of a value between the native and the big-endian order
+    static T SwapBytes(T value);
+
+private:
+    T m_Value; // Holds the bytes in big-endian order
+};
+
+template <typename T>
+constexpr bool IsBigEndian = false;
+
+template <typename T>
+constexpr bool IsBigEndian<BigEndian<T>> = true;
+
+// The type which the values of T are compared as
+template <typename T>
+struct NativeTypeOf
+{
+    using Type = T;
+};
+
+template <typename T>
+struct NativeTypeOf<BigEndian<T>>
+{
+    using Type = T;
+};
+
+// Returns the value of a number in the native order, whether it is big-endian or not
+template <typename T>
+typename NativeTypeOf<T>::Type ToNativeValue(T value)
+{
+    if constexpr (IsBigEndian<T>)
+    {
+        return value.GetValue();
+    }
+    else
+    {
+        return value;
+    }
+}
+
+
+template <typename T>
+BigEndian<T>::BigEndian(T value)
+{
+    this->m_Value = SwapBytes(value);
+}
+
+template <typename T>
+inline T BigEndian<T>::GetValue() const
+{
+    return SwapBytes(this->m_Value);
+}
+
+// The values are compared as numbers rather than as bytes, so that floats compare like native ones
+template <typename T>
+inline bool BigEndian<T>::operator==(const BigEndian& rhs) const
+{
+    return this->GetValue() == rhs.GetValue();
+}
+
+template <typename T>
+inline std::partial_ordering BigEndian<T>::operator<=>(const BigEndian& rhs) const
+{
+    return this->GetValue() <=> rhs.GetValue();
+}
+
+template <typename T>
+inline T BigEndian<T>::SwapBytes(T value)
+{
+    if constexpr (std::endian::native == std::endian::big)
+    {
+        return value;
+    }
+    else if constexpr (sizeof(T) == 2)
+    {
+        return std::bit_cast<T>(__builtin_bswap16(std::bit_cast<uint16_t>(value)));
+    }
+    else if constexpr (sizeof(T) == 4)
+    {
+        return std::bit_cast<T>(__builtin_bswap32(std::bit_cast<uint32_t>(value)));
+    }
+    else
+    {
+        return std::bit_cast<T>(__builtin_bswap64(std::bit_cast<uint64_t>(value)));
+    }
+}
@@ -9,7 +9,17 @@ enum class ComparisonType
     Less,
     GreaterEqual,
     LessEqual,
+    // The ranges are compared with two values, the low bound and the high bound (inclusive)
+    Between,
+    Outside,
+    // The tolerances of floats, they are turned into the range of values they accept before scanning
+    Approximate,
+    Ulps,
+    Rounded,
+    Truncated,
 };
 
 ComparisonType ParseComparisonType(const std::string& keywordStr);
+bool IsRangeComparison(ComparisonType cmpType);
+bool IsToleranceComparison(ComparisonType cmpType);
 
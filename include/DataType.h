@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <cstddef>
 
 enum class DataType
 {
@@ -14,7 +15,22 @@ enum class DataType
     f32,
     f64,
     string,
+    aob, // A pattern of bytes with wildcards, see AobPattern.h
+    // The numbers stored in big-endian byte order, see BigEndian.h
+    be_int16,
+    be_int32,
+    be_int64,
+    be_uint16,
+    be_uint32,
+    be_uint64,
+    be_f32,
+    be_f64,
 };
 
+// The prefix 'be' makes a numeric type of at least 2 bytes big-endian, e.g. beuint32
 DataType ParseDataType(const std::string& typeStr);
-
+// Returns the size of a value of the type, or 0 for strings and byte patterns since their size
+// depends on the value
+size_t GetDataTypeSize(DataType dataType);
+// Returns the name of the type, as it is parsed by ParseDataType
+std::string DataTypeToString(DataType dataType);
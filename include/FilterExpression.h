@@ -0,0 +1,168 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "DataType.h"
+
+// A condition which the saved addresses of a scan are filtered with, e.g.
+// value > old && value - old <= 5
+// (value & 0xFF00) == 0x1200 && int32[+8] != 0
+//
+// The names which can be used are:
+// value -- The value at the address, read as the type of the filter
+// old -- The value at the address when the previous scan was done, read as the same type
+// addr -- The address itself
+// <type>[<offset>] -- A neighbouring field of the given type at the offset from the address
+//
+// Integers are evaluated as 64-bit signed numbers and floats as doubles, an operation between an
+// integer and a float converts the integer. The operators and their precedence are the same as in C,
+// except that both sides of && and || are always evaluated.
+//
+// The expression is parsed once and compiled to instructions which each run over a whole batch of
+// addresses, so decoding an instruction costs the same for a batch as for a single address and the
+// loops of the instructions can be vectorized.
+class FilterExpression
+{
+public:
+    FilterExpression(const std::string& expression, DataType dataType);
+
+    DataType GetDataType() const;
+    // The range of bytes around an address which the expression reads, relative to the address
+    // It always contains the value itself.
+    long GetWindowOffset() const;
+    size_t GetWindowSize() const;
+
+    // Evaluates the expression for a batch of at most BATCH_SIZE addresses
+    // windows holds the window of every address back to back, and oldValues the bytes of the value
+    // at every address in the previous scan. results is set to 1 where the expression is true and to
+    // 0 elsewhere.
+    void Evaluate(const uint8_t* windows, const uint64_t* oldValues, const unsigned long* addresses,
+            size_t count, uint8_t* results);
+
+    static constexpr size_t BATCH_SIZE = 512;
+
+private:
+    enum class OpCode : uint8_t
+    {
+        // Loads
+        LoadField, // Reads the field at the offset in the window of every address
+        LoadOld,
+        LoadAddress,
+        // Conversions
+        IntToFloat,
+        FloatToBool,
+        // Integers
+        IntAdd,
+        IntSub,
+        IntMul,
+        IntDiv,
+        IntMod,
+        IntAnd,
+        IntOr,
+        IntXor,
+        IntShl,
+        IntShr,
+        IntEq,
+        IntNe,
+        IntLt,
+        IntLe,
+        IntGt,
+        IntGe,
+        LogicalAnd,
+        LogicalOr,
+        IntNeg,
+        IntNot,
+        IntBitNot,
+        // Floats, the comparisons result in integers
+        FloatAdd,
+        FloatSub,
+        FloatMul,
+        FloatDiv,
+        FloatEq,
+        FloatNe,
+        FloatLt,
+        FloatLe,
+        FloatGt,
+        FloatGe,
+        FloatNeg,
+        FloatNot,
+    };
+
+    enum class ValueKind : uint8_t
+    {
+        Int,
+        Float,
+    };
+
+    // Every instruction writes a register of its own, which is never written by another one
+    struct Instruction
+    {
+        OpCode op;
+        DataType dataType; // The type of the loads
+        uint16_t dst;
+        uint16_t lhs;
+        uint16_t rhs;
+        long offset; // The offset of the field from the address
+    };
+
+    struct Constant
+    {
+        uint16_t reg;
+        ValueKind kind;
+        int64_t intValue;
+        double floatValue;
+    };
+
+    // A register, which holds a value for every address in a batch
+    // The kind of a register is known when the expression is compiled, so only one of the arrays is
+    // ever used.
+    union Column
+    {
+        int64_t ints[BATCH_SIZE];
+        double floats[BATCH_SIZE];
+    };
+
+    struct Operand
+    {
+        uint16_t reg;
+        ValueKind kind;
+    };
+
+    struct Token
+    {
+        enum class Kind : uint8_t
+        {
+            Number,
+            Name,
+            Operator,
+            End,
+        };
+
+        Kind kind;
+        std::string text;
+    };
+
+    static std::vector<Token> Tokenize(const std::string& expression);
+
+    // The parser emits the instructions while it goes over the tokens
+    Operand ParseBinary(const std::vector<Token>& tokens, size_t& pos, int minPrecedence);
+    Operand ParseUnary(const std::vector<Token>& tokens, size_t& pos);
+    Operand ParsePrimary(const std::vector<Token>& tokens, size_t& pos);
+
+    Operand EmitBinary(const std::string& opStr, Operand lhs, Operand rhs);
+    Operand EmitLoad(OpCode op, DataType dataType, long offset);
+    Operand EmitConstant(const std::string& numberStr);
+    Operand Emit(OpCode op, ValueKind kind, uint16_t lhs, uint16_t rhs);
+    Operand ToFloat(Operand operand);
+
+    DataType m_DataType;
+    long m_WindowOffset;
+    size_t m_WindowSize;
+    uint16_t m_ResultReg;
+
+    std::vector<Instruction> m_Instructions;
+    // The constants are written to their registers once, before the first batch
+    std::vector<Constant> m_Constants;
+    std::vector<Column> m_Registers;
+};
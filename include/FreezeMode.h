@@ -0,0 +1,17 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Decides when a frozen value is written
+enum class FreezeMode : uint8_t
+{
+    Set, // Always write the value
+    Changed, // Write the value only if the current value is different
+    Min, // Write the value only if the current value is less than it
+    Max, // Write the value only if the current value is greater than it
+    Increase, // Allow the current value to only increase, decreases are reverted
+    Decrease, // Allow the current value to only decrease, increases are reverted
+};
+
+FreezeMode ParseFreezeMode(const std::string& modeStr);
+std::string FreezeModeToString(FreezeMode mode);
@@ -3,19 +3,112 @@
 #include <string>
 #include <sys/types.h>
 #include <vector>
-#include <list>
 #include "MemoryStructs.h"
+#include "MemoryFuncs.h"
 #include <mutex>
-#include <queue>
+#include <condition_variable>
+#include <thread>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <unordered_set>
+#include "SpscRing.h"
+#include "DataType.h"
+#include "FreezeMode.h"
 
-struct FrozenMemAddress
+// A reference to an entry in the freeze list which stays valid when other entries are removed
+// Once the entry itself is removed, the generation of its slot changes and the handle becomes invalid
+struct FreezeHandle
 {
-    MemAddress memAddress;
-    bool enabled; // A flag which tells the program whether the address should be frozen
-    std::string typeStr; // Only used for printing to the user
-    std::string dataStr; // Also only used for printing to the user (removes the need for a template)
-    std::vector<uint8_t> data; // The data which will be continually written to the address
+    uint32_t slot;
+    uint32_t generation;
+};
+
+// The part of an entry which is used by the freezer thread, kept small so that the table can be
+// scanned linearly
+struct FrozenEntry
+{
+    unsigned long address;
+    uint32_t dataOffset; // The offset of the data in the payload arena
+    uint32_t dataSize;
+    FreezeHandle handle; // The handle which refers to this entry
+    DataType dataType; // Used for comparing the current value in modes other than Set
+    bool used; // Removed entries leave a free row behind, which the next added entry takes
+};
+
+// The settings of an entry which can change without publishing a new version of the list
+// They are written by the thread of the user and read directly by the freezer threads, which only
+// go over their own entries when they change instead of rebuilding their write plans.
+struct EntryControl
+{
+    // The generation of the handle of the entry in the slot, in the low 32 bits, and the failed flag
+    // The flag is set by a freezer thread when a transfer fails, until the entry is enabled again. It
+    // is in the same word as the generation so that a thread can't set it on a newer entry in the slot.
+    std::atomic<uint64_t> state;
+    std::atomic<uint32_t> intervalUs; // How often the address is frozen in microseconds, 0 uses the tick rate
+    std::atomic<FreezeMode> mode;
+    std::atomic<bool> enabled; // A flag which tells the program whether the address should be frozen
+
+    static constexpr uint64_t FAILED_FLAG = 1ull << 32;
+
+    // Starts the control over for a new entry in the slot
+    void Reset(uint32_t generation);
+    // Sets the failed flag only if the slot still holds the entry with the given generation
+    void SetFailed(uint32_t generation);
+    void ClearFailed();
+    bool HasFailed() const;
+    // Whether the slot holds the entry with the given generation and it didn't fail
+    bool IsUsable(uint32_t generation) const;
+};
+
+// The part of an entry which is only used for printing to the user
+struct FrozenEntryInfo
+{
+    std::string typeStr;
+    std::string dataStr; // Removes the need for a template when printing the data
     std::string note; // An optional user note about the saved memory address
+    std::string pathName; // The pathname of the memory region of the address
+};
+
+// An immutable copy of the freeze list
+// A new version is published atomically whenever the list changes, and the threads and readers keep
+// using the version they loaded for as long as they need it, without locking the list.
+// The parts which didn't change are shared between versions.
+struct FreezeListSnapshot
+{
+    uint64_t version;
+    pid_t pid;
+    // Indexed by the slot of the handle of an entry, the rows which aren't used are skipped
+    std::shared_ptr<const std::vector<FrozenEntry>> entries;
+    // Parallel to entries, the info of every entry is shared between the versions so that the
+    // strings aren't copied when the list is published
+    std::shared_ptr<const std::vector<std::shared_ptr<const FrozenEntryInfo>>> entryInfo;
+    std::shared_ptr<const std::vector<uint8_t>> payloadArena;
+    // Indexed by the slot of the handle of an entry, shared by the versions until more slots are needed
+    std::shared_ptr<std::vector<EntryControl>> controls;
+
+    const EntryControl& GetControl(const FrozenEntry& entry) const;
+
+    // Returns the indices of all the used entries sorted by address
+    // They are sorted once, by the first thread which needs them
+    const std::vector<uint32_t>& GetAddressOrder() const;
+
+private:
+    mutable std::once_flag m_AddressOrderFlag;
+    mutable std::vector<uint32_t> m_AddressOrder;
+};
+
+// A record of a failed write in the freezer thread
+// The thread only fills these in, they are formatted when they are printed
+struct FreezeEvent
+{
+    FreezeHandle handle;
+    unsigned long address;
+    bool readFailed; // Whether the failure happened when reading the current value
+    int err; // The errno of the failed transfer, or 0 if it was a partial transfer
+    uint32_t bytesTransferred;
+    uint32_t bytesExpected;
+    std::chrono::system_clock::time_point timestamp;
 };
 
 class MemoryFreezer
@@ -26,6 +119,10 @@ public:
 
     void AddAddress(MemAddress memAddress, const std::string& typeStr, const std::string& dataStr,
             std::vector<uint8_t>& data, const std::string& note);
+    // Adds all the writable addresses which aren't in the list yet with the same data, and returns
+    // the amount of addresses that were added
+    size_t AddAddresses(const std::vector<MemAddress>& memAddrs, const std::string& typeStr,
+            const std::string& dataStr, const std::vector<uint8_t>& data, const std::string& note);
     void RemoveAddress(size_t index);
     void RemoveAllAddresses();
 
@@ -39,26 +136,185 @@ public:
     void ModifyAllAddresses(const std::string& typeStr, const std::string& dataStr,
             std::vector<uint8_t>& data, const std::string& note);
 
-    const std::list<FrozenMemAddress>& GetFrozenAddresses() const;
+    void SetAddressMode(size_t index, FreezeMode mode);
+    void SetAllAddressesMode(FreezeMode mode);
+
+    // An interval of 0 makes the address use the default interval given by the tick rate
+    void SetAddressInterval(size_t index, uint32_t intervalUs);
+    void SetAllAddressesInterval(uint32_t intervalUs);
+
+    // Returns the latest published version of the list, which never changes once it is loaded
+    std::shared_ptr<const FreezeListSnapshot> GetSnapshot() const;
+    size_t GetFrozenAddressesAmount() const;
     int GetEnabledAddressesAmount() const;
 
+    FreezeHandle GetHandle(size_t index) const;
+    bool IsHandleValid(FreezeHandle handle) const;
+
     void SetPid(pid_t pid);
 
-    std::string MessageQueuePop();
-    size_t GetMessageQueueSize() const;
+    // The addresses are split by their address between this amount of threads
+    void SetShardCount(unsigned int shardCount);
+    unsigned int GetShardCount() const;
+
+    // The rate at which the enabled addresses without an interval of their own are rewritten,
+    // in ticks per second
+    void SetTickRate(unsigned int ticksPerSecond);
+    unsigned int GetTickRate() const;
+
+    // Takes the events sent by the freezer thread and disables the addresses that failed
+    // Only the events of addresses which were still enabled are returned. The addresses whose
+    // events were dropped are disabled as well.
+    std::vector<FreezeEvent> PollEvents();
+    // Returns the amount of events that didn't fit in the event ring since the last call
+    uint64_t PollDroppedEventsAmount();
+
+    static constexpr unsigned int DEFAULT_TICK_RATE = 1000;
+    static constexpr unsigned int MAX_TICK_RATE = 100000;
+    static constexpr unsigned int MAX_SHARD_COUNT = 64;
+    static constexpr size_t EVENT_RING_SIZE = 1024;
+    // Entries which are due within this window of each other are written together
+    static constexpr std::chrono::microseconds GROUPING_WINDOW = std::chrono::microseconds(50);
 
 private:
-    void StartThreadLoopIfNeeded();
-    void ThreadLoop();
+    struct PlanEntry
+    {
+        unsigned long address;
+        uint32_t dataOffset; // The offset of the data in the payload copies and the read buffer of the plan
+        uint32_t dataSize;
+        uint32_t readRequest; // The index of the read request in the current tick
+        FreezeHandle handle;
+        DataType dataType;
+        // The settings of the entry, as they were when the controls were last read
+        FreezeMode mode;
+        bool active; // Whether the entry is enabled and didn't fail
+        uint32_t intervalUs;
+        std::chrono::nanoseconds interval;
+        // The deadline in the schedule which is still valid, the others are skipped
+        std::chrono::steady_clock::time_point nextDeadline;
+        bool scheduled; // Whether nextDeadline is still in the schedule
+    };
+
+    struct ScheduledEntry
+    {
+        std::chrono::steady_clock::time_point deadline;
+        uint32_t entryIndex;
+    };
+
+    // A copy of the enabled addresses sorted by address, along with the schedule of when each one
+    // is due next. It is rebuilt only when the freeze list changes, so the lock isn't held while writing.
+    struct WritePlan
+    {
+        uint64_t version;
+        uint64_t controlVersion;
+        uint32_t shardIndex;
+        pid_t pid;
+        std::chrono::nanoseconds tickInterval;
+        std::vector<PlanEntry> entries;
+        std::shared_ptr<std::vector<EntryControl>> controls;
+
+        // The data of the entries as it was when the plan was built
+        std::vector<uint8_t> payload;
+        // The values which are written, the modes Increase and Decrease move them along with the
+        // current value and the other modes always write the payload
+        std::vector<uint8_t> values;
+
+        // A min-heap of the next deadline of every active entry
+        // An entry which is rescheduled early leaves its old deadline behind, which is skipped
+        std::vector<ScheduledEntry> schedule;
+        std::vector<ScheduledEntry> rescheduled;
+        std::vector<uint32_t> dueEntries; // The entries which are processed in the current tick
+
+        // The current values of the due entries with a mode other than Set are read in one batch
+        // Every entry has room in the buffer, since the mode can change without rebuilding the plan
+        std::vector<MemIoRequest> readRequests;
+        std::vector<uint8_t> readBuffer;
+
+        // The writes of the current tick
+        std::vector<MemIoRequest> writeRequests;
+        std::vector<uint32_t> writeEntries;
+    };
+
+    void StartWorkersIfNeeded();
+    void StopWorkers();
+    void ShardLoop(uint32_t shardIndex);
+    void BuildWritePlan(WritePlan& plan, uint32_t shardIndex);
+    void SyncControls(WritePlan& plan);
+    void ReadControl(WritePlan& plan, uint32_t entryIndex, std::chrono::steady_clock::time_point now);
+    void TakeDueEntries(WritePlan& plan, std::chrono::steady_clock::time_point now);
+    void ProcessTick(WritePlan& plan);
+    void ReportFailure(WritePlan& plan, uint32_t entryIndex, const MemIoRequest& req, bool readFailed);
+
+    // The parts of the list which were changed, only they are copied when a snapshot is published
+    enum ListChange : uint8_t
+    {
+        None = 0,
+        Entries = 1 << 0,
+        Info = 1 << 1,
+        Data = 1 << 2,
+        All = Entries | Info | Data,
+    };
+
+    // These functions expect the mutex to be locked
+    void NotifyListChanged(uint8_t changes);
+    // Tells the threads to read the controls of their entries again, without a new version of the list
+    void NotifyControlsChanged();
+    EntryControl& GetControl(size_t index);
+    void PublishSnapshot(uint8_t changes);
+    void CheckIndex(size_t index) const;
+    void CheckMode(DataType dataType, FreezeMode mode) const;
+    uint32_t StoreData(const std::vector<uint8_t>& data);
+    void CompactArena();
+    void ClearEntries();
+    void InsertEntry(const MemAddress& memAddress, DataType dataType, const std::string& typeStr,
+            const std::string& dataStr, const std::vector<uint8_t>& data, const std::string& note);
 
     int m_EnabledAddressesAmount;
-    bool m_ThreadRunning;
+
+    // The worker threads, one for every shard
+    // They are only started and stopped by the thread of the user
+    std::vector<std::thread> m_Workers;
+    uint32_t m_ShardCount;
+    std::atomic<bool> m_StopWorkers;
 
     pid_t m_pid;
-    std::list<FrozenMemAddress> m_FrozenAddresses;
-    std::list<FrozenMemAddress>::iterator m_FrozenAddressIter;
+
+    // Only guards the list against other changes, the threads read the published snapshots instead
     std::mutex m_MemoryFreezerMutex;
 
-    std::queue<std::string> m_MessageQueue; // A queue for messages from the memory freezer thread
-};
+    // The row of an entry is the slot of its handle and the index that is shown to the user
+    // A removed entry only frees its row, so the indices of the other entries never change
+    std::vector<FrozenEntry> m_Entries;
+    std::vector<std::shared_ptr<const FrozenEntryInfo>> m_EntryInfo; // Parallel to m_Entries
+    // The addresses of all the entries, used to reject duplicates without going over the list
+    std::unordered_set<unsigned long> m_FrozenAddresses;
+
+    // The data of all the entries, packed together
+    // Removed and replaced data is left in place until it makes up half of the arena
+    std::vector<uint8_t> m_PayloadArena;
+    size_t m_PayloadGarbage;
 
+    // The generations are kept when the list is cleared, so the old handles stay invalid
+    std::vector<uint32_t> m_SlotGenerations;
+    std::vector<uint32_t> m_FreeSlots; // The rows of removed entries
+
+    std::atomic<std::shared_ptr<const FreezeListSnapshot>> m_Snapshot;
+    // The controls of all the slots, reallocated with room for more slots when they run out
+    std::shared_ptr<std::vector<EntryControl>> m_Controls;
+
+    // The version of the latest snapshot, tells the threads to rebuild their write plans
+    std::atomic<uint64_t> m_Version;
+    // Changed along with the controls
+    std::atomic<uint64_t> m_ControlVersion;
+    std::atomic<unsigned int> m_TickRate;
+
+    // Used by the threads to sleep until their next deadline
+    std::mutex m_WakeMutex;
+    std::condition_variable m_WakeCondition;
+
+    // Events from the worker threads to the thread of the user, one ring for every shard
+    std::vector<std::unique_ptr<SpscRing<FreezeEvent, EVENT_RING_SIZE>>> m_EventRings;
+    uint64_t m_ReportedDroppedEvents;
+    // The amount of dropped events when the entries were last checked for failures
+    uint64_t m_SweptDroppedEvents;
+};
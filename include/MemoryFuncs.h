@@ -1,21 +1,104 @@
 #pragma once
+#include <cmath>
 #include <cstring>
 #include <exception>
+#include <limits>
 #include <fmt/core.h>
 #include <stdexcept>
+#include <type_traits>
 #include <vector>
 #include <sys/types.h>
 #include <cstdint>
 #include "MemoryStructs.h"
 #include "ComparisonType.h"
+#include "DataType.h"
+#include "AobPattern.h"
+#include "MultiMatcher.h"
+#include "BigEndian.h"
+#include "TypedValue.h"
+#include "StructPattern.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// A single transfer in a batched read/write
+// The result is filled in by the batch functions
+struct MemIoRequest
+{
+    unsigned long address;
+    size_t length;
+    void* buffer; // The local buffer which is read into / written from
+    ssize_t result; // The amount of bytes transferred, or -errno if the transfer failed
+};
 
 namespace MemoryFuncs
 {
     // Wrappers for process_vm_readv/process_vm_writev respectively
     std::vector<uint8_t> ReadProcessMemory(pid_t pid, unsigned long baseAddr, long length);
+    ssize_t ReadProcessMemory(pid_t pid, unsigned long baseAddr, long length, void* buffer);
     ssize_t WriteToProcessMemory(pid_t pid, unsigned long baseAddr, long dataSize, void* data);
+
+    // Vectored versions of the functions above, which transfer many requests with as few syscalls
+    // as possible. Requests with adjacent remote addresses are coalesced, so sorting the requests
+    // by address is recommended.
+    // Returns the amount of requests which were fully transferred
+    size_t ReadProcessMemoryBatch(pid_t pid, std::vector<MemIoRequest>& requests);
+    size_t WriteToProcessMemoryBatch(pid_t pid, std::vector<MemIoRequest>& requests);
+
+    // Returns the memory in place if the pid is of an offline target and the whole range is in it,
+    // otherwise returns nullptr and the memory has to be read
+    // The memory stays valid as long as the offline target is open
+    const uint8_t* GetMappedMemory(pid_t pid, unsigned long baseAddr, size_t length);
+
+    // Returns an error message for an errno set by process_vm_readv/process_vm_writev
+    std::string GetErrorMessage(int err);
     
+    // Tests whether the value is between low and high (inclusive) without branches
+    template <typename T>
+    bool IsInRange(T value, T low, T high);
+
+#ifdef __SSE2__
+    // Whether AnyInRange16 can be used with the type, SSE2 has no comparisons of 64 bit integers
+    template <typename T, typename N = typename NativeTypeOf<T>::Type>
+    constexpr bool HasRangeKernel = std::is_floating_point_v<N> || (std::is_integral_v<N> && sizeof(N) <= 4);
+
+    // Swaps the bytes of every lane of the given size, which converts big-endian values to native ones
+    template <size_t LaneSize>
+    __m128i SwapLaneBytes(__m128i values);
+
+    // Tests whether any of the 16 values which start in the first 16 bytes of data is in the range,
+    // or outside of it if outside is set. data must have 16 + sizeof(T) - 1 bytes.
+    // Big-endian values are swapped in the vectors, so they are compared as fast as native ones
+    template <typename T>
+    bool AnyInRange16(const uint8_t* data, T low, T high, bool outside);
+#endif
+
+    // Converts a comparison of numbers to the range of values which compare true, or to the range
+    // of values which compare false if outside is set. rhs is the same as in CompareData.
+    template <typename T>
+    void GetComparisonRange(ComparisonType cmpType, const void* rhs, T& low, T& high, bool& outside);
+
+    // Calls func(position) for every position below positionAmount where the value which starts at
+    // data + position is in the range, or outside of it if outside is set
+    // data must have positionAmount + sizeof(T) - 1 bytes
+    template <typename T, typename Func>
+    void ForEachInRange(const uint8_t* data, size_t positionAmount, T low, T high, bool outside, Func func);
+
+    // Calls func(position) for every position where the value of T compares true with the rhs
+    template <typename T, typename Func>
+    void ForEachComparisonMatch(const uint8_t* data, size_t positionAmount, const void* rhs, 
+            ComparisonType cmpType, Func func);
+
+    // Calls func(position) for every position where the value of the type of the typed value compares true
+    template <typename Func>
+    void ForEachTypedValueMatch(const uint8_t* data, size_t positionAmount, const TypedValue& value, Func func);
+
+    // Compares the value at data as the type of the typed value
+    bool CompareTypedValue(const uint8_t* data, const TypedValue& value);
+
     // Compares two values based on the given comparison type
+    // For the range comparisons the rhs holds two values, the low bound and the high bound
     template <typename T>
     bool CompareData(const void* lhs, const void* rhs, size_t dataSize, ComparisonType cmpType);
 
@@ -23,6 +106,27 @@ namespace MemoryFuncs
     bool CompareData<std::string>(const void* lhs, const void* rhs, size_t dataSize, 
             ComparisonType cmpType);
 
+    // The rhs is an AobPattern
+    template <>
+    bool CompareData<AobPattern>(const void* lhs, const void* rhs, size_t dataSize, 
+            ComparisonType cmpType);
+
+    // The rhs is a MultiMatcher, the values are equal if any of its needles is found at the lhs
+    template <>
+    bool CompareData<MultiMatcher>(const void* lhs, const void* rhs, size_t dataSize, 
+            ComparisonType cmpType);
+
+    // The rhs is a StructPattern, the values are equal if all of its fields compare true at the lhs
+    template <>
+    bool CompareData<StructPattern>(const void* lhs, const void* rhs, size_t dataSize, 
+            ComparisonType cmpType);
+
+    // Calls func(region, data, length) with the memory of every readable region
+    // The memory of offline targets is passed in place, other memory is read into a buffer which is
+    // reused between the regions
+    template <typename Func>
+    void ForEachRegionMemory(pid_t pid, const std::vector<MemRegion>& memRegions, Func func);
+
     // Returns a vector of the memory addresses where the given data was found
     // dataToFind can be of any type
     // dataSize is the size of the type / length of string (if string type is used)
@@ -31,6 +135,53 @@ namespace MemoryFuncs
     std::vector<MemAddress> FindDataInMemory(pid_t pid, const std::vector<MemRegion>& memRegions, 
             size_t dataSize, const void* dataToFind, ComparisonType cmpType); 
 
+    // Byte patterns skip the positions where the anchors of the pattern don't match, instead of
+    // comparing every position
+    template <>
+    std::vector<MemAddress> FindDataInMemory<AobPattern>(pid_t pid, const std::vector<MemRegion>& memRegions, 
+            size_t dataSize, const void* dataToFind, ComparisonType cmpType); 
+
+    // Finds the addresses where any of the needles of a MultiMatcher is found, in one pass
+    template <>
+    std::vector<MemAddress> FindDataInMemory<MultiMatcher>(pid_t pid, const std::vector<MemRegion>& memRegions, 
+            size_t dataSize, const void* dataToFind, ComparisonType cmpType); 
+
+    // Finds the structures which match a StructPattern, only the leading field of the pattern is
+    // compared at every position
+    template <>
+    std::vector<MemAddress> FindDataInMemory<StructPattern>(pid_t pid, const std::vector<MemRegion>& memRegions, 
+            size_t dataSize, const void* dataToFind, ComparisonType cmpType); 
+
+    // A needle of a MultiMatcher which was found
+    struct NeedleMatch
+    {
+        MemAddress memAddress;
+        size_t needleIndex;
+    };
+
+    // Finds all the needles of a MultiMatcher in one pass, every needle which is found at an address
+    // is a separate match
+    std::vector<NeedleMatch> FindNeedlesInMemory(pid_t pid, const std::vector<MemRegion>& memRegions, 
+            const MultiMatcher& matcher);
+
+    // An address where a TypedValue compared true, along with the type of the value
+    struct TypedMatch
+    {
+        MemAddress memAddress;
+        DataType dataType;
+    };
+
+    // Compares all the values in a single pass over the memory, each one only at the addresses which
+    // are aligned to the size of its type
+    // The matches are sorted by address, an address where several values match is a match of each
+    std::vector<TypedMatch> FindTypedValuesInMemory(pid_t pid, const std::vector<MemRegion>& memRegions,
+            const std::vector<TypedValue>& values);
+
+    // Keeps the addresses where the value of their own type still compares true, types without a
+    // value are dropped
+    std::vector<TypedMatch> FindTypedValuesInMemory(pid_t pid, const std::vector<MemAddress>& memAddrs,
+            const std::vector<DataType>& dataTypes, const std::vector<TypedValue>& values);
+
     // This overload checks a vector of addresses
     template <typename T>
     std::vector<MemAddress> FindDataInMemory(pid_t pid, const std::vector<MemAddress>& memAddrs, 
@@ -38,6 +189,278 @@ namespace MemoryFuncs
 }
 
 
+template <typename T>
+inline bool MemoryFuncs::IsInRange(T value, T low, T high)
+{
+    if constexpr (IsBigEndian<T>)
+    {
+        return MemoryFuncs::IsInRange(value.GetValue(), low.GetValue(), high.GetValue());
+    }
+    else if constexpr (std::is_integral_v<T>)
+    {
+        // A value below the low bound wraps around to a large unsigned value, so a single comparison
+        // checks both bounds
+        using U = std::make_unsigned_t<T>;
+        return (U)((U)value - (U)low) <= (U)((U)high - (U)low);
+    }
+    else
+    {
+        return (value >= low) & (value <= high);
+    }
+}
+
+#ifdef __SSE2__
+// SSE2 has no byte shuffle, so the bytes are swapped with shifts and shuffles of 16 bit words
+template <size_t LaneSize>
+inline __m128i MemoryFuncs::SwapLaneBytes(__m128i values)
+{
+    values = _mm_or_si128(_mm_slli_epi16(values, 8), _mm_srli_epi16(values, 8));
+    if constexpr (LaneSize >= 4)
+    {
+        values = _mm_shufflehi_epi16(_mm_shufflelo_epi16(values, 0xB1), 0xB1);
+    }
+    if constexpr (LaneSize == 8)
+    {
+        values = _mm_shuffle_epi32(values, 0xB1);
+    }
+    return values;
+}
+
+template <typename T>
+inline bool MemoryFuncs::AnyInRange16(const uint8_t* data, T lowBound, T highBound, bool outside)
+{
+    using N = typename NativeTypeOf<T>::Type;
+    const N low = ToNativeValue(lowBound);
+    const N high = ToNativeValue(highBound);
+
+    const __m128i invertMask = outside ? _mm_set1_epi8(-1) : _mm_setzero_si128();
+    __m128i anyMatch = _mm_setzero_si128();
+
+    // A vector loaded at offset k holds the values which start at k, k + sizeof(T) and so on, so
+    // sizeof(T) loads cover all 16 positions
+    for (size_t k = 0; k < sizeof(T); k++)
+    {
+        __m128i values = _mm_loadu_si128((const __m128i*)(data + k));
+        if constexpr (IsBigEndian<T>)
+        {
+            values = MemoryFuncs::SwapLaneBytes<sizeof(T)>(values);
+        }
+
+        __m128i inRange;
+        if constexpr (std::is_same_v<N, float>)
+        {
+            const __m128 floats = _mm_castsi128_ps(values);
+            inRange = _mm_castps_si128(_mm_and_ps(_mm_cmpge_ps(floats, _mm_set1_ps(low)),
+                        _mm_cmple_ps(floats, _mm_set1_ps(high))));
+        }
+        else if constexpr (std::is_same_v<N, double>)
+        {
+            const __m128d doubles = _mm_castsi128_pd(values);
+            inRange = _mm_castpd_si128(_mm_and_pd(_mm_cmpge_pd(doubles, _mm_set1_pd(low)),
+                        _mm_cmple_pd(doubles, _mm_set1_pd(high))));
+        }
+        else
+        {
+            // The same test as IsInRange, SSE2 only has signed comparisons so the sign bits are flipped
+            // to compare the differences as unsigned
+            using U = std::make_unsigned_t<N>;
+            const U range = (U)((U)high - (U)low);
+            __m128i tooHigh;
+            if constexpr (sizeof(T) == 1)
+            {
+                const __m128i signBit = _mm_set1_epi8((char)0x80);
+                const __m128i diff = _mm_sub_epi8(values, _mm_set1_epi8((char)low));
+                tooHigh = _mm_cmpgt_epi8(_mm_xor_si128(diff, signBit), _mm_set1_epi8((char)(range ^ 0x80)));
+            }
+            else if constexpr (sizeof(T) == 2)
+            {
+                const __m128i signBit = _mm_set1_epi16((short)0x8000);
+                const __m128i diff = _mm_sub_epi16(values, _mm_set1_epi16((short)low));
+                tooHigh = _mm_cmpgt_epi16(_mm_xor_si128(diff, signBit), _mm_set1_epi16((short)(range ^ 0x8000)));
+            }
+            else
+            {
+                const __m128i signBit = _mm_set1_epi32((int)0x80000000);
+                const __m128i diff = _mm_sub_epi32(values, _mm_set1_epi32((int)low));
+                tooHigh = _mm_cmpgt_epi32(_mm_xor_si128(diff, signBit), _mm_set1_epi32((int)(range ^ 0x80000000)));
+            }
+            inRange = _mm_xor_si128(tooHigh, _mm_set1_epi8(-1));
+        }
+        anyMatch = _mm_or_si128(anyMatch, _mm_xor_si128(inRange, invertMask));
+    }
+
+    return _mm_movemask_epi8(anyMatch) != 0;
+}
+#endif
+
+template <typename T>
+void MemoryFuncs::GetComparisonRange(ComparisonType cmpType, const void* rhs, T& low, T& high, bool& outside)
+{
+    using N = typename NativeTypeOf<T>::Type;
+    using Limits = std::numeric_limits<N>;
+    // The floats include the infinities
+    const N lowest = Limits::has_infinity ? -Limits::infinity() : Limits::lowest();
+    const N highest = Limits::has_infinity ? Limits::infinity() : Limits::max();
+    // Returns the next value after the given one in the direction of the target
+    auto stepTowards = [](N value, N target) -> N
+    {
+        if constexpr (std::is_floating_point_v<N>)
+        {
+            return std::nextafter(value, target);
+        }
+        else
+        {
+            return value < target ? value + 1 : value - 1;
+        }
+    };
+
+    const N value = ToNativeValue(((const T*)rhs)[0]);
+    N nativeLow = value;
+    N nativeHigh = value;
+    bool isEmpty = false;
+    outside = false;
+    switch (cmpType)
+    {
+        case ComparisonType::Equal:
+            break;
+
+        case ComparisonType::NotEqual:
+            outside = true;
+            break;
+
+        case ComparisonType::Greater:
+            // Also true if the value is NaN
+            isEmpty = !(value < highest);
+            nativeLow = stepTowards(value, highest);
+            nativeHigh = highest;
+            break;
+
+        case ComparisonType::Less:
+            isEmpty = !(value > lowest);
+            nativeLow = lowest;
+            nativeHigh = stepTowards(value, lowest);
+            break;
+
+        case ComparisonType::GreaterEqual:
+            nativeHigh = highest;
+            break;
+
+        case ComparisonType::LessEqual:
+            nativeLow = lowest;
+            break;
+
+        case ComparisonType::Between:
+            nativeHigh = ToNativeValue(((const T*)rhs)[1]);
+            break;
+
+        case ComparisonType::Outside:
+            nativeHigh = ToNativeValue(((const T*)rhs)[1]);
+            outside = true;
+            break;
+
+        default:
+            throw std::runtime_error("Invalid comparison type in GetComparisonRange()");
+    }
+
+    if (isEmpty)
+    {
+        // Nothing is in a range with NaN bounds, and no integer is outside of the range of all integers
+        if constexpr (std::is_floating_point_v<N>)
+        {
+            nativeLow = Limits::quiet_NaN();
+            nativeHigh = Limits::quiet_NaN();
+        }
+        else
+        {
+            nativeLow = lowest;
+            nativeHigh = highest;
+            outside = true;
+        }
+    }
+    low = T(nativeLow);
+    high = T(nativeHigh);
+}
+
+template <typename T, typename Func>
+void MemoryFuncs::ForEachInRange(const uint8_t* data, size_t positionAmount, T low, T high, bool outside, Func func)
+{
+    // Every position is a load and a single comparison without branches
+    size_t i = 0;
+    auto testPositions = [&](size_t end)
+    {
+        for (; i < end; i++)
+        {
+            T value;
+            std::memcpy(&value, data + i, sizeof(T));
+            if (MemoryFuncs::IsInRange(value, low, high) != outside)
+            {
+                func(i);
+            }
+        }
+    };
+
+#ifdef __SSE2__
+    // Blocks of 16 positions without any matches, which are most of them in a selective scan, are
+    // skipped with a few vector comparisons
+    if constexpr (MemoryFuncs::HasRangeKernel<T>)
+    {
+        while (i + 16 <= positionAmount)
+        {
+            if (MemoryFuncs::AnyInRange16<T>(data + i, low, high, outside))
+            {
+                testPositions(i + 16);
+            }
+            else
+            {
+                i += 16;
+            }
+        }
+    }
+#endif
+
+    // The positions which don't fill a block
+    testPositions(positionAmount);
+}
+
+template <typename T, typename Func>
+void MemoryFuncs::ForEachComparisonMatch(const uint8_t* data, size_t positionAmount, const void* rhs, 
+        ComparisonType cmpType, Func func)
+{
+    T low;
+    T high;
+    bool outside;
+    MemoryFuncs::GetComparisonRange<T>(cmpType, rhs, low, high, outside);
+    MemoryFuncs::ForEachInRange<T>(data, positionAmount, low, high, outside, func);
+}
+
+template <typename Func>
+void MemoryFuncs::ForEachTypedValueMatch(const uint8_t* data, size_t positionAmount, const TypedValue& value, Func func)
+{
+    const ComparisonType cmpType = value.cmpType;
+    switch (value.dataType)
+    {
+        case DataType::int8:      ForEachComparisonMatch<int8_t>(data, positionAmount, value.data, cmpType, func);   break;
+        case DataType::int16:     ForEachComparisonMatch<int16_t>(data, positionAmount, value.data, cmpType, func);  break;
+        case DataType::int32:     ForEachComparisonMatch<int32_t>(data, positionAmount, value.data, cmpType, func);  break;
+        case DataType::int64:     ForEachComparisonMatch<int64_t>(data, positionAmount, value.data, cmpType, func);  break;
+        case DataType::uint8:     ForEachComparisonMatch<uint8_t>(data, positionAmount, value.data, cmpType, func);  break;
+        case DataType::uint16:    ForEachComparisonMatch<uint16_t>(data, positionAmount, value.data, cmpType, func); break;
+        case DataType::uint32:    ForEachComparisonMatch<uint32_t>(data, positionAmount, value.data, cmpType, func); break;
+        case DataType::uint64:    ForEachComparisonMatch<uint64_t>(data, positionAmount, value.data, cmpType, func); break;
+        case DataType::f32:       ForEachComparisonMatch<float>(data, positionAmount, value.data, cmpType, func);    break;
+        case DataType::f64:       ForEachComparisonMatch<double>(data, positionAmount, value.data, cmpType, func);   break;
+        case DataType::be_int16:  ForEachComparisonMatch<BigEndian<int16_t>>(data, positionAmount, value.data, cmpType, func);  break;
+        case DataType::be_int32:  ForEachComparisonMatch<BigEndian<int32_t>>(data, positionAmount, value.data, cmpType, func);  break;
+        case DataType::be_int64:  ForEachComparisonMatch<BigEndian<int64_t>>(data, positionAmount, value.data, cmpType, func);  break;
+        case DataType::be_uint16: ForEachComparisonMatch<BigEndian<uint16_t>>(data, positionAmount, value.data, cmpType, func); break;
+        case DataType::be_uint32: ForEachComparisonMatch<BigEndian<uint32_t>>(data, positionAmount, value.data, cmpType, func); break;
+        case DataType::be_uint64: ForEachComparisonMatch<BigEndian<uint64_t>>(data, positionAmount, value.data, cmpType, func); break;
+        case DataType::be_f32:    ForEachComparisonMatch<BigEndian<float>>(data, positionAmount, value.data, cmpType, func);    break;
+        case DataType::be_f64:    ForEachComparisonMatch<BigEndian<double>>(data, positionAmount, value.data, cmpType, func);   break;
+        default: throw std::invalid_argument("Only numeric types can be compared as typed values.");
+    }
+}
+
 template <typename T>
 bool MemoryFuncs::CompareData(const void* lhs, const void* rhs, size_t dataSize,
         ComparisonType cmpType)
@@ -67,11 +490,60 @@ bool MemoryFuncs::CompareData(const void* lhs, const void* rhs, size_t dataSize,
         case ComparisonType::LessEqual:
             return lhsVal <= rhsVal;
 
+        case ComparisonType::Between:
+            return MemoryFuncs::IsInRange(lhsVal, rhsVal, ((T*)rhs)[1]);
+
+        case ComparisonType::Outside:
+            return !MemoryFuncs::IsInRange(lhsVal, rhsVal, ((T*)rhs)[1]);
+
         default:
             throw std::runtime_error("Invalid comparison type in CompareMemoryValue()");
     }
 }
 
+template <typename Func>
+void MemoryFuncs::ForEachRegionMemory(pid_t pid, const std::vector<MemRegion>& memRegions, Func func)
+{
+    std::vector<uint8_t> regMemory;
+    for (auto it = memRegions.cbegin(); it != memRegions.cend(); it++)
+    {
+        // Skip unreadable memory regions
+        if (!it->perms.readFlag)
+        {
+            continue;
+        }
+
+        const uint8_t* dataPtr = MemoryFuncs::GetMappedMemory(pid, it->startAddr, it->rangeLength);
+        size_t dataLen = it->rangeLength;
+        if (dataPtr == nullptr)
+        {
+            regMemory.resize(it->rangeLength);
+            ssize_t nread = 0;
+            try
+            {
+                nread = MemoryFuncs::ReadProcessMemory(pid, it->startAddr, it->rangeLength, regMemory.data());
+            }
+            catch (const std::exception& e)
+            {
+                fmt::print(stderr, "WARNING: Error reading memory region {:#018x} ({}): {}\n", 
+                        it->startAddr, it->pathName, e.what());
+                continue;
+            }
+
+            // Check if there was a partial read
+            if ((size_t)nread != it->rangeLength)
+            {
+                fmt::print("WARNING: Partial read of {}/{} bytes at memory address {:#018x}.\n",
+                        nread, it->rangeLength, it->startAddr);
+            }
+            dataPtr = regMemory.data();
+            dataLen = nread;
+        }
+
+        func(*it, dataPtr, dataLen);
+    }
+}
+
 template <typename T>
 std::vector<MemAddress> MemoryFuncs::FindDataInMemory(pid_t pid, const std::vector<MemRegion>& memRegions, 
         size_t dataSize, const void* dataToFind, ComparisonType cmpType)
@@ -87,32 +559,56 @@ std::vector<MemAddress> MemoryFuncs::FindDataInMemory(pid_t pid, const std::vect
             continue;
         }
         
+        // Offline targets are scanned in place, without copying the region
+        const uint8_t* dataPtr = MemoryFuncs::GetMappedMemory(pid, it->startAddr, it->rangeLength);
+        size_t dataLen = it->rangeLength;
+
         // TODO: implement a limit on how much memory can be read at a time
         std::vector<uint8_t> regMemory;
-        try
-        {
-            regMemory = MemoryFuncs::ReadProcessMemory(pid, it->startAddr, it->rangeLength);
-        }
-        catch (const std::exception& e)
+        if (dataPtr == nullptr)
         {
-            fmt::print(stderr, "WARNING: Error reading memory region {:#018x} ({}): {}\n", 
-                    it->startAddr, it->pathName, e.what());
-            continue;
+            try
+            {
+                regMemory = MemoryFuncs::ReadProcessMemory(pid, it->startAddr, it->rangeLength);
+            }
+            catch (const std::exception& e)
+            {
+                fmt::print(stderr, "WARNING: Error reading memory region {:#018x} ({}): {}\n", 
+                        it->startAddr, it->pathName, e.what());
+                continue;
+            }
+
+            // Check if there was a partial read
+            if (regMemory.size() != it->rangeLength)
+            {
+                fmt::print("WARNING: Partial read of {}/{} bytes at memory address {:#018x}.\n",
+                        regMemory.size(), it->rangeLength, it->startAddr);
+            }
+
+            // The vector is a contiguous array in memory so we can do this
+            dataPtr = &regMemory[0];
+            dataLen = regMemory.size();
         }
 
-        // Check if there was a partial read
-        if (regMemory.size() != it->rangeLength)
+        // Numbers are compared as the range of values which compare true, see ForEachInRange
+        if constexpr (std::is_arithmetic_v<typename NativeTypeOf<T>::Type>)
         {
-            fmt::print("WARNING: Partial read of {}/{} bytes at memory address {:#018x}.\n",
-                    regMemory.size(), it->rangeLength, it->startAddr);
+            if (dataLen >= sizeof(T))
+            {
+                MemoryFuncs::ForEachComparisonMatch<T>(dataPtr, dataLen - sizeof(T) + 1, dataToFind, cmpType, 
+                        [&](size_t i)
+                        {
+                            MemAddress addrStruct = { it->startAddr + i, *it };
+                            addrs.push_back(addrStruct);
+                        });
+            }
+            continue;
         }
 
-        // The vector is a contiguous array in memory so we can do this
-        const unsigned char* dataPtr = &regMemory[0];
-        for (unsigned long i = 0; i < regMemory.size(); i++)
+        for (unsigned long i = 0; i < dataLen; i++)
         {
             // We always want to have at least dataTypeSize bytes
-            if (regMemory.size() - i < dataSize)
+            if (dataLen - i < dataSize)
             {
                 break;
             }
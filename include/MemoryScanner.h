@@ -5,6 +5,7 @@
 #include "ComparisonType.h"
 #include <stdexcept>
 #include "MemoryFuncs.h"
+#include "FilterExpression.h"
 
 class MemoryScanner
 {
@@ -22,18 +23,42 @@ public:
     template <typename T>
     size_t NextScan(size_t dataSize, const void* data, ComparisonType cmpType);
 
+    // Scans for a value in several types at once, every address keeps the type it was found with
+    // and the next scans of any type compare it only as that type
+    size_t NewScanAnyType(const std::vector<MemRegion>& memRegions, const std::vector<TypedValue>& values);
+    size_t NextScanAnyType(const std::vector<TypedValue>& values);
+
+    // Keeps the addresses where the filter is true, the addresses take the type of the filter
+    size_t NextScanFilter(FilterExpression& filter);
+
+    // Replaces the saved addresses with the given ones, as if they were found by a scan
+    void SetScanVector(std::vector<MemAddress> memAddrs);
+
     void SetPid(pid_t pid);
 
     const std::vector<MemAddress>& GetCurrScanVector() const;
+    // The types of the saved addresses, empty if they weren't found by a scan of any type
+    const std::vector<DataType>& GetCurrScanTypes() const;
     bool GetScanStartedFlag() const;
     
 private:
+    // Moves the matches into the current scan vectors
+    void SplitTypedMatches(std::vector<MemoryFuncs::TypedMatch>& matches);
+    // Reads the values at the current addresses, which are the old values of the next filter
+    void CaptureValues();
+
     bool m_UndoFlag;
     bool m_ScanStartedFlag;
 
     pid_t m_pid;
     std::vector<MemAddress> m_CurrScanVector;
     std::vector<MemAddress> m_PrevScanVector;
+    // Parallel to the scan vectors
+    std::vector<DataType> m_CurrScanTypes;
+    std::vector<DataType> m_PrevScanTypes;
+    // The bytes at every address when it was found, also parallel to the scan vectors
+    std::vector<uint64_t> m_CurrScanValues;
+    std::vector<uint64_t> m_PrevScanValues;
 };
 
 
@@ -50,6 +75,8 @@ size_t MemoryScanner::NewScan(const std::vector<MemRegion>& memRegions, size_t d
 
     this->m_CurrScanVector = MemoryFuncs::FindDataInMemory<T>(this->m_pid, memRegions, dataSize, 
             data, cmpType);
+    this->m_CurrScanTypes.clear();
+    this->CaptureValues();
     this->m_UndoFlag = false; // Reset the undo flag
     this->m_ScanStartedFlag = true;
 
@@ -66,7 +93,12 @@ size_t MemoryScanner::NextScan(size_t dataSize, const void* data, ComparisonType
             dataSize, data, cmpType);
 
     // Replace the previous scan vector only if the scan succeeded
+    // The addresses all have the type of this scan now
     this->m_PrevScanVector = temporary;
+    this->m_PrevScanTypes = std::move(this->m_CurrScanTypes);
+    this->m_CurrScanTypes.clear();
+    this->m_PrevScanValues = std::move(this->m_CurrScanValues);
+    this->CaptureValues();
     this->m_UndoFlag = false; // Reset the undo flag
 
     return this->m_CurrScanVector.size();
@@ -0,0 +1,122 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Finds any of a set of byte sequences (the binary values of numbers of any type, strings or byte
+// patterns without wildcards) at a position with a fixed amount of work, no matter how many there are
+// The first two bytes of every position are checked in a bitmap of the first two bytes of the needles,
+// which rejects almost every position with a single test. The needles are grouped by the length of
+// their prefix of up to 8 bytes, and for the positions which pass, the prefix of every group is checked
+// in a bitmap of hashes and then looked up in the sorted prefixes of the group and compared in full.
+class MultiMatcher
+{
+public:
+    MultiMatcher(const std::vector<std::vector<uint8_t>>& needles);
+
+    // Calls func(needleIndex) for every needle which is found at the data, which has the given amount
+    // of bytes available
+    template <typename Func>
+    void ForEachMatch(const uint8_t* data, size_t available, Func func) const;
+    bool MatchesAny(const uint8_t* data, size_t available) const;
+
+    size_t GetNeedleAmount() const;
+    size_t GetMaxNeedleSize() const;
+
+    static constexpr size_t MAX_PREFIX_SIZE = sizeof(uint64_t);
+    static constexpr int FILTER_BITS = 16;
+
+private:
+    struct PrefixEntry
+    {
+        uint64_t prefix;
+        uint32_t needleIndex;
+    };
+
+    // The needles with the same prefix length
+    struct PrefixGroup
+    {
+        std::vector<uint64_t> filter; // A bitmap of the hashes of the prefixes
+        std::vector<PrefixEntry> entries; // Sorted by the prefix
+    };
+
+    static uint32_t HashPrefix(uint64_t prefix);
+    static uint64_t LoadPrefix(const uint8_t* data, size_t available, size_t prefixSize);
+
+    std::vector<std::vector<uint8_t>> m_Needles;
+    // Needles of a single byte set every entry which starts with their byte
+    std::vector<uint64_t> m_StartFilter;
+    PrefixGroup m_Groups[MAX_PREFIX_SIZE]; // Indexed by the prefix length - 1
+    size_t m_MaxNeedleSize;
+};
+
+
+inline uint32_t MultiMatcher::HashPrefix(uint64_t prefix)
+{
+    return (prefix * 0x9e3779b97f4a7c15ULL) >> (64 - FILTER_BITS);
+}
+
+// Loads the first prefixSize bytes as a number, the rest of the bytes are zeros
+inline uint64_t MultiMatcher::LoadPrefix(const uint8_t* data, size_t available, size_t prefixSize)
+{
+    uint64_t prefix = 0;
+    if (available >= sizeof(prefix))
+    {
+        std::memcpy(&prefix, data, sizeof(prefix));
+        if (prefixSize < sizeof(prefix))
+        {
+            prefix &= (1ULL << (prefixSize * 8)) - 1;
+        }
+    }
+    else
+    {
+        std::memcpy(&prefix, data, prefixSize);
+    }
+    return prefix;
+}
+
+template <typename Func>
+void MultiMatcher::ForEachMatch(const uint8_t* data, size_t available, Func func) const
+{
+    if (available >= sizeof(uint16_t))
+    {
+        uint16_t start;
+        std::memcpy(&start, data, sizeof(start));
+        if ((this->m_StartFilter[start / 64] & (1ULL << (start % 64))) == 0)
+        {
+            return;
+        }
+    }
+
+    const size_t groupAmount = std::min(available, MAX_PREFIX_SIZE);
+    for (size_t i = 0; i < groupAmount; i++)
+    {
+        const PrefixGroup& group = this->m_Groups[i];
+        if (group.entries.empty())
+        {
+            continue;
+        }
+
+        const uint64_t prefix = LoadPrefix(data, available, i + 1);
+        const uint32_t hash = HashPrefix(prefix);
+        if ((group.filter[hash / 64] & (1ULL << (hash % 64))) == 0)
+        {
+            continue;
+        }
+
+        auto it = std::lower_bound(group.entries.begin(), group.entries.end(), prefix, 
+                [](const PrefixEntry& entry, uint64_t value) { return entry.prefix < value; });
+        for (; it != group.entries.end() && it->prefix == prefix; it++)
+        {
+            const std::vector<uint8_t>& needle = this->m_Needles[it->needleIndex];
+            if (needle.size() <= available && (needle.size() <= MAX_PREFIX_SIZE 
+                        || std::memcmp(data + MAX_PREFIX_SIZE, needle.data() + MAX_PREFIX_SIZE, 
+                            needle.size() - MAX_PREFIX_SIZE) == 0))
+            {
+                func(it->needleIndex);
+            }
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+#include "MemoryStructs.h"
+
+// A captured memory image which is used in place of a live process, either a snapshot file made by
+// the snapshot command or an ELF core file (such as one made by gcore)
+// The file is mapped into memory, so reads are plain copies and scans can use the data in place.
+// Writes only change the mapped copy, the file itself is never modified.
+//
+// Offline targets are given negative ids which are used like pids, so every function which takes
+// a pid works with them as well.
+class OfflineTarget
+{
+public:
+    ~OfflineTarget();
+
+    OfflineTarget(const OfflineTarget&) = delete;
+    OfflineTarget& operator=(const OfflineTarget&) = delete;
+
+    // Opens the file and returns the id of the new target
+    static pid_t Open(const std::string& path);
+    static void Close(pid_t id);
+    // Returns nullptr if there is no target with the id
+    static std::shared_ptr<OfflineTarget> Find(pid_t id);
+
+    static bool IsOfflineId(pid_t pid);
+
+    // These behave like process_vm_readv/process_vm_writev: the transfer stops at the first byte
+    // which isn't in the image, and -EFAULT is returned if there is no such byte at the address
+    ssize_t Read(unsigned long address, size_t length, void* buffer) const;
+    ssize_t Write(unsigned long address, size_t length, const void* data);
+
+    // Returns the data of the range in place, or nullptr if the range isn't fully in the image
+    const uint8_t* GetData(unsigned long address, size_t length) const;
+
+    // Returns the hashes which were stored by the snapshot command for the pages starting at the page
+    // aligned address, or nullptr if the pages aren't all in one region or the file has no hashes
+    const uint64_t* GetPageHashes(unsigned long address, size_t pageCount) const;
+
+    const std::vector<MemRegion>& GetMemoryRegions() const;
+    const std::string& GetPath() const;
+    // Describes where the image came from, such as the type of the file and the pid it was taken from
+    const std::string& GetDescription() const;
+
+private:
+    OfflineTarget(const std::string& path);
+
+    // A part of the address space which has data in the file
+    struct Segment
+    {
+        unsigned long startAddr;
+        unsigned long endAddr; // Only the part up to the end of the data is readable
+        uint8_t* data;
+        const uint64_t* pageHashes; // nullptr if the file has no hashes
+    };
+
+    void LoadSnapshot();
+    void LoadCoreFile();
+    void CheckRange(uint64_t offset, uint64_t size) const;
+    void CheckTable(uint64_t offset, uint64_t count, uint64_t elementSize) const;
+    // Returns the index of the segment which contains the address, or -1
+    ssize_t FindSegment(unsigned long address) const;
+    ssize_t Transfer(unsigned long address, size_t length, uint8_t* buffer, bool write) const;
+
+    std::string m_Path;
+    std::string m_Description;
+    uint8_t* m_Mapping;
+    size_t m_MappingSize;
+
+    std::vector<MemRegion> m_MemRegions;
+    std::vector<Segment> m_Segments; // Sorted by address
+};
+
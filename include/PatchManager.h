@@ -0,0 +1,68 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+struct PatchEntry
+{
+    unsigned long address;
+    std::string typeStr;
+    std::string dataStr;
+    std::vector<uint8_t> data;
+};
+
+// A named list of writes which are applied together
+struct PatchSet
+{
+    std::string path; // The file which the patch set was loaded from
+    std::vector<PatchEntry> entries;
+
+    // The bytes which were overwritten by the last apply, used to roll it back
+    bool hasBackup;
+    std::vector<uint8_t> backup; // The old data of the entries, packed in the order of the entries
+};
+
+struct PatchResult
+{
+    size_t written;
+    size_t total;
+    bool restored; // Whether the written entries were restored because other entries failed
+    std::vector<std::string> errors;
+    std::chrono::nanoseconds stopDuration; // How long the threads of the process were stopped
+};
+
+class PatchManager
+{
+public:
+    PatchManager();
+    ~PatchManager();
+
+    // Each line of the file is an entry with the syntax <address> <type> <value>
+    // Empty lines and lines starting with '#' are ignored
+    void LoadPatchSet(const std::string& name, const std::string& path);
+    void RemovePatchSet(const std::string& name);
+    void RemoveAllPatchSets();
+
+    // Stops the process, writes all the entries at once and continues the process
+    // If one of the entries fails and the old bytes were saved, the other entries are restored so
+    // that the patch set is either fully applied or not applied at all
+    PatchResult ApplyPatchSet(const std::string& name, bool saveBackup);
+    // Writes back the bytes which were saved by the last apply of the patch set
+    PatchResult RollbackPatchSet(const std::string& name);
+
+    const std::map<std::string, PatchSet>& GetPatchSets() const;
+    const PatchSet& GetPatchSet(const std::string& name) const;
+
+    // The saved bytes belong to the previous process, so they are discarded
+    void SetPid(pid_t pid);
+
+private:
+    PatchSet& FindPatchSet(const std::string& name);
+
+    pid_t m_pid;
+    std::map<std::string, PatchSet> m_PatchSets; // Sorted by name for listing
+};
+
@@ -0,0 +1,125 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <sys/types.h>
+#include <vector>
+#include "MemoryStructs.h"
+
+// A pointer that was found in memory
+struct PointerEntry
+{
+    unsigned long value;
+    unsigned long location;
+};
+
+// Every aligned pointer sized value in the readable writable memory of a process which points into a
+// mapped region, sorted by the value, so the locations which point to an address can be found
+// without scanning the memory again
+// The index is a copy of the pointers at the time it was built, it isn't updated when the memory changes.
+class PointerIndex
+{
+public:
+    PointerIndex();
+    ~PointerIndex();
+
+    // The regions are read in parallel with the given amount of threads
+    // A compact index stores the values as deltas from the previous value, which makes it smaller
+    // but makes the queries decode up to a block of values
+    void Build(pid_t pid, const std::vector<MemRegion>& memRegions, unsigned int threadCount, bool compact);
+    void Clear();
+
+    // Calls func(value, location) for every pointer with a value between lowest and highest (inclusive),
+    // in order of the value, until func returns false
+    template <typename Func>
+    void ForEachInRange(unsigned long lowest, unsigned long highest, Func func) const;
+    // Returns up to maxResults pointers with a value between lowest and highest (inclusive)
+    std::vector<PointerEntry> FindInRange(unsigned long lowest, unsigned long highest, size_t maxResults) const;
+
+    bool IsBuilt() const;
+    bool IsCompact() const;
+    pid_t GetPid() const;
+    size_t GetSize() const;
+    // The amount of bytes that the index takes
+    size_t GetMemoryUsage() const;
+
+    // The amount of values in every block of a compact index
+    static constexpr size_t BLOCK_SIZE = 64;
+
+private:
+    void Compact(const std::vector<PointerEntry>& entries);
+
+    pid_t m_pid;
+    bool m_Built;
+    bool m_Compact;
+
+    // The sorted pointers of an index which isn't compact
+    std::vector<PointerEntry> m_Entries;
+
+    // A compact index stores the first value of every block, and the deltas of the other values in the
+    // block as variable length integers (LEB128)
+    std::vector<unsigned long> m_BlockValues;
+    std::vector<uint64_t> m_BlockOffsets; // The offset of the deltas of every block
+    std::vector<uint8_t> m_Deltas;
+    std::vector<unsigned long> m_Locations; // Parallel to the values
+};
+
+
+template <typename Func>
+void PointerIndex::ForEachInRange(unsigned long lowest, unsigned long highest, Func func) const
+{
+    if (!this->m_Compact)
+    {
+        auto it = std::lower_bound(this->m_Entries.begin(), this->m_Entries.end(), lowest, 
+                [](const PointerEntry& entry, unsigned long value) { return entry.value < value; });
+        for (; it != this->m_Entries.end() && it->value <= highest; it++)
+        {
+            if (!func(it->value, it->location))
+            {
+                return;
+            }
+        }
+        return;
+    }
+
+    // Values equal to lowest can be at the end of the block before the first block which starts with
+    // a value that isn't lower than it
+    size_t block = std::lower_bound(this->m_BlockValues.begin(), this->m_BlockValues.end(), lowest) 
+        - this->m_BlockValues.begin();
+    if (block > 0)
+    {
+        block--;
+    }
+
+    for (; block < this->m_BlockValues.size(); block++)
+    {
+        unsigned long value = this->m_BlockValues[block];
+        const uint8_t* delta = this->m_Deltas.data() + this->m_BlockOffsets[block];
+        const size_t blockEnd = std::min((block + 1) * BLOCK_SIZE, this->m_Locations.size());
+        for (size_t i = block * BLOCK_SIZE; i < blockEnd; i++)
+        {
+            // The first value of the block is stored in full
+            if (i != block * BLOCK_SIZE)
+            {
+                unsigned long diff = 0;
+                for (int shift = 0; ; shift += 7)
+                {
+                    diff |= (unsigned long)(*delta & 0x7f) << shift;
+                    if ((*delta++ & 0x80) == 0)
+                    {
+                        break;
+                    }
+                }
+                value += diff;
+            }
+
+            if (value > highest)
+            {
+                return;
+            }
+            if (value >= lowest && !func(value, this->m_Locations[i]))
+            {
+                return;
+            }
+        }
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+#include "MemoryStructs.h"
+#include "PointerIndex.h"
+
+// A path to an address which starts at a static address in a module, so it can be followed again
+// after the process restarts and its heap addresses change
+// The pointer at the static address is read, then for every offset except the last one the pointer at
+// (pointer + offset) is read, and the target is the last pointer + the last offset.
+struct PointerChain
+{
+    std::string modulePath;
+    unsigned long moduleOffset; // The offset of the static address from the start of the module
+    std::vector<unsigned long> offsets;
+};
+
+struct PointerScanStats
+{
+    size_t chainsFound;
+    bool truncated; // Whether some addresses weren't searched because of the limits
+};
+
+class PointerScanner
+{
+public:
+    PointerScanner();
+    ~PointerScanner();
+
+    // Finds the chains of up to maxDepth pointers which lead to the target address, where every
+    // pointer may point up to maxOffset bytes before the next address
+    // The pointers are looked up in the given index, which should be built from the current memory
+    PointerScanStats Scan(const PointerIndex& pointerIndex, const std::vector<MemRegion>& memRegions, 
+            unsigned long target, unsigned int maxDepth, unsigned long maxOffset, unsigned int threadCount);
+
+    // Follows every chain in the current process, chains which can't be followed anymore resolve to 0
+    std::vector<unsigned long> Resolve(const std::vector<MemRegion>& memRegions) const;
+    // Removes the chains which don't lead to the target anymore, returns the amount of chains left
+    size_t Validate(const std::vector<MemRegion>& memRegions, unsigned long target);
+    // Removes the chains which don't lead to the given data, for when the new address of the target
+    // isn't known yet
+    size_t ValidateData(const std::vector<MemRegion>& memRegions, const std::vector<uint8_t>& data);
+
+    // The chains are saved as text, one chain in each line
+    void Save(const std::string& path) const;
+    void Load(const std::string& path);
+
+    void Clear();
+    const std::vector<PointerChain>& GetChains() const;
+
+    // The chains are kept, since they are meant to be used with the next runs of the process
+    void SetPid(pid_t pid);
+
+    static constexpr size_t MAX_CHAINS = 100000;
+    // The amount of addresses that are searched at every depth is limited, to bound the memory usage
+    static constexpr size_t MAX_ADDRESSES_PER_DEPTH = 1 << 20;
+
+private:
+    // Keeps only the chains which are marked in the given vector
+    size_t KeepChains(const std::vector<bool>& keep);
+
+    pid_t m_pid;
+    std::vector<PointerChain> m_Chains;
+};
+
@@ -5,6 +5,9 @@
 #include "MemoryStructs.h"
 #include "MemoryScanner.h"
 #include "MemoryFreezer.h"
+#include "PatchManager.h"
+#include "PointerIndex.h"
+#include "PointerScanner.h"
 
 class Process
 {
@@ -14,11 +17,16 @@ public:
     ~Process();
 
     void SetProcessPid(pid_t pid);
+    // Uses a snapshot or a core file instead of a live process
+    void OpenOfflineTarget(const std::string& path);
 
     pid_t GetCurrentPid() const;
     const std::vector<MemRegion> GetMemoryRegions() const;
     MemoryScanner& GetMemoryScanner();
     MemoryFreezer& GetMemoryFreezer();
+    PatchManager& GetPatchManager();
+    PointerIndex& GetPointerIndex();
+    PointerScanner& GetPointerScanner();
 
     void PrintMessageQueues();
 
@@ -26,8 +34,12 @@ private:
     pid_t m_pid;
     MemoryScanner m_MemoryScanner;
     MemoryFreezer m_MemoryFreezer;
+    PatchManager m_PatchManager;
+    PointerIndex m_PointerIndex;
+    PointerScanner m_PointerScanner;
 
     void UpdateMemoryRegions();
+    void SetTarget(pid_t pid);
 
     void SetMemoryRangeBoundaries(MemRegion& reg, const std::string& addressRange) const;
     void SetMemoryRegionPerms(MemRegion& reg, const std::string& perms) const;
@@ -0,0 +1,39 @@
+#pragma once
+#include <sys/types.h>
+#include <vector>
+
+// Stops all the threads of a process with ptrace, so that memory can be changed without the process
+// observing it half-changed
+// The threads are attached when the object is created and detached when it is destroyed, and only the
+// time between Stop() and Resume() is spent with the process stopped.
+class ProcessStopper
+{
+public:
+    ProcessStopper(pid_t pid);
+    ~ProcessStopper();
+
+    ProcessStopper(const ProcessStopper&) = delete;
+    ProcessStopper& operator=(const ProcessStopper&) = delete;
+
+    // Returns once every thread of the process is stopped
+    void Stop();
+    // Lets the threads continue running and detaches from them
+    void Resume();
+
+private:
+    struct AttachedThread
+    {
+        pid_t tid;
+        int pendingSignal; // A signal which was received while stopping, it is delivered when detaching
+        bool stopped;
+    };
+
+    // Attaches to the threads which were not attached yet, returns whether any new thread was found
+    bool AttachNewThreads();
+    void StopThread(AttachedThread& thread);
+
+    pid_t m_pid;
+    std::vector<AttachedThread> m_Threads;
+    bool m_Stopped;
+};
+
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+#include "MemoryStructs.h"
+
+struct SignatureResult
+{
+    // The pattern starts at the address, its bytes and mask are in the format of AobPattern
+    std::vector<uint8_t> bytes;
+    std::vector<uint8_t> mask;
+    std::string scopeName; // The pathname of the regions where the pattern was searched
+    bool unique;
+    size_t matches; // The amount of places where the longest pattern that was tried was found
+};
+
+namespace SignatureMaker
+{
+    // Grows a pattern from the address until it is found only once in the module of the address, or in
+    // its region if it isn't in a module
+    // Code is grown one instruction at a time, and the parts of the instructions that change when the
+    // module is rebuilt or loaded at a different address are wildcards: rip-relative displacements,
+    // relative jumps and calls, and addresses of mapped memory. Data is grown 8 bytes at a time, with
+    // wildcards in place of the pointers.
+    SignatureResult MakeSignature(pid_t pid, const std::vector<MemRegion>& memRegions, unsigned long address, 
+            size_t maxSize);
+
+    constexpr size_t DEFAULT_MAX_SIGNATURE_SIZE = 64;
+    constexpr size_t MAX_SIGNATURE_SIZE = 256;
+}
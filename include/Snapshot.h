@@ -0,0 +1,76 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+#include "MemoryStructs.h"
+
+// The layout of a snapshot file, which holds the memory of every region of a process
+// All the offsets are from the start of the file. The data of every region starts at a page aligned
+// offset, so the file can be mapped and the data of a region can be used in place.
+//
+// [SnapshotHeader][SnapshotRegion * regionCount][page hashes][string table][padding][region data...]
+//
+// Pages which were all zeros are holes in the file, they take no disk space and read back as zeros.
+
+constexpr char SNAPSHOT_MAGIC[8] = { 'R', 'W', 'P', 'M', 'S', 'N', 'A', 'P' };
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+constexpr uint32_t SNAPSHOT_PAGE_SIZE = 4096;
+
+struct SnapshotHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t pageSize;
+    int32_t pid;
+    uint32_t regionCount;
+    uint64_t timestamp; // Seconds since the epoch when the snapshot was taken
+    uint64_t regionTableOffset;
+    uint64_t hashTableOffset; // A hash of every page of data, see Snapshot::HashPage
+    uint64_t hashCount;
+    uint64_t stringTableOffset; // The permissions and pathnames of the regions
+    uint64_t stringTableSize;
+    uint64_t fileSize;
+};
+
+struct SnapshotRegion
+{
+    enum Flags : uint32_t
+    {
+        Readable = 1 << 0,
+        Writable = 1 << 1,
+        Executable = 1 << 2,
+        Shared = 1 << 3,
+        Captured = 1 << 4, // The data of the region is in the file
+        Incomplete = 1 << 5, // Parts of the region couldn't be read, they are zeros in the file
+    };
+
+    uint64_t startAddr;
+    uint64_t endAddr;
+    uint64_t dataOffset; // 0 if the region wasn't captured
+    uint64_t firstHash; // The index of the hash of the first page of the region
+    uint32_t flags;
+    uint32_t permsOffset; // Offsets in the string table, the strings are null terminated
+    uint32_t pathNameOffset;
+    uint32_t reserved;
+};
+
+namespace Snapshot
+{
+    struct CaptureStats
+    {
+        size_t regionsCaptured;
+        size_t regionsIncomplete;
+        uint64_t bytesRead;
+        uint64_t bytesWritten; // Bytes that weren't zero pages
+    };
+
+    // Reads all the readable regions with the given amount of threads and writes them to the file
+    CaptureStats Capture(pid_t pid, const std::vector<MemRegion>& memRegions, const std::string& path,
+            unsigned int threadCount);
+
+    // A fast non-cryptographic hash, used to find which pages changed between snapshots
+    uint64_t HashPage(const uint8_t* data, size_t length);
+}
+
@@ -0,0 +1,89 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// A bounded lock-free queue for exactly one producer thread and one consumer thread
+// Items that don't fit when the queue is full are counted instead of being stored
+template <typename T, size_t Capacity>
+class SpscRing
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "The capacity must be a power of 2.");
+
+public:
+    SpscRing();
+
+    // Called only by the producer
+    // Returns false if the queue was full
+    bool Push(const T& item);
+
+    // Called only by the consumer
+    // Returns false if the queue was empty
+    bool Pop(T& item);
+
+    size_t Size() const;
+    uint64_t GetOverflowAmount() const;
+
+private:
+    // The indices only ever increase, they are wrapped when accessing the items
+    // Each one is kept in a separate cache line so that the threads don't invalidate each other
+    alignas(64) std::atomic<size_t> m_Head; // Written by the producer
+    alignas(64) std::atomic<size_t> m_Tail; // Written by the consumer
+    alignas(64) std::atomic<uint64_t> m_Overflow;
+
+    std::array<T, Capacity> m_Items;
+};
+
+
+template <typename T, size_t Capacity>
+SpscRing<T, Capacity>::SpscRing()
+{
+    this->m_Head = 0;
+    this->m_Tail = 0;
+    this->m_Overflow = 0;
+}
+
+template <typename T, size_t Capacity>
+bool SpscRing<T, Capacity>::Push(const T& item)
+{
+    const size_t head = this->m_Head.load(std::memory_order_relaxed);
+    if (head - this->m_Tail.load(std::memory_order_acquire) == Capacity)
+    {
+        // Released so that what was written before the dropped item is seen with the count
+        this->m_Overflow.fetch_add(1, std::memory_order_release);
+        return false;
+    }
+
+    this->m_Items[head & (Capacity - 1)] = item;
+    // Publishes the item to the consumer
+    this->m_Head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T, size_t Capacity>
+bool SpscRing<T, Capacity>::Pop(T& item)
+{
+    const size_t tail = this->m_Tail.load(std::memory_order_relaxed);
+    if (tail == this->m_Head.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    item = this->m_Items[tail & (Capacity - 1)];
+    // Gives the slot back to the producer
+    this->m_Tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T, size_t Capacity>
+size_t SpscRing<T, Capacity>::Size() const
+{
+    return this->m_Head.load(std::memory_order_acquire) - this->m_Tail.load(std::memory_order_acquire);
+}
+
+template <typename T, size_t Capacity>
+uint64_t SpscRing<T, Capacity>::GetOverflowAmount() const
+{
+    return this->m_Overflow.load(std::memory_order_acquire);
+}
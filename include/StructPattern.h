@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "TypedValue.h"
+
+// A field of a structure which has to compare true, at a fixed offset from the start of the structure
+struct StructField
+{
+    size_t offset;
+    TypedValue value;
+};
+
+// Finds structures by the values of several of their fields
+// The field which is expected to compare true at the fewest positions leads, and is the only one
+// which is compared at every position of the memory. The other fields are only compared at the
+// positions where it matched, in the order of their expected selectivity.
+class StructPattern
+{
+public:
+    StructPattern(const std::vector<StructField>& fields);
+
+    // Compares all the fields, data must have GetSize() bytes
+    bool Matches(const uint8_t* data) const;
+    // Compares all the fields but the leading field
+    bool MatchesOtherFields(const uint8_t* data) const;
+
+    const StructField& GetLeadingField() const;
+    // The size of the structure up to the end of its last field
+    size_t GetSize() const;
+
+    // The fields are expected to be within a page of the start of the structure
+    static constexpr size_t MAX_FIELD_OFFSET = 4096;
+
+private:
+    std::vector<StructField> m_Fields; // Sorted by their expected selectivity, the leading field is first
+    size_t m_Size;
+};
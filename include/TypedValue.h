@@ -0,0 +1,14 @@
+#pragma once
+#include <cstdint>
+#include "ComparisonType.h"
+#include "DataType.h"
+
+// A value which is compared as its numeric type, used when values of several types are compared in
+// the same scan
+// The data holds the value, followed by the high bound for the range comparisons
+struct TypedValue
+{
+    DataType dataType;
+    ComparisonType cmpType;
+    uint8_t data[2 * sizeof(uint64_t)];
+};
@@ -5,7 +5,11 @@
 #include <concepts>
 #include <stdexcept>
 #include <charconv>
+#include <cstdint>
 #include "MemoryStructs.h"
+#include "DataType.h"
+#include "AobPattern.h"
+#include "BigEndian.h"
 #include <fmt/core.h>
 
 namespace Utils
@@ -32,6 +36,16 @@ namespace Utils
 
     template <typename T>
     T StrToNumber(const std::string& dataString, std::string varName = "data"); 
+
+    // Big-endian numbers are parsed in the native order and then swapped
+    template <typename T> requires IsBigEndian<T>
+    T StrToNumber(const std::string& dataString, std::string varName = "data");
+
+    // Converts the data string to the binary representation of the given type
+    template <typename T>
+    std::vector<uint8_t> DataToByteVector(const std::string& data);
+
+    std::vector<uint8_t> DataToByteVector(DataType dataType, const std::string& data);
 }
 
 
@@ -89,3 +103,44 @@ T Utils::StrToNumber(const std::string& dataString, std::string varName)
     return dataValue;
 }
 
+template <typename T> requires IsBigEndian<T>
+T Utils::StrToNumber(const std::string& dataString, std::string varName)
+{
+    return T(Utils::StrToNumber<typename T::ValueType>(dataString, varName));
+}
+
+
+template <typename T>
+std::vector<uint8_t> Utils::DataToByteVector(const std::string& data)
+{
+    constexpr size_t dataSize = sizeof(T);
+    // Convert the data to the correct type (for the correct binary representation)
+    T dataValue = Utils::StrToNumber<T>(data);
+
+    // Get a pointer to the dataValue in memory
+    uint8_t* dataValueBytePtr = (uint8_t*)&dataValue;
+
+    std::vector<uint8_t> byteVector;
+    // Construct the vector of bytes
+    byteVector.insert(byteVector.end(), &dataValueBytePtr[0], &dataValueBytePtr[dataSize]);
+
+    return byteVector;
+}
+
+template <>
+inline std::vector<uint8_t> Utils::DataToByteVector<std::string>(const std::string& data)
+{
+    return std::vector<uint8_t>(data.begin(), data.end());
+}
+
+// Only byte patterns without wildcards have a value that can be written
+template <>
+inline std::vector<uint8_t> Utils::DataToByteVector<AobPattern>(const std::string& data)
+{
+    const AobPattern pattern(data);
+    if (pattern.HasWildcards())
+    {
+        throw std::invalid_argument("Byte patterns with wildcards can't be written.");
+    }
+    return pattern.GetBytes();
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// The layout of a decoded x86-64 instruction
+// The offsets are from the start of the instruction, and a size of 0 means the part isn't there.
+struct X86Instruction
+{
+    size_t length;
+    size_t dispOffset;
+    size_t dispSize;
+    bool ripRelative; // Whether the displacement is relative to the next instruction
+    size_t immOffset;
+    size_t immSize;
+    bool relativeBranch; // Whether the immediate is the displacement of a jump or a call
+};
+
+namespace X86Decoder
+{
+    // Decodes the length and the layout of the instruction at the start of the code, without decoding
+    // its meaning
+    // Returns false if the bytes aren't a valid instruction in 64-bit mode or the instruction is cut off
+    bool DecodeInstruction(const uint8_t* code, size_t size, X86Instruction& instruction);
+
+    constexpr size_t MAX_INSTRUCTION_LENGTH = 15;
+}
@@ -0,0 +1,10 @@
+#pragma once
+#include "cmds/ICommand.h"
+
+class OpenCommand : public ICommand<OpenCommand>
+{
+public:
+    static void Main(Process& proc, const std::vector<std::string>& args);
+    static std::string Help();
+};
+
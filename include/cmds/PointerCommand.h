@@ -0,0 +1,10 @@
+#pragma once
+#include "cmds/ICommand.h"
+
+class PointerCommand : public ICommand<PointerCommand>
+{
+public:
+    static void Main(Process& proc, const std::vector<std::string>& args);
+    static std::string Help();
+};
+
@@ -0,0 +1,251 @@
+#include "AobPattern.h"
+#include <cstring>
+#include <stdexcept>
+#include <fmt/core.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// How common every byte value is in x86-64 machine code and in data, higher is more common
+// The anchors of a pattern are the fixed bytes with the lowest score, since they produce the
+// fewest false candidates.
+static constexpr uint8_t BYTE_SCORES[256] =
+{
+    /* 0x00 */ 255, 90, 40, 40, 40, 40, 20, 20, 50, 30, 20, 20, 20, 20, 20, 80,
+    /* 0x10 */ 60,  30, 20, 20, 40, 20, 20, 20, 50, 20, 20, 20, 20, 20, 20, 30,
+    /* 0x20 */ 60,  30, 20, 20, 120, 20, 20, 20, 50, 30, 20, 20, 20, 20, 20, 20,
+    /* 0x30 */ 40,  40, 20, 30, 20, 20, 20, 20, 50, 50, 20, 20, 20, 20, 20, 20,
+    /* 0x40 */ 70,  80, 20, 20, 100, 80, 20, 20, 200, 150, 20, 20, 110, 100, 20, 20,
+    /* 0x50 */ 60,  30, 30, 70, 20, 70, 30, 30, 30, 30, 30, 70, 70, 70, 70, 20,
+    /* 0x60 */ 20,  20, 20, 70, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20,
+    /* 0x70 */ 20,  20, 20, 20, 110, 100, 30, 30, 20, 20, 20, 20, 20, 20, 30, 30,
+    /* 0x80 */ 60,  50, 20, 120, 60, 110, 20, 20, 70, 150, 50, 180, 50, 110, 20, 20,
+    /* 0x90 */ 50,  20, 20, 20, 30, 30, 20, 20, 30, 20, 20, 20, 20, 20, 20, 20,
+    /* 0xa0 */ 20,  20, 20, 20, 20, 20, 20, 20, 30, 20, 20, 20, 20, 20, 20, 20,
+    /* 0xb0 */ 20,  20, 20, 20, 20, 20, 30, 40, 70, 40, 40, 40, 20, 20, 50, 50,
+    /* 0xc0 */ 130, 50, 20, 100, 60, 20, 70, 70, 40, 20, 20, 20, 60, 20, 20, 20,
+    /* 0xd0 */ 30,  20, 20, 20, 20, 20, 20, 20, 30, 20, 20, 20, 20, 20, 20, 30,
+    /* 0xe0 */ 30,  20, 20, 20, 20, 20, 20, 20, 130, 80, 40, 60, 20, 20, 20, 20,
+    /* 0xf0 */ 30,  30, 20, 60, 20, 20, 30, 30, 50, 20, 20, 20, 20, 20, 50, 200,
+};
+
+static int ParseHexDigit(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+AobPattern::AobPattern(const std::string& patternStr)
+{
+    // Every byte is made of two digits, which are either hex digits or wildcards
+    std::string digits;
+    for (char c : patternStr)
+    {
+        if (c != ' ')
+        {
+            digits += c;
+        }
+    }
+    if (digits.empty() || digits.size() % 2 != 0)
+    {
+        throw std::invalid_argument("Invalid byte pattern, every byte must have two digits.");
+    }
+
+    for (size_t i = 0; i < digits.size(); i += 2)
+    {
+        uint8_t byte = 0;
+        uint8_t mask = 0;
+        for (size_t j = i; j < i + 2; j++)
+        {
+            byte <<= 4;
+            mask <<= 4;
+            if (digits[j] == '?')
+            {
+                continue;
+            }
+
+            const int digit = ParseHexDigit(digits[j]);
+            if (digit < 0)
+            {
+                throw std::invalid_argument(fmt::format("Invalid byte pattern, '{}' is not a hex digit.", digits[j]));
+            }
+            byte |= digit;
+            mask |= 0xf;
+        }
+        this->m_Bytes.push_back(byte);
+        this->m_Mask.push_back(mask);
+    }
+    this->ChooseAnchors();
+}
+
+AobPattern::AobPattern(const std::vector<uint8_t>& bytes, const std::vector<uint8_t>& mask)
+{
+    if (bytes.empty() || bytes.size() != mask.size())
+    {
+        throw std::invalid_argument("The bytes and the mask of a byte pattern must have the same size.");
+    }
+
+    this->m_Mask = mask;
+    for (size_t i = 0; i < bytes.size(); i++)
+    {
+        this->m_Bytes.push_back(bytes[i] & mask[i]);
+    }
+    this->ChooseAnchors();
+}
+
+void AobPattern::ChooseAnchors()
+{
+    constexpr size_t NO_ANCHOR = SIZE_MAX;
+    this->m_FirstAnchor = NO_ANCHOR;
+    this->m_SecondAnchor = NO_ANCHOR;
+
+    for (size_t i = 0; i < this->m_Bytes.size(); i++)
+    {
+        if (this->m_Mask[i] != 0xff)
+        {
+            continue;
+        }
+
+        const uint8_t score = BYTE_SCORES[this->m_Bytes[i]];
+        if (this->m_FirstAnchor == NO_ANCHOR || score < BYTE_SCORES[this->m_Bytes[this->m_FirstAnchor]])
+        {
+            this->m_SecondAnchor = this->m_FirstAnchor;
+            this->m_FirstAnchor = i;
+        }
+        else if (this->m_SecondAnchor == NO_ANCHOR || score < BYTE_SCORES[this->m_Bytes[this->m_SecondAnchor]])
+        {
+            this->m_SecondAnchor = i;
+        }
+    }
+
+    if (this->m_FirstAnchor == NO_ANCHOR)
+    {
+        throw std::invalid_argument("A byte pattern must have at least one byte without wildcards.");
+    }
+    // Patterns with a single fixed byte check it twice
+    if (this->m_SecondAnchor == NO_ANCHOR)
+    {
+        this->m_SecondAnchor = this->m_FirstAnchor;
+    }
+}
+
+bool AobPattern::Matches(const uint8_t* data) const
+{
+    const size_t size = this->m_Bytes.size();
+    for (size_t i = 0; i < size; i++)
+    {
+        if ((data[i] & this->m_Mask[i]) != this->m_Bytes[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+const uint8_t* AobPattern::FindNext(const uint8_t* begin, const uint8_t* end) const
+{
+    const size_t size = this->m_Bytes.size();
+    if (begin >= end || (size_t)(end - begin) < size)
+    {
+        return nullptr;
+    }
+
+    const uint8_t* const lastStart = end - size;
+    const uint8_t firstByte = this->m_Bytes[this->m_FirstAnchor];
+    const uint8_t secondByte = this->m_Bytes[this->m_SecondAnchor];
+    const uint8_t* pos = begin;
+
+#ifdef __SSE2__
+    // Checks the anchors of 16 positions at once, every load stays inside the range since the
+    // anchors are inside the pattern and all 16 positions are valid starts
+    const __m128i firstVec = _mm_set1_epi8((char)firstByte);
+    const __m128i secondVec = _mm_set1_epi8((char)secondByte);
+    for (; lastStart - pos >= 15; pos += 16)
+    {
+        const __m128i firstBytes = _mm_loadu_si128((const __m128i*)(pos + this->m_FirstAnchor));
+        const __m128i secondBytes = _mm_loadu_si128((const __m128i*)(pos + this->m_SecondAnchor));
+        unsigned int candidates = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(firstBytes, firstVec), 
+                    _mm_cmpeq_epi8(secondBytes, secondVec)));
+        while (candidates != 0)
+        {
+            const uint8_t* candidate = pos + __builtin_ctz(candidates);
+            if (this->Matches(candidate))
+            {
+                return candidate;
+            }
+            candidates &= candidates - 1;
+        }
+    }
+#endif
+
+    for (; pos <= lastStart; pos++)
+    {
+        // memchr is vectorized by the C library, so the first anchor is found with it
+        pos = (const uint8_t*)std::memchr(pos + this->m_FirstAnchor, firstByte, lastStart - pos + 1);
+        if (pos == nullptr)
+        {
+            return nullptr;
+        }
+        pos -= this->m_FirstAnchor;
+        if (pos[this->m_SecondAnchor] == secondByte && this->Matches(pos))
+        {
+            return pos;
+        }
+    }
+    return nullptr;
+}
+
+size_t AobPattern::GetSize() const
+{
+    return this->m_Bytes.size();
+}
+
+bool AobPattern::HasWildcards() const
+{
+    for (uint8_t mask : this->m_Mask)
+    {
+        if (mask != 0xff)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+const std::vector<uint8_t>& AobPattern::GetBytes() const
+{
+    return this->m_Bytes;
+}
+
+const std::vector<uint8_t>& AobPattern::GetMask() const
+{
+    return this->m_Mask;
+}
+
+std::string AobPattern::ToString() const
+{
+    static constexpr char HEX_DIGITS[] = "0123456789ABCDEF";
+
+    std::string str;
+    for (size_t i = 0; i < this->m_Bytes.size(); i++)
+    {
+        if (i != 0)
+        {
+            str += ' ';
+        }
+        str += (this->m_Mask[i] & 0xf0) != 0 ? HEX_DIGITS[this->m_Bytes[i] >> 4] : '?';
+        str += (this->m_Mask[i] & 0x0f) != 0 ? HEX_DIGITS[this->m_Bytes[i] & 0xf] : '?';
+    }
+    return str;
+}
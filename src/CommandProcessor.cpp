@@ -14,6 +14,13 @@
 #include "cmds/FindCommand.h"
 #include "cmds/ScanCommand.h"
 #include "cmds/FreezeCommand.h"
+#include "cmds/PatchCommand.h"
+#include "cmds/SnapshotCommand.h"
+#include "cmds/OpenCommand.h"
+#include "cmds/DiffCommand.h"
+#include "cmds/PointerCommand.h"
+#include "cmds/RefsCommand.h"
+#include "cmds/SigmakeCommand.h"
 
 using CommandMainFunc = void (*)(Process&, const std::vector<std::string>&);
 using CommandHelpFunc = std::string (*)();
@@ -27,13 +34,20 @@ struct CmdFuncs
 // All the commands are stored in this map
 static const std::unordered_map<std::string , CmdFuncs> cmdMap =
 {
-    { "pid",    { &ICommand<PidCommand>::Main,    &ICommand<PidCommand>::Help } },
-    { "map",    { &ICommand<MapCommand>::Main,    &ICommand<MapCommand>::Help } },
-    { "dump",   { &ICommand<DumpCommand>::Main,   &ICommand<DumpCommand>::Help } },
-    { "write",  { &ICommand<WriteCommand>::Main,  &ICommand<WriteCommand>::Help } },
-    { "find",   { &ICommand<FindCommand>::Main,   &ICommand<FindCommand>::Help } },
-    { "scan",   { &ICommand<ScanCommand>::Main,   &ICommand<ScanCommand>::Help } },
-    { "freeze", { &ICommand<FreezeCommand>::Main, &ICommand<FreezeCommand>::Help } }
+    { "pid",      { &ICommand<PidCommand>::Main,       &ICommand<PidCommand>::Help } },
+    { "map",      { &ICommand<MapCommand>::Main,       &ICommand<MapCommand>::Help } },
+    { "dump",     { &ICommand<DumpCommand>::Main,      &ICommand<DumpCommand>::Help } },
+    { "write",    { &ICommand<WriteCommand>::Main,     &ICommand<WriteCommand>::Help } },
+    { "find",     { &ICommand<FindCommand>::Main,      &ICommand<FindCommand>::Help } },
+    { "scan",     { &ICommand<ScanCommand>::Main,      &ICommand<ScanCommand>::Help } },
+    { "freeze",   { &ICommand<FreezeCommand>::Main,    &ICommand<FreezeCommand>::Help } },
+    { "patch",    { &ICommand<PatchCommand>::Main,     &ICommand<PatchCommand>::Help } },
+    { "snapshot", { &ICommand<SnapshotCommand>::Main,  &ICommand<SnapshotCommand>::Help } },
+    { "open",     { &ICommand<OpenCommand>::Main,      &ICommand<OpenCommand>::Help } },
+    { "diff",     { &ICommand<DiffCommand>::Main,      &ICommand<DiffCommand>::Help } },
+    { "pointer",  { &ICommand<PointerCommand>::Main,   &ICommand<PointerCommand>::Help } },
+    { "refs",     { &ICommand<RefsCommand>::Main,      &ICommand<RefsCommand>::Help } },
+    { "sigmake",  { &ICommand<SigmakeCommand>::Main,   &ICommand<SigmakeCommand>::Help } }
 };
 
 
@@ -27,9 +27,43 @@ ComparisonType ParseComparisonType(const std::string& keywordStr)
     {
         return ComparisonType::LessEqual;
     }
+    else if (keywordStr == "between")
+    {
+        return ComparisonType::Between;
+    }
+    else if (keywordStr == "outside")
+    {
+        return ComparisonType::Outside;
+    }
+    else if (keywordStr == "~")
+    {
+        return ComparisonType::Approximate;
+    }
+    else if (keywordStr == "ulps")
+    {
+        return ComparisonType::Ulps;
+    }
+    else if (keywordStr == "rounded")
+    {
+        return ComparisonType::Rounded;
+    }
+    else if (keywordStr == "truncated")
+    {
+        return ComparisonType::Truncated;
+    }
     else
     {
         throw std::invalid_argument("Invalid scan type.");
     }
 }
 
+bool IsRangeComparison(ComparisonType cmpType)
+{
+    return cmpType == ComparisonType::Between || cmpType == ComparisonType::Outside;
+}
+
+bool IsToleranceComparison(ComparisonType cmpType)
+{
+    return cmpType == ComparisonType::Approximate || cmpType == ComparisonType::Ulps ||
+        cmpType == ComparisonType::Rounded || cmpType == ComparisonType::Truncated;
+}
@@ -1,9 +1,31 @@
 #include "DataType.h"
 #include <stdexcept>
+#include <cstdint>
+
+// Returns the big-endian version of a numeric type
+static DataType ToBigEndianType(DataType dataType)
+{
+    switch (dataType)
+    {
+        case DataType::int16:  return DataType::be_int16;
+        case DataType::int32:  return DataType::be_int32;
+        case DataType::int64:  return DataType::be_int64;
+        case DataType::uint16: return DataType::be_uint16;
+        case DataType::uint32: return DataType::be_uint32;
+        case DataType::uint64: return DataType::be_uint64;
+        case DataType::f32:    return DataType::be_f32;
+        case DataType::f64:    return DataType::be_f64;
+        default: throw std::invalid_argument("Only numeric types of at least 2 bytes can be big-endian.");
+    }
+}
 
 DataType ParseDataType(const std::string& typeStr)
 {
-    if (typeStr[0] == 'i')
+    if (typeStr.starts_with("be"))
+    {
+        return ToBigEndianType(ParseDataType(typeStr.substr(2)));
+    }
+    else if (typeStr[0] == 'i')
     {
         if (typeStr == "int8")
         {
@@ -61,9 +83,68 @@ DataType ParseDataType(const std::string& typeStr)
     {
         return DataType::string;
     }
+    else if (typeStr == "aob")
+    {
+        return DataType::aob;
+    }
     else
     {
         throw std::invalid_argument("Invalid type.");
     }
 }
 
+size_t GetDataTypeSize(DataType dataType)
+{
+    switch (dataType)
+    {
+        case DataType::int8:   return sizeof(int8_t);
+        case DataType::int16:  return sizeof(int16_t);
+        case DataType::int32:  return sizeof(int32_t);
+        case DataType::int64:  return sizeof(int64_t);
+        case DataType::uint8:  return sizeof(uint8_t);
+        case DataType::uint16: return sizeof(uint16_t);
+        case DataType::uint32: return sizeof(uint32_t);
+        case DataType::uint64: return sizeof(uint64_t);
+        case DataType::f32:    return sizeof(float);
+        case DataType::f64:    return sizeof(double);
+        case DataType::string: return 0;
+        case DataType::aob:    return 0;
+        case DataType::be_int16:  return sizeof(int16_t);
+        case DataType::be_int32:  return sizeof(int32_t);
+        case DataType::be_int64:  return sizeof(int64_t);
+        case DataType::be_uint16: return sizeof(uint16_t);
+        case DataType::be_uint32: return sizeof(uint32_t);
+        case DataType::be_uint64: return sizeof(uint64_t);
+        case DataType::be_f32:    return sizeof(float);
+        case DataType::be_f64:    return sizeof(double);
+    }
+    return 0;
+}
+
+std::string DataTypeToString(DataType dataType)
+{
+    switch (dataType)
+    {
+        case DataType::int8:   return "int8";
+        case DataType::int16:  return "int16";
+        case DataType::int32:  return "int32";
+        case DataType::int64:  return "int64";
+        case DataType::uint8:  return "uint8";
+        case DataType::uint16: return "uint16";
+        case DataType::uint32: return "uint32";
+        case DataType::uint64: return "uint64";
+        case DataType::f32:    return "float";
+        case DataType::f64:    return "double";
+        case DataType::string: return "string";
+        case DataType::aob:    return "aob";
+        case DataType::be_int16:  return "beint16";
+        case DataType::be_int32:  return "beint32";
+        case DataType::be_int64:  return "beint64";
+        case DataType::be_uint16: return "beuint16";
+        case DataType::be_uint32: return "beuint32";
+        case DataType::be_uint64: return "beuint64";
+        case DataType::be_f32:    return "befloat";
+        case DataType::be_f64:    return "bedouble";
+    }
+    return "";
+}
@@ -0,0 +1,625 @@
+#include "FilterExpression.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fmt/core.h>
+#include <stdexcept>
+#include <type_traits>
+#include "BigEndian.h"
+#include "Utils.h"
+
+// Keeps the registers of a batch small enough to stay in the cache
+static constexpr size_t MAX_REGISTERS = 256;
+
+// The precedence of the binary operators as in C, 0 for everything else
+static int GetPrecedence(const std::string& opStr)
+{
+    if (opStr == "||")                                                   return 1;
+    if (opStr == "&&")                                                   return 2;
+    if (opStr == "|")                                                    return 3;
+    if (opStr == "^")                                                    return 4;
+    if (opStr == "&")                                                    return 5;
+    if (opStr == "==" || opStr == "!=")                                  return 6;
+    if (opStr == "<" || opStr == "<=" || opStr == ">" || opStr == ">=")  return 7;
+    if (opStr == "<<" || opStr == ">>")                                  return 8;
+    if (opStr == "+" || opStr == "-")                                    return 9;
+    if (opStr == "*" || opStr == "/" || opStr == "%")                    return 10;
+    return 0;
+}
+
+static bool IsFloatType(DataType dataType)
+{
+    return dataType == DataType::f32 || dataType == DataType::f64
+        || dataType == DataType::be_f32 || dataType == DataType::be_f64;
+}
+
+// Reads a value of type T every stride bytes, the integers are widened to 64 bits and the floats
+// to doubles
+template <typename T>
+static void LoadColumn(const uint8_t* data, size_t stride, size_t count, int64_t* ints, double* floats)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        T value;
+        std::memcpy(&value, data + i * stride, sizeof(T));
+        if constexpr (std::is_floating_point_v<typename NativeTypeOf<T>::Type>)
+        {
+            floats[i] = ToNativeValue(value);
+        }
+        else
+        {
+            ints[i] = (int64_t)ToNativeValue(value);
+        }
+    }
+}
+
+static void LoadTypedColumn(DataType dataType, const uint8_t* data, size_t stride, size_t count,
+        int64_t* ints, double* floats)
+{
+    switch (dataType)
+    {
+        case DataType::int8:      LoadColumn<int8_t>(data, stride, count, ints, floats);                break;
+        case DataType::int16:     LoadColumn<int16_t>(data, stride, count, ints, floats);               break;
+        case DataType::int32:     LoadColumn<int32_t>(data, stride, count, ints, floats);               break;
+        case DataType::int64:     LoadColumn<int64_t>(data, stride, count, ints, floats);               break;
+        case DataType::uint8:     LoadColumn<uint8_t>(data, stride, count, ints, floats);               break;
+        case DataType::uint16:    LoadColumn<uint16_t>(data, stride, count, ints, floats);              break;
+        case DataType::uint32:    LoadColumn<uint32_t>(data, stride, count, ints, floats);              break;
+        case DataType::uint64:    LoadColumn<uint64_t>(data, stride, count, ints, floats);              break;
+        case DataType::f32:       LoadColumn<float>(data, stride, count, ints, floats);                 break;
+        case DataType::f64:       LoadColumn<double>(data, stride, count, ints, floats);                break;
+        case DataType::be_int16:  LoadColumn<BigEndian<int16_t>>(data, stride, count, ints, floats);    break;
+        case DataType::be_int32:  LoadColumn<BigEndian<int32_t>>(data, stride, count, ints, floats);    break;
+        case DataType::be_int64:  LoadColumn<BigEndian<int64_t>>(data, stride, count, ints, floats);    break;
+        case DataType::be_uint16: LoadColumn<BigEndian<uint16_t>>(data, stride, count, ints, floats);   break;
+        case DataType::be_uint32: LoadColumn<BigEndian<uint32_t>>(data, stride, count, ints, floats);   break;
+        case DataType::be_uint64: LoadColumn<BigEndian<uint64_t>>(data, stride, count, ints, floats);   break;
+        case DataType::be_f32:    LoadColumn<BigEndian<float>>(data, stride, count, ints, floats);      break;
+        case DataType::be_f64:    LoadColumn<BigEndian<double>>(data, stride, count, ints, floats);     break;
+        default: throw std::invalid_argument("Only numeric types can be used in a filter.");
+    }
+}
+
+// The loops of the instructions, kept simple so that they are vectorized
+template <typename Dst, typename Src, typename Func>
+static void ApplyUnary(Dst* dst, const Src* src, size_t count, Func func)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        dst[i] = func(src[i]);
+    }
+}
+
+template <typename Dst, typename Src, typename Func>
+static void ApplyBinary(Dst* dst, const Src* lhs, const Src* rhs, size_t count, Func func)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        dst[i] = func(lhs[i], rhs[i]);
+    }
+}
+
+FilterExpression::FilterExpression(const std::string& expression, DataType dataType)
+{
+    const size_t valueSize = GetDataTypeSize(dataType);
+    if (valueSize == 0)
+    {
+        throw std::invalid_argument("Only numeric types can be used in a filter.");
+    }
+
+    this->m_DataType = dataType;
+    // The value is always read, it becomes the old value of the next scan
+    this->m_WindowOffset = 0;
+    this->m_WindowSize = valueSize;
+
+    const std::vector<Token> tokens = Tokenize(expression);
+    size_t pos = 0;
+    Operand result = this->ParseBinary(tokens, pos, 1);
+    if (tokens[pos].kind != Token::Kind::End)
+    {
+        throw std::invalid_argument(fmt::format("Unexpected '{}' in the filter.", tokens[pos].text));
+    }
+
+    if (result.kind == ValueKind::Float)
+    {
+        result = this->Emit(OpCode::FloatToBool, ValueKind::Int, result.reg, result.reg);
+    }
+    this->m_ResultReg = result.reg;
+
+    this->m_Registers.resize(this->m_Instructions.size() + this->m_Constants.size());
+    for (const Constant& constant : this->m_Constants)
+    {
+        Column& column = this->m_Registers[constant.reg];
+        if (constant.kind == ValueKind::Int)
+        {
+            std::fill(std::begin(column.ints), std::end(column.ints), constant.intValue);
+        }
+        else
+        {
+            std::fill(std::begin(column.floats), std::end(column.floats), constant.floatValue);
+        }
+    }
+}
+
+DataType FilterExpression::GetDataType() const
+{
+    return this->m_DataType;
+}
+
+long FilterExpression::GetWindowOffset() const
+{
+    return this->m_WindowOffset;
+}
+
+size_t FilterExpression::GetWindowSize() const
+{
+    return this->m_WindowSize;
+}
+
+void FilterExpression::Evaluate(const uint8_t* windows, const uint64_t* oldValues,
+        const unsigned long* addresses, size_t count, uint8_t* results)
+{
+    for (const Instruction& inst : this->m_Instructions)
+    {
+        int64_t* dstInts = this->m_Registers[inst.dst].ints;
+        double* dstFloats = this->m_Registers[inst.dst].floats;
+        const int64_t* lhsInts = this->m_Registers[inst.lhs].ints;
+        const int64_t* rhsInts = this->m_Registers[inst.rhs].ints;
+        const double* lhsFloats = this->m_Registers[inst.lhs].floats;
+        const double* rhsFloats = this->m_Registers[inst.rhs].floats;
+
+        // The integers wrap around on overflow instead of being undefined
+        switch (inst.op)
+        {
+            case OpCode::LoadField:
+                LoadTypedColumn(inst.dataType, windows + (inst.offset - this->m_WindowOffset), this->m_WindowSize,
+                        count, dstInts, dstFloats);
+                break;
+            case OpCode::LoadOld:
+                LoadTypedColumn(inst.dataType, (const uint8_t*)oldValues, sizeof(uint64_t), count, dstInts, dstFloats);
+                break;
+            case OpCode::LoadAddress:
+                ApplyUnary(dstInts, addresses, count, [](unsigned long a) { return (int64_t)a; });
+                break;
+
+            case OpCode::IntToFloat:
+                ApplyUnary(dstFloats, lhsInts, count, [](int64_t a) { return (double)a; });
+                break;
+            case OpCode::FloatToBool:
+                ApplyUnary(dstInts, lhsFloats, count, [](double a) { return (int64_t)(a != 0.0); });
+                break;
+
+            case OpCode::IntAdd:
+                ApplyBinary(dstInts, lhsInts, rhsInts, count, [](int64_t a, int64_t b) { return (int64_t)((uint64_t)a + (uint64_t)b); });
+                break;
+            case OpCode::IntSub:
+                ApplyBinary(dstInts, lhsInts, rhsInts, count, [](int64_t a, int64_t b) { return (int64_t)((uint64_t)a - (uint64_t)b); });
+                break;
+            case OpCode::IntMul:
+                ApplyBinary(dstInts, lhsInts, rhsInts, count, [](int64_t a, int64_t b) { return (int64_t)((uint64_t)a * (uint64_t)b); });
+                break;
+            // Division by 0 results in 0, and the overflowing division by -1 is done as a negation
+            case OpCode::IntDiv:
+                ApplyBinary(dstInts, lhsInts, rhsInts, count, [](int64_t a, int64_t b)
+                {
+                    return b == -1 ? (int64_t)(0 - (uint64_t)a) : (b == 0 ? 0 : a / b);
+                });
+                break;
+            case OpCode::IntMod:
+                ApplyBinary(dstInts, lhsInts, rhsInts, count, [](int64_t a, int64_t b)
+                {
+                    return b == -1 || b == 0 ? 0 : a % b;
+                });
+                break;
+            case OpCode::IntAnd:
+                ApplyBinary(dstInts, lhsInts, rhsInts, count, [](int64_t a, int64_t b) { return a & b; });
+                break;
+            case OpCode::IntOr:
+                ApplyBinary(dstInts, lhsInts, rhsInts, count, [](int64_t a, int64_t b) { return a | b; });
+                break;
+            case OpCode::IntXor:
+                ApplyBinary(dstInts, lhsInts, rhsInts, count, [](int64_t a, int64_t b) { return a ^ b; });
+                break;
+            // Only the low 6 bits of the amount are used, like the shift instructions of x86
+            case OpCode::IntShl:
+                ApplyBinary(dstInts, lhsInts, rhsInts, count, [](int64_t a, int64_t b) { return (int64_t)((uint64_t)a << (b & 63)); });
+                break;
+            case OpCode::IntShr:
+                ApplyBinary(dstInts, lhsInts, rhsInts, count, [](int64_t a, int64_t b) { return a >> (b & 63); });
+                break;
+            case OpCode::IntEq:
+                ApplyBinary(dstInts, lhsInts, rhsInts, count, [](int64_t a, int64_t b) { return (int64_t)(a == b); });
+                break;
+            case OpCode::IntNe:
+                ApplyBinary(dstInts, lhsInts, rhsInts, count, [](int64_t a, int64_t b) { return (int64_t)(a != b); });
+                break;
+            case OpCode::IntLt:
+                ApplyBinary(dstInts, lhsInts, rhsInts, count, [](int64_t a, int64_t b) { return (int64_t)(a < b); });
+                break;
+            case OpCode::IntLe:
+                ApplyBinary(dstInts, lhsInts, rhsInts, count, [](int64_t a, int64_t b) { return (int64_t)(a <= b); });
+                break;
+            case OpCode::IntGt:
+                ApplyBinary(dstInts, lhsInts, rhsInts, count, [](int64_t a, int64_t b) { return (int64_t)(a > b); });
+                break;
+            case OpCode::IntGe:
+                ApplyBinary(dstInts, lhsInts, rhsInts, count, [](int64_t a, int64_t b) { return (int64_t)(a >= b); });
+                break;
+            case OpCode::LogicalAnd:
+                ApplyBinary(dstInts, lhsInts, rhsInts, count, [](int64_t a, int64_t b) { return (int64_t)((a != 0) & (b != 0)); });
+                break;
+            case OpCode::LogicalOr:
+                ApplyBinary(dstInts, lhsInts, rhsInts, count, [](int64_t a, int64_t b) { return (int64_t)((a != 0) | (b != 0)); });
+                break;
+            case OpCode::IntNeg:
+                ApplyUnary(dstInts, lhsInts, count, [](int64_t a) { return (int64_t)(0 - (uint64_t)a); });
+                break;
+            case OpCode::IntNot:
+                ApplyUnary(dstInts, lhsInts, count, [](int64_t a) { return (int64_t)(a == 0); });
+                break;
+            case OpCode::IntBitNot:
+                ApplyUnary(dstInts, lhsInts, count, [](int64_t a) { return ~a; });
+                break;
+
+            case OpCode::FloatAdd:
+                ApplyBinary(dstFloats, lhsFloats, rhsFloats, count, [](double a, double b) { return a + b; });
+                break;
+            case OpCode::FloatSub:
+                ApplyBinary(dstFloats, lhsFloats, rhsFloats, count, [](double a, double b) { return a - b; });
+                break;
+            case OpCode::FloatMul:
+                ApplyBinary(dstFloats, lhsFloats, rhsFloats, count, [](double a, double b) { return a * b; });
+                break;
+            case OpCode::FloatDiv:
+                ApplyBinary(dstFloats, lhsFloats, rhsFloats, count, [](double a, double b) { return a / b; });
+                break;
+            case OpCode::FloatEq:
+                ApplyBinary(dstInts, lhsFloats, rhsFloats, count, [](double a, double b) { return (int64_t)(a == b); });
+                break;
+            case OpCode::FloatNe:
+                ApplyBinary(dstInts, lhsFloats, rhsFloats, count, [](double a, double b) { return (int64_t)(a != b); });
+                break;
+            case OpCode::FloatLt:
+                ApplyBinary(dstInts, lhsFloats, rhsFloats, count, [](double a, double b) { return (int64_t)(a < b); });
+                break;
+            case OpCode::FloatLe:
+                ApplyBinary(dstInts, lhsFloats, rhsFloats, count, [](double a, double b) { return (int64_t)(a <= b); });
+                break;
+            case OpCode::FloatGt:
+                ApplyBinary(dstInts, lhsFloats, rhsFloats, count, [](double a, double b) { return (int64_t)(a > b); });
+                break;
+            case OpCode::FloatGe:
+                ApplyBinary(dstInts, lhsFloats, rhsFloats, count, [](double a, double b) { return (int64_t)(a >= b); });
+                break;
+            case OpCode::FloatNeg:
+                ApplyUnary(dstFloats, lhsFloats, count, [](double a) { return -a; });
+                break;
+            case OpCode::FloatNot:
+                ApplyUnary(dstInts, lhsFloats, count, [](double a) { return (int64_t)(a == 0.0); });
+                break;
+        }
+    }
+
+    ApplyUnary(results, this->m_Registers[this->m_ResultReg].ints, count, [](int64_t a) { return (uint8_t)(a != 0); });
+}
+
+std::vector<FilterExpression::Token> FilterExpression::Tokenize(const std::string& expression)
+{
+    // The operators of two characters are matched before the ones of a single character
+    static const char* const operators[] = {
+        "&&", "||", "==", "!=", "<=", ">=", "<<", ">>",
+        "+", "-", "*", "/", "%", "&", "|", "^", "<", ">", "!", "~", "(", ")", "[", "]",
+    };
+
+    std::vector<Token> tokens;
+    size_t i = 0;
+    while (i < expression.size())
+    {
+        const char c = expression[i];
+        if (std::isspace((unsigned char)c))
+        {
+            i++;
+        }
+        else if (std::isdigit((unsigned char)c) || (c == '.' && std::isdigit((unsigned char)expression[i + 1])))
+        {
+            // Takes the letters as well so that hex numbers and exponents are a single token, the
+            // number is checked when it is converted
+            const bool isHex = expression.compare(i, 2, "0x") == 0 || expression.compare(i, 2, "0X") == 0;
+            size_t end = i;
+            while (end < expression.size())
+            {
+                const char next = expression[end];
+                const bool isExponentSign = !isHex && (next == '+' || next == '-')
+                    && (expression[end - 1] == 'e' || expression[end - 1] == 'E');
+                if (!std::isalnum((unsigned char)next) && next != '.' && !isExponentSign)
+                {
+                    break;
+                }
+                end++;
+            }
+            tokens.push_back({ Token::Kind::Number, expression.substr(i, end - i) });
+            i = end;
+        }
+        else if (std::isalpha((unsigned char)c) || c == '_')
+        {
+            size_t end = i;
+            while (end < expression.size() && (std::isalnum((unsigned char)expression[end]) || expression[end] == '_'))
+            {
+                end++;
+            }
+            tokens.push_back({ Token::Kind::Name, expression.substr(i, end - i) });
+            i = end;
+        }
+        else
+        {
+            auto opIt = std::find_if(std::begin(operators), std::end(operators),
+                    [&](const char* op) { return expression.compare(i, std::strlen(op), op) == 0; });
+            if (opIt == std::end(operators))
+            {
+                throw std::invalid_argument(fmt::format("Unexpected character '{}' in the filter.", c));
+            }
+            tokens.push_back({ Token::Kind::Operator, *opIt });
+            i += tokens.back().text.size();
+        }
+    }
+    tokens.push_back({ Token::Kind::End, "end of the filter" });
+    return tokens;
+}
+
+// Parses the operators with a precedence of at least minPrecedence, from left to right
+FilterExpression::Operand FilterExpression::ParseBinary(const std::vector<Token>& tokens, size_t& pos,
+        int minPrecedence)
+{
+    Operand lhs = this->ParseUnary(tokens, pos);
+    while (tokens[pos].kind == Token::Kind::Operator && GetPrecedence(tokens[pos].text) >= minPrecedence)
+    {
+        const std::string& opStr = tokens[pos].text;
+        pos++;
+        const Operand rhs = this->ParseBinary(tokens, pos, GetPrecedence(opStr) + 1);
+        lhs = this->EmitBinary(opStr, lhs, rhs);
+    }
+    return lhs;
+}
+
+FilterExpression::Operand FilterExpression::ParseUnary(const std::vector<Token>& tokens, size_t& pos)
+{
+    if (tokens[pos].kind != Token::Kind::Operator)
+    {
+        return this->ParsePrimary(tokens, pos);
+    }
+
+    const std::string& opStr = tokens[pos].text;
+    if (opStr == "-" && tokens[pos + 1].kind == Token::Kind::Number)
+    {
+        // Negative numbers are constants, so that the lowest integer can be written too
+        pos += 2;
+        return this->EmitConstant("-" + tokens[pos - 1].text);
+    }
+    else if (opStr == "+" || opStr == "-" || opStr == "!" || opStr == "~")
+    {
+        pos++;
+        const Operand operand = this->ParseUnary(tokens, pos);
+        if (opStr == "+")
+        {
+            return operand;
+        }
+        else if (opStr == "-")
+        {
+            return operand.kind == ValueKind::Int
+                ? this->Emit(OpCode::IntNeg, ValueKind::Int, operand.reg, operand.reg)
+                : this->Emit(OpCode::FloatNeg, ValueKind::Float, operand.reg, operand.reg);
+        }
+        else if (opStr == "!")
+        {
+            return this->Emit(operand.kind == ValueKind::Int ? OpCode::IntNot : OpCode::FloatNot, ValueKind::Int,
+                    operand.reg, operand.reg);
+        }
+        else if (operand.kind == ValueKind::Float)
+        {
+            throw std::invalid_argument("The operator ~ can only be used with integers.");
+        }
+        return this->Emit(OpCode::IntBitNot, ValueKind::Int, operand.reg, operand.reg);
+    }
+    return this->ParsePrimary(tokens, pos);
+}
+
+FilterExpression::Operand FilterExpression::ParsePrimary(const std::vector<Token>& tokens, size_t& pos)
+{
+    const Token& token = tokens[pos];
+    pos++;
+    if (token.kind == Token::Kind::Number)
+    {
+        return this->EmitConstant(token.text);
+    }
+    else if (token.kind == Token::Kind::Operator && token.text == "(")
+    {
+        const Operand operand = this->ParseBinary(tokens, pos, 1);
+        if (tokens[pos].text != ")")
+        {
+            throw std::invalid_argument(fmt::format("Expected ')' in the filter but found '{}'.", tokens[pos].text));
+        }
+        pos++;
+        return operand;
+    }
+    else if (token.kind != Token::Kind::Name)
+    {
+        throw std::invalid_argument(fmt::format("Unexpected '{}' in the filter.", token.text));
+    }
+
+    if (token.text == "value")
+    {
+        return this->EmitLoad(OpCode::LoadField, this->m_DataType, 0);
+    }
+    else if (token.text == "old")
+    {
+        return this->EmitLoad(OpCode::LoadOld, this->m_DataType, 0);
+    }
+    else if (token.text == "addr")
+    {
+        return this->EmitLoad(OpCode::LoadAddress, this->m_DataType, 0);
+    }
+
+    // A field, written as <type>[<offset>]
+    const DataType fieldType = ParseDataType(token.text);
+    if (GetDataTypeSize(fieldType) == 0)
+    {
+        throw std::invalid_argument("Only numeric types can be used in a filter.");
+    }
+    if (tokens[pos].text != "[")
+    {
+        throw std::invalid_argument(fmt::format("Expected '[' after the type {} in the filter.", token.text));
+    }
+    pos++;
+
+    bool isNegative = false;
+    if (tokens[pos].text == "+" || tokens[pos].text == "-")
+    {
+        isNegative = tokens[pos].text == "-";
+        pos++;
+    }
+    if (tokens[pos].kind != Token::Kind::Number || tokens[pos + 1].text != "]")
+    {
+        throw std::invalid_argument(fmt::format("Expected an offset and ']' after the type {} in the filter.", token.text));
+    }
+    const long offset = Utils::StrToNumber<long>(tokens[pos].text, "offset");
+    pos += 2;
+    return this->EmitLoad(OpCode::LoadField, fieldType, isNegative ? -offset : offset);
+}
+
+FilterExpression::Operand FilterExpression::EmitBinary(const std::string& opStr, Operand lhs, Operand rhs)
+{
+    if (opStr == "&&" || opStr == "||")
+    {
+        if (lhs.kind == ValueKind::Float)
+        {
+            lhs = this->Emit(OpCode::FloatToBool, ValueKind::Int, lhs.reg, lhs.reg);
+        }
+        if (rhs.kind == ValueKind::Float)
+        {
+            rhs = this->Emit(OpCode::FloatToBool, ValueKind::Int, rhs.reg, rhs.reg);
+        }
+        return this->Emit(opStr == "&&" ? OpCode::LogicalAnd : OpCode::LogicalOr, ValueKind::Int, lhs.reg, rhs.reg);
+    }
+
+    struct BinaryOp
+    {
+        const char* opStr;
+        OpCode intOp;
+        OpCode floatOp; // The same as intOp for the operators which only take integers
+        ValueKind floatResult;
+    };
+    static const BinaryOp binaryOps[] = {
+        { "+",  OpCode::IntAdd, OpCode::FloatAdd, ValueKind::Float },
+        { "-",  OpCode::IntSub, OpCode::FloatSub, ValueKind::Float },
+        { "*",  OpCode::IntMul, OpCode::FloatMul, ValueKind::Float },
+        { "/",  OpCode::IntDiv, OpCode::FloatDiv, ValueKind::Float },
+        { "==", OpCode::IntEq,  OpCode::FloatEq,  ValueKind::Int },
+        { "!=", OpCode::IntNe,  OpCode::FloatNe,  ValueKind::Int },
+        { "<",  OpCode::IntLt,  OpCode::FloatLt,  ValueKind::Int },
+        { "<=", OpCode::IntLe,  OpCode::FloatLe,  ValueKind::Int },
+        { ">",  OpCode::IntGt,  OpCode::FloatGt,  ValueKind::Int },
+        { ">=", OpCode::IntGe,  OpCode::FloatGe,  ValueKind::Int },
+        { "%",  OpCode::IntMod, OpCode::IntMod,   ValueKind::Int },
+        { "&",  OpCode::IntAnd, OpCode::IntAnd,   ValueKind::Int },
+        { "|",  OpCode::IntOr,  OpCode::IntOr,    ValueKind::Int },
+        { "^",  OpCode::IntXor, OpCode::IntXor,   ValueKind::Int },
+        { "<<", OpCode::IntShl, OpCode::IntShl,   ValueKind::Int },
+        { ">>", OpCode::IntShr, OpCode::IntShr,   ValueKind::Int },
+    };
+
+    auto opIt = std::find_if(std::begin(binaryOps), std::end(binaryOps),
+            [&](const BinaryOp& op) { return opStr == op.opStr; });
+    // This should never happen, the parser only passes operators with a precedence
+    if (opIt == std::end(binaryOps))
+    {
+        throw std::runtime_error(fmt::format("Invalid operator {} in EmitBinary().", opStr));
+    }
+
+    if (lhs.kind == ValueKind::Int && rhs.kind == ValueKind::Int)
+    {
+        return this->Emit(opIt->intOp, ValueKind::Int, lhs.reg, rhs.reg);
+    }
+    else if (opIt->intOp == opIt->floatOp)
+    {
+        throw std::invalid_argument(fmt::format("The operator {} can only be used with integers.", opStr));
+    }
+    lhs = this->ToFloat(lhs);
+    rhs = this->ToFloat(rhs);
+    return this->Emit(opIt->floatOp, opIt->floatResult, lhs.reg, rhs.reg);
+}
+
+// The same load is only done once, however many times it is used
+FilterExpression::Operand FilterExpression::EmitLoad(OpCode op, DataType dataType, long offset)
+{
+    const ValueKind kind = op != OpCode::LoadAddress && IsFloatType(dataType) ? ValueKind::Float : ValueKind::Int;
+    for (const Instruction& inst : this->m_Instructions)
+    {
+        if (inst.op == op && inst.dataType == dataType && inst.offset == offset)
+        {
+            return { inst.dst, kind };
+        }
+    }
+
+    if (op == OpCode::LoadField)
+    {
+        const long windowEnd = std::max<long>(this->m_WindowOffset + this->m_WindowSize, offset + GetDataTypeSize(dataType));
+        this->m_WindowOffset = std::min(this->m_WindowOffset, offset);
+        this->m_WindowSize = windowEnd - this->m_WindowOffset;
+    }
+
+    const Operand operand = this->Emit(op, kind, 0, 0);
+    this->m_Instructions.back().dataType = dataType;
+    this->m_Instructions.back().offset = offset;
+    return operand;
+}
+
+FilterExpression::Operand FilterExpression::EmitConstant(const std::string& numberStr)
+{
+    const bool isNegative = numberStr[0] == '-';
+    const std::string digitsStr = isNegative ? numberStr.substr(1) : numberStr;
+    const bool isHex = digitsStr.starts_with("0x") || digitsStr.starts_with("0X");
+
+    Constant constant = { 0, ValueKind::Int, 0, 0.0 };
+    if (!isHex && digitsStr.find_first_of(".eE") != std::string::npos)
+    {
+        constant.kind = ValueKind::Float;
+        constant.floatValue = Utils::StrToNumber<double>(digitsStr, "number");
+        constant.floatValue = isNegative ? -constant.floatValue : constant.floatValue;
+    }
+    else
+    {
+        // Numbers above the highest int64 are kept as their bits, so that unsigned values can be
+        // written in full
+        const uint64_t bits = Utils::StrToNumber<uint64_t>(digitsStr, "number");
+        constant.intValue = (int64_t)(isNegative ? 0 - bits : bits);
+    }
+
+    if (this->m_Instructions.size() + this->m_Constants.size() >= MAX_REGISTERS)
+    {
+        throw std::invalid_argument("The filter is too long.");
+    }
+    constant.reg = this->m_Instructions.size() + this->m_Constants.size();
+    this->m_Constants.push_back(constant);
+    return { constant.reg, constant.kind };
+}
+
+FilterExpression::Operand FilterExpression::Emit(OpCode op, ValueKind kind, uint16_t lhs, uint16_t rhs)
+{
+    if (this->m_Instructions.size() + this->m_Constants.size() >= MAX_REGISTERS)
+    {
+        throw std::invalid_argument("The filter is too long.");
+    }
+
+    const uint16_t dst = this->m_Instructions.size() + this->m_Constants.size();
+    this->m_Instructions.push_back({ op, this->m_DataType, dst, lhs, rhs, 0 });
+    return { dst, kind };
+}
+
+FilterExpression::Operand FilterExpression::ToFloat(Operand operand)
+{
+    if (operand.kind == ValueKind::Float)
+    {
+        return operand;
+    }
+    return this->Emit(OpCode::IntToFloat, ValueKind::Float, operand.reg, operand.reg);
+}
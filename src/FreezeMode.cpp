@@ -0,0 +1,48 @@
+#include "FreezeMode.h"
+#include <stdexcept>
+
+FreezeMode ParseFreezeMode(const std::string& modeStr)
+{
+    if (modeStr == "set")
+    {
+        return FreezeMode::Set;
+    }
+    else if (modeStr == "changed")
+    {
+        return FreezeMode::Changed;
+    }
+    else if (modeStr == "min")
+    {
+        return FreezeMode::Min;
+    }
+    else if (modeStr == "max")
+    {
+        return FreezeMode::Max;
+    }
+    else if (modeStr == "increase")
+    {
+        return FreezeMode::Increase;
+    }
+    else if (modeStr == "decrease")
+    {
+        return FreezeMode::Decrease;
+    }
+    else
+    {
+        throw std::invalid_argument("Invalid freeze mode.");
+    }
+}
+
+std::string FreezeModeToString(FreezeMode mode)
+{
+    switch (mode)
+    {
+        case FreezeMode::Set:       return "set";
+        case FreezeMode::Changed:   return "changed";
+        case FreezeMode::Min:       return "min";
+        case FreezeMode::Max:       return "max";
+        case FreezeMode::Increase:  return "increase";
+        case FreezeMode::Decrease:  return "decrease";
+    }
+    return "unknown";
+}
@@ -4,202 +4,669 @@
 #include <stdexcept>
 #include <thread>
 #include <vector>
+#include <chrono>
+#include <algorithm>
+#include <unordered_map>
+#include <cstring>
 #include "MemoryFuncs.h"
 #include <fmt/core.h>
 
+template <typename T>
+static bool IsLess(const uint8_t* lhs, const uint8_t* rhs)
+{
+    return MemoryFuncs::CompareData<T>(lhs, rhs, sizeof(T), ComparisonType::Less);
+}
+
+// Compares two values of the given type
+static bool IsValueLess(DataType dataType, const uint8_t* lhs, const uint8_t* rhs)
+{
+    switch (dataType)
+    {
+        case DataType::int8:   return IsLess<int8_t>(lhs, rhs);
+        case DataType::int16:  return IsLess<int16_t>(lhs, rhs);
+        case DataType::int32:  return IsLess<int32_t>(lhs, rhs);
+        case DataType::int64:  return IsLess<int64_t>(lhs, rhs);
+        case DataType::uint8:  return IsLess<uint8_t>(lhs, rhs);
+        case DataType::uint16: return IsLess<uint16_t>(lhs, rhs);
+        case DataType::uint32: return IsLess<uint32_t>(lhs, rhs);
+        case DataType::uint64: return IsLess<uint64_t>(lhs, rhs);
+        case DataType::f32:    return IsLess<float>(lhs, rhs);
+        case DataType::f64:    return IsLess<double>(lhs, rhs);
+        case DataType::string: break; // Strings are rejected by CheckMode
+        case DataType::aob:    break; // Byte patterns are rejected by CheckMode
+        case DataType::be_int16:  return IsLess<BigEndian<int16_t>>(lhs, rhs);
+        case DataType::be_int32:  return IsLess<BigEndian<int32_t>>(lhs, rhs);
+        case DataType::be_int64:  return IsLess<BigEndian<int64_t>>(lhs, rhs);
+        case DataType::be_uint16: return IsLess<BigEndian<uint16_t>>(lhs, rhs);
+        case DataType::be_uint32: return IsLess<BigEndian<uint32_t>>(lhs, rhs);
+        case DataType::be_uint64: return IsLess<BigEndian<uint64_t>>(lhs, rhs);
+        case DataType::be_f32:    return IsLess<BigEndian<float>>(lhs, rhs);
+        case DataType::be_f64:    return IsLess<BigEndian<double>>(lhs, rhs);
+    }
+    return false;
+}
+
+// Decides whether the value should be written based on the current value in memory
+// The value is updated by the modes Increase and Decrease when the current value moves the allowed way
+static bool ShouldWriteValue(FreezeMode mode, DataType dataType, const uint8_t* current, uint8_t* value,
+        size_t dataSize)
+{
+    switch (mode)
+    {
+        case FreezeMode::Set:
+            return true;
+
+        case FreezeMode::Changed:
+            return std::memcmp(current, value, dataSize) != 0;
+
+        case FreezeMode::Min:
+            return IsValueLess(dataType, current, value);
+
+        case FreezeMode::Max:
+            return IsValueLess(dataType, value, current);
+
+        case FreezeMode::Increase:
+            if (IsValueLess(dataType, value, current))
+            {
+                std::memcpy(value, current, dataSize);
+                return false;
+            }
+            return IsValueLess(dataType, current, value);
+
+        case FreezeMode::Decrease:
+            if (IsValueLess(dataType, current, value))
+            {
+                std::memcpy(value, current, dataSize);
+                return false;
+            }
+            return IsValueLess(dataType, value, current);
+    }
+    return true;
+}
+
 MemoryFreezer::MemoryFreezer()
 {
     this->m_EnabledAddressesAmount = 0;
-    this->m_ThreadRunning = false;
+    this->m_ShardCount = 1;
+    this->m_StopWorkers = false;
     this->m_pid = 0;
+    this->m_PayloadGarbage = 0;
+    this->m_ReportedDroppedEvents = 0;
+    this->m_SweptDroppedEvents = 0;
+    this->m_Version = 0;
+    this->m_ControlVersion = 0;
+    this->m_TickRate = DEFAULT_TICK_RATE;
+    this->m_Controls = std::make_shared<std::vector<EntryControl>>();
+
+    // Start with an empty snapshot so that there is always one to load
+    auto snapshot = std::make_shared<FreezeListSnapshot>();
+    snapshot->version = 0;
+    snapshot->pid = 0;
+    snapshot->entries = std::make_shared<const std::vector<FrozenEntry>>();
+    snapshot->entryInfo = std::make_shared<const std::vector<std::shared_ptr<const FrozenEntryInfo>>>();
+    snapshot->payloadArena = std::make_shared<const std::vector<uint8_t>>();
+    snapshot->controls = this->m_Controls;
+    this->m_Snapshot.store(snapshot);
 }
 
-MemoryFreezer::~MemoryFreezer() {}
+MemoryFreezer::~MemoryFreezer()
+{
+    this->StopWorkers();
+}
 
-void MemoryFreezer::AddAddress(MemAddress memAddress, const std::string& typeStr, const std::string& dataStr, 
-        std::vector<uint8_t>& data, const std::string& note)
+void EntryControl::Reset(uint32_t generation)
 {
-    // Prevent adding read-only addresses
-    if (!memAddress.memRegion.perms.writeFlag)
-    {
-        throw std::runtime_error("Cannot add read-only address.");
-    }
+    this->state = generation;
+}
 
-    // Check if the address already exists
-    for (auto it = this->m_FrozenAddresses.cbegin(); it != this->m_FrozenAddresses.cend(); it++)
-    {
-        if (it->memAddress.address == memAddress.address)
+void EntryControl::SetFailed(uint32_t generation)
+{
+    // Fails if the slot was reused or the flag is already set, either way there is nothing to do
+    uint64_t expected = generation;
+    this->state.compare_exchange_strong(expected, generation | FAILED_FLAG);
+}
+
+void EntryControl::ClearFailed()
+{
+    this->state &= ~FAILED_FLAG;
+}
+
+bool EntryControl::HasFailed() const
+{
+    return this->state & FAILED_FLAG;
+}
+
+bool EntryControl::IsUsable(uint32_t generation) const
+{
+    return this->state == generation;
+}
+
+const EntryControl& FreezeListSnapshot::GetControl(const FrozenEntry& entry) const
+{
+    return (*this->controls)[entry.handle.slot];
+}
+
+// The disabled entries are in the order too, so enabling one doesn't change the order
+const std::vector<uint32_t>& FreezeListSnapshot::GetAddressOrder() const
+{
+    std::call_once(this->m_AddressOrderFlag, [this]()
         {
-            throw std::runtime_error("The address is already in the list.");
-        }
-    }
+            this->m_AddressOrder.reserve(this->entries->size());
+            for (uint32_t i = 0; i < this->entries->size(); i++)
+            {
+                if ((*this->entries)[i].used)
+                {
+                    this->m_AddressOrder.push_back(i);
+                }
+            }
 
-    // Add the address but have it disabled
-    FrozenMemAddress frozenAddr = { memAddress, false, typeStr, dataStr, data, note };
+            std::sort(this->m_AddressOrder.begin(), this->m_AddressOrder.end(),
+                [this](uint32_t lhs, uint32_t rhs)
+                {
+                    return (*this->entries)[lhs].address < (*this->entries)[rhs].address;
+                });
+        });
+    return this->m_AddressOrder;
+}
 
-    this->m_MemoryFreezerMutex.lock();
+// Publishes a new snapshot of the list, copying only the parts which were changed
+void MemoryFreezer::PublishSnapshot(uint8_t changes)
+{
+    const std::shared_ptr<const FreezeListSnapshot> oldSnapshot = this->m_Snapshot.load();
 
-    this->m_FrozenAddresses.push_back(frozenAddr);
+    auto snapshot = std::make_shared<FreezeListSnapshot>();
+    snapshot->version = oldSnapshot->version + 1;
+    snapshot->pid = this->m_pid;
+    snapshot->entries = (changes & ListChange::Entries) 
+        ? std::make_shared<const std::vector<FrozenEntry>>(this->m_Entries) : oldSnapshot->entries;
+    snapshot->entryInfo = (changes & ListChange::Info)
+        ? std::make_shared<const std::vector<std::shared_ptr<const FrozenEntryInfo>>>(this->m_EntryInfo) 
+        : oldSnapshot->entryInfo;
+    snapshot->payloadArena = (changes & ListChange::Data)
+        ? std::make_shared<const std::vector<uint8_t>>(this->m_PayloadArena) : oldSnapshot->payloadArena;
+    snapshot->controls = this->m_Controls;
 
-    this->m_MemoryFreezerMutex.unlock();
+    // The version is updated after the snapshot, so a thread which sees the new version
+    // always loads a snapshot which is at least as new
+    this->m_Snapshot.store(snapshot);
+    this->m_Version = snapshot->version;
 }
 
-void MemoryFreezer::RemoveAddress(size_t index)
+// Publishes the change to the threads and readers, and wakes the threads up if they are sleeping
+// until their next deadline
+void MemoryFreezer::NotifyListChanged(uint8_t changes)
+{
+    this->PublishSnapshot(changes);
+
+    // Taking the lock of the sleeping threads ensures they don't miss the new version
+    std::lock_guard<std::mutex> wakeLock(this->m_WakeMutex);
+    this->m_WakeCondition.notify_all();
+}
+
+void MemoryFreezer::NotifyControlsChanged()
+{
+    this->m_ControlVersion++;
+
+    std::lock_guard<std::mutex> wakeLock(this->m_WakeMutex);
+    this->m_WakeCondition.notify_all();
+}
+
+EntryControl& MemoryFreezer::GetControl(size_t index)
 {
-    if (index >= this->m_FrozenAddresses.size())
+    return (*this->m_Controls)[this->m_Entries[index].handle.slot];
+}
+
+void MemoryFreezer::CheckIndex(size_t index) const
+{
+    if (index >= this->m_Entries.size() || !this->m_Entries[index].used)
     {
         throw std::runtime_error("Index out of bounds.");
     }
-    else
+}
+
+void MemoryFreezer::CheckMode(DataType dataType, FreezeMode mode) const
+{
+    if ((dataType == DataType::string || dataType == DataType::aob) && mode != FreezeMode::Set 
+            && mode != FreezeMode::Changed)
     {
-        auto iter = this->m_FrozenAddresses.cbegin();
-        std::advance(iter, index);
+        const std::string err = fmt::format("The freeze mode '{}' can't be used with strings or byte patterns.", 
+                FreezeModeToString(mode));
+        throw std::runtime_error(err);
+    }
+}
 
-        this->m_MemoryFreezerMutex.lock();
+// Appends the data to the payload arena and returns its offset
+uint32_t MemoryFreezer::StoreData(const std::vector<uint8_t>& data)
+{
+    if (this->m_PayloadArena.size() + data.size() > UINT32_MAX)
+    {
+        throw std::runtime_error("The freeze list is out of space for data.");
+    }
 
-        // Make sure to decrement the enabled addresses, if the erased address was enabled
-        if (iter->enabled)
+    const uint32_t offset = this->m_PayloadArena.size();
+    this->m_PayloadArena.insert(this->m_PayloadArena.end(), data.begin(), data.end());
+    return offset;
+}
+
+// Removes the unused data from the payload arena
+void MemoryFreezer::CompactArena()
+{
+    std::vector<uint8_t> compacted;
+    compacted.reserve(this->m_PayloadArena.size() - this->m_PayloadGarbage);
+
+    for (FrozenEntry& entry : this->m_Entries)
+    {
+        if (!entry.used)
         {
-            this->m_EnabledAddressesAmount -= 1;
+            continue;
         }
-        this->m_FrozenAddresses.erase(iter);
-
-        // Prevents a possible crash where the thread might attempt to use a deleted iterator
-        this->m_FrozenAddressIter = this->m_FrozenAddresses.begin();
 
-        this->m_MemoryFreezerMutex.unlock();
+        const uint8_t* data = &this->m_PayloadArena[entry.dataOffset];
+        entry.dataOffset = compacted.size();
+        compacted.insert(compacted.end(), data, data + entry.dataSize);
     }
+    this->m_PayloadArena = std::move(compacted);
+    this->m_PayloadGarbage = 0;
 }
 
-void MemoryFreezer::RemoveAllAddresses()
+void MemoryFreezer::ClearEntries()
 {
-    this->m_MemoryFreezerMutex.lock();
-
+    // Invalidate the handles of all the entries, the rows are taken again from the first one
+    for (const FrozenEntry& entry : this->m_Entries)
+    {
+        if (entry.used)
+        {
+            (*this->m_Controls)[entry.handle.slot].enabled = false;
+            this->m_SlotGenerations[entry.handle.slot]++;
+        }
+    }
+    this->m_Entries.clear();
+    this->m_EntryInfo.clear();
+    this->m_FreeSlots.clear();
     this->m_FrozenAddresses.clear();
+    this->m_PayloadArena.clear();
+    this->m_PayloadGarbage = 0;
     this->m_EnabledAddressesAmount = 0;
-
-    this->m_MemoryFreezerMutex.unlock();
+    this->NotifyListChanged(ListChange::All);
 }
 
-void MemoryFreezer::EnableAddress(size_t index)
+// Adds a disabled entry for the address, the address is expected to not be in the list already
+void MemoryFreezer::InsertEntry(const MemAddress& memAddress, DataType dataType, const std::string& typeStr,
+        const std::string& dataStr, const std::vector<uint8_t>& data, const std::string& note)
 {
-    if (index >= this->m_FrozenAddresses.size())
+    const uint32_t dataOffset = this->StoreData(data);
+
+    // Reuse the row of a removed entry if there is one
+    uint32_t slot;
+    if (this->m_FreeSlots.empty())
     {
-        throw std::runtime_error("Index out of bounds.");
+        slot = this->m_Entries.size();
+        this->m_Entries.emplace_back();
+        this->m_EntryInfo.emplace_back();
+        if (slot >= this->m_SlotGenerations.size())
+        {
+            this->m_SlotGenerations.push_back(0);
+        }
     }
     else
     {
-        auto iter = this->m_FrozenAddresses.begin();
-        std::advance(iter, index);
+        slot = this->m_FreeSlots.back();
+        this->m_FreeSlots.pop_back();
+    }
 
-        if (!iter->enabled)
+    // The threads keep reading the old controls until they see the next version of the list, which
+    // is published right after the entry is inserted
+    if (slot >= this->m_Controls->size())
+    {
+        auto controls = std::make_shared<std::vector<EntryControl>>(std::max<size_t>(64, (size_t)slot * 2));
+        for (size_t i = 0; i < this->m_Controls->size(); i++)
         {
-            this->m_MemoryFreezerMutex.lock();
+            const EntryControl& oldControl = (*this->m_Controls)[i];
+            EntryControl& control = (*controls)[i];
+            control.state = oldControl.state.load();
+            control.intervalUs = oldControl.intervalUs.load();
+            control.mode = oldControl.mode.load();
+            control.enabled = oldControl.enabled.load();
+        }
+        this->m_Controls = std::move(controls);
+    }
 
-            iter->enabled = true;
-            this->m_EnabledAddressesAmount += 1;
+    EntryControl& control = (*this->m_Controls)[slot];
+    control.Reset(this->m_SlotGenerations[slot]);
+    control.intervalUs = 0;
+    control.mode = FreezeMode::Set;
+    control.enabled = false;
 
-            this->m_MemoryFreezerMutex.unlock();
+    this->m_Entries[slot] = { memAddress.address, dataOffset, (uint32_t)data.size(), 
+        { slot, this->m_SlotGenerations[slot] }, dataType, true };
+    this->m_EntryInfo[slot] = std::make_shared<const FrozenEntryInfo>(
+        FrozenEntryInfo{ typeStr, dataStr, note, memAddress.memRegion.pathName });
+    this->m_FrozenAddresses.insert(memAddress.address);
+}
 
-            // We may need to start/restart the thread if there were no addresses before
-            // and a new address was added now
-            this->StartThreadLoopIfNeeded();
-        }
+void MemoryFreezer::AddAddress(MemAddress memAddress, const std::string& typeStr, const std::string& dataStr, 
+        std::vector<uint8_t>& data, const std::string& note)
+{
+    // Prevent adding read-only addresses
+    if (!memAddress.memRegion.perms.writeFlag)
+    {
+        throw std::runtime_error("Cannot add read-only address.");
+    }
+    const DataType dataType = ParseDataType(typeStr);
+
+    std::lock_guard<std::mutex> lock(this->m_MemoryFreezerMutex);
+
+    if (this->m_FrozenAddresses.contains(memAddress.address))
+    {
+        throw std::runtime_error("The address is already in the list.");
     }
+
+    // Add the address but have it disabled
+    this->InsertEntry(memAddress, dataType, typeStr, dataStr, data, note);
+    this->NotifyListChanged(ListChange::All);
 }
 
-void MemoryFreezer::DisableAddress(size_t index)
+size_t MemoryFreezer::AddAddresses(const std::vector<MemAddress>& memAddrs, const std::string& typeStr, 
+        const std::string& dataStr, const std::vector<uint8_t>& data, const std::string& note)
 {
-    if (index >= this->m_FrozenAddresses.size())
+    const DataType dataType = ParseDataType(typeStr);
+
+    std::lock_guard<std::mutex> lock(this->m_MemoryFreezerMutex);
+
+    size_t added = 0;
+    for (const MemAddress& memAddress : memAddrs)
     {
-        throw std::runtime_error("Index out of bounds.");
+        // Read-only addresses and addresses which are already in the list are skipped
+        if (!memAddress.memRegion.perms.writeFlag || this->m_FrozenAddresses.contains(memAddress.address))
+        {
+            continue;
+        }
+
+        try
+        {
+            this->InsertEntry(memAddress, dataType, typeStr, dataStr, data, note);
+        }
+        catch (const std::runtime_error&)
+        {
+            // Keep the addresses that were added before the payload arena ran out of space
+            if (added > 0)
+            {
+                this->NotifyListChanged(ListChange::All);
+            }
+            throw;
+        }
+        added++;
     }
-    else
+
+    // All the new addresses are published to the freezer threads at once
+    if (added > 0)
     {
-        auto iter = this->m_FrozenAddresses.begin();
-        std::advance(iter, index);
+        this->NotifyListChanged(ListChange::All);
+    }
+    return added;
+}
 
-        if (iter->enabled)
-        {
-            this->m_MemoryFreezerMutex.lock();
+void MemoryFreezer::RemoveAddress(size_t index)
+{
+    std::lock_guard<std::mutex> lock(this->m_MemoryFreezerMutex);
+    this->CheckIndex(index);
 
-            this->m_EnabledAddressesAmount -= 1;
-            iter->enabled = false;
+    FrozenEntry& entry = this->m_Entries[index];
+    EntryControl& control = this->GetControl(index);
 
-            this->m_MemoryFreezerMutex.unlock();
-        }
+    // Make sure to decrement the enabled addresses, if the removed address was enabled
+    if (control.enabled)
+    {
+        this->m_EnabledAddressesAmount -= 1;
+        control.enabled = false;
+    }
+    this->m_PayloadGarbage += entry.dataSize;
+
+    this->m_FrozenAddresses.erase(entry.address);
+
+    // Invalidate the handle of the entry and free its row
+    this->m_SlotGenerations[entry.handle.slot]++;
+    this->m_FreeSlots.push_back(entry.handle.slot);
+    entry.used = false;
+
+    // The info of the row isn't published, the readers skip it since the row isn't used
+    this->m_EntryInfo[index].reset();
+
+    uint8_t changes = ListChange::Entries;
+    if (this->m_PayloadGarbage > this->m_PayloadArena.size() / 2)
+    {
+        this->CompactArena();
+        changes |= ListChange::Data;
     }
+    this->NotifyListChanged(changes);
 }
 
-void MemoryFreezer::EnableAllAddresses()
+void MemoryFreezer::RemoveAllAddresses()
 {
-    for (auto it = this->m_FrozenAddresses.begin(); it != this->m_FrozenAddresses.end(); it++)
+    std::lock_guard<std::mutex> lock(this->m_MemoryFreezerMutex);
+    this->ClearEntries();
+}
+
+void MemoryFreezer::EnableAddress(size_t index)
+{
+    bool wasEnabled;
     {
-        this->m_MemoryFreezerMutex.lock();
+        std::lock_guard<std::mutex> lock(this->m_MemoryFreezerMutex);
+        this->CheckIndex(index);
 
-        // Only count (and enable) addresses which are currently disabled
-        if (!it->enabled)
+        EntryControl& control = this->GetControl(index);
+        wasEnabled = control.enabled;
+        if (!wasEnabled)
         {
-            it->enabled = true;
+            control.ClearFailed();
+            control.enabled = true;
             this->m_EnabledAddressesAmount += 1;
+            this->NotifyControlsChanged();
         }
+    }
 
-        this->m_MemoryFreezerMutex.unlock();
+    // We may need to start/restart the thread if there were no addresses before
+    // and a new address was added now
+    if (!wasEnabled)
+    {
+        this->StartWorkersIfNeeded();
     }
-    this->StartThreadLoopIfNeeded();
 }
 
-void MemoryFreezer::DisableAllAddresses()
+void MemoryFreezer::DisableAddress(size_t index)
+{
+    std::lock_guard<std::mutex> lock(this->m_MemoryFreezerMutex);
+    this->CheckIndex(index);
+
+    EntryControl& control = this->GetControl(index);
+    if (control.enabled)
+    {
+        this->m_EnabledAddressesAmount -= 1;
+        control.enabled = false;
+        this->NotifyControlsChanged();
+    }
+}
+
+void MemoryFreezer::EnableAllAddresses()
 {
     this->m_MemoryFreezerMutex.lock();
 
-    for (auto it = this->m_FrozenAddresses.begin(); it != this->m_FrozenAddresses.end(); it++)
+    for (size_t i = 0; i < this->m_Entries.size(); i++)
     {
-        it->enabled = false;
+        EntryControl& control = this->GetControl(i);
+        if (this->m_Entries[i].used && !control.enabled)
+        {
+            control.ClearFailed();
+            control.enabled = true;
+        }
     }
-    this->m_EnabledAddressesAmount = 0;
+    this->m_EnabledAddressesAmount = this->m_FrozenAddresses.size();
+    this->NotifyControlsChanged();
 
     this->m_MemoryFreezerMutex.unlock();
+
+    this->StartWorkersIfNeeded();
+}
+
+void MemoryFreezer::DisableAllAddresses()
+{
+    std::lock_guard<std::mutex> lock(this->m_MemoryFreezerMutex);
+
+    for (size_t i = 0; i < this->m_Entries.size(); i++)
+    {
+        this->GetControl(i).enabled = false;
+    }
+    this->m_EnabledAddressesAmount = 0;
+    this->NotifyControlsChanged();
 }
 
 void MemoryFreezer::ModifyAddress(size_t index, const std::string& typeStr, const std::string& dataStr,
         std::vector<uint8_t>& data, const std::string& note)
 {
-    if (index >= this->m_FrozenAddresses.size())
+    std::lock_guard<std::mutex> lock(this->m_MemoryFreezerMutex);
+    this->CheckIndex(index);
+
+    FrozenEntry& entry = this->m_Entries[index];
+
+    const DataType dataType = ParseDataType(typeStr);
+    this->CheckMode(dataType, this->GetControl(index).mode);
+
+    // The entry itself is only published when its type or the place of its data changes
+    uint8_t changes = ListChange::Info | ListChange::Data;
+    if (dataType != entry.dataType)
     {
-        throw std::runtime_error("Index out of bounds.");
+        entry.dataType = dataType;
+        changes |= ListChange::Entries;
+    }
+
+    // Data of the same size is overwritten in place
+    if (data.size() == entry.dataSize)
+    {
+        std::copy(data.begin(), data.end(), this->m_PayloadArena.begin() + entry.dataOffset);
     }
     else
     {
-        auto iter = this->m_FrozenAddresses.begin();
-        std::advance(iter, index);
-        
-        this->m_MemoryFreezerMutex.lock();
+        this->m_PayloadGarbage += entry.dataSize;
+        entry.dataOffset = this->StoreData(data);
+        entry.dataSize = data.size();
+        changes |= ListChange::Entries;
+    }
 
-        iter->typeStr = typeStr;
-        iter->dataStr = dataStr;
-        iter->data = data;
-        if (!note.empty()) // Only replace the note if it is not empty
-        {
-            iter->note = note;
-        }
+    // The published info is shared with the older versions, so it is replaced instead of changed
+    FrozenEntryInfo info = *this->m_EntryInfo[index];
+    info.typeStr = typeStr;
+    info.dataStr = dataStr;
+    if (!note.empty()) // Only replace the note if it is not empty
+    {
+        info.note = note;
+    }
+    this->m_EntryInfo[index] = std::make_shared<const FrozenEntryInfo>(std::move(info));
 
-        this->m_MemoryFreezerMutex.unlock();
+    if (this->m_PayloadGarbage > this->m_PayloadArena.size() / 2)
+    {
+        this->CompactArena();
+        changes |= ListChange::Entries;
     }
+    this->NotifyListChanged(changes);
 }
 
 void MemoryFreezer::ModifyAllAddresses(const std::string& typeStr, const std::string& dataStr,
         std::vector<uint8_t>& data, const std::string& note)
 {
-    for (size_t i = 0; i < this->m_FrozenAddresses.size(); i++)
+    std::lock_guard<std::mutex> lock(this->m_MemoryFreezerMutex);
+
+    const DataType dataType = ParseDataType(typeStr);
+    for (size_t i = 0; i < this->m_Entries.size(); i++)
     {
-        this->ModifyAddress(i, typeStr, dataStr, data, note);
+        if (this->m_Entries[i].used)
+        {
+            this->CheckMode(dataType, this->GetControl(i).mode);
+        }
     }
+
+    // All the entries get the same data, so the arena is rebuilt with a copy for every entry
+    this->m_PayloadArena.clear();
+    this->m_PayloadGarbage = 0;
+    for (size_t i = 0; i < this->m_Entries.size(); i++)
+    {
+        FrozenEntry& entry = this->m_Entries[i];
+        if (!entry.used)
+        {
+            continue;
+        }
+
+        entry.dataOffset = this->StoreData(data);
+        entry.dataSize = data.size();
+        entry.dataType = dataType;
+
+        FrozenEntryInfo info = *this->m_EntryInfo[i];
+        info.typeStr = typeStr;
+        info.dataStr = dataStr;
+        if (!note.empty())
+        {
+            info.note = note;
+        }
+        this->m_EntryInfo[i] = std::make_shared<const FrozenEntryInfo>(std::move(info));
+    }
+    this->NotifyListChanged(ListChange::All);
+}
+
+void MemoryFreezer::SetAddressMode(size_t index, FreezeMode mode)
+{
+    std::lock_guard<std::mutex> lock(this->m_MemoryFreezerMutex);
+    this->CheckIndex(index);
+
+    this->CheckMode(this->m_Entries[index].dataType, mode);
+    this->GetControl(index).mode = mode;
+    this->NotifyControlsChanged();
+}
+
+void MemoryFreezer::SetAllAddressesMode(FreezeMode mode)
+{
+    std::lock_guard<std::mutex> lock(this->m_MemoryFreezerMutex);
+
+    for (const FrozenEntry& entry : this->m_Entries)
+    {
+        if (entry.used)
+        {
+            this->CheckMode(entry.dataType, mode);
+        }
+    }
+    for (size_t i = 0; i < this->m_Entries.size(); i++)
+    {
+        this->GetControl(i).mode = mode;
+    }
+    this->NotifyControlsChanged();
 }
 
-const std::list<FrozenMemAddress>& MemoryFreezer::GetFrozenAddresses() const
+void MemoryFreezer::SetAddressInterval(size_t index, uint32_t intervalUs)
 {
-    return this->m_FrozenAddresses;
+    std::lock_guard<std::mutex> lock(this->m_MemoryFreezerMutex);
+    this->CheckIndex(index);
+
+    this->GetControl(index).intervalUs = intervalUs;
+    this->NotifyControlsChanged();
+}
+
+void MemoryFreezer::SetAllAddressesInterval(uint32_t intervalUs)
+{
+    std::lock_guard<std::mutex> lock(this->m_MemoryFreezerMutex);
+
+    for (size_t i = 0; i < this->m_Entries.size(); i++)
+    {
+        this->GetControl(i).intervalUs = intervalUs;
+    }
+    this->NotifyControlsChanged();
+}
+
+std::shared_ptr<const FreezeListSnapshot> MemoryFreezer::GetSnapshot() const
+{
+    return this->m_Snapshot.load();
+}
+
+size_t MemoryFreezer::GetFrozenAddressesAmount() const
+{
+    return this->m_FrozenAddresses.size();
 }
 
 int MemoryFreezer::GetEnabledAddressesAmount() const
@@ -207,95 +674,524 @@ int MemoryFreezer::GetEnabledAddressesAmount() const
     return this->m_EnabledAddressesAmount;
 }
 
+FreezeHandle MemoryFreezer::GetHandle(size_t index) const
+{
+    this->CheckIndex(index);
+
+    return this->m_Entries[index].handle;
+}
+
+bool MemoryFreezer::IsHandleValid(FreezeHandle handle) const
+{
+    return handle.slot < this->m_SlotGenerations.size() 
+        && this->m_SlotGenerations[handle.slot] == handle.generation;
+}
+
 void MemoryFreezer::SetPid(pid_t pid)
 {
+    std::lock_guard<std::mutex> lock(this->m_MemoryFreezerMutex);
+
     this->m_pid = pid;
+    this->ClearEntries();
+}
 
-    this->m_MemoryFreezerMutex.lock();
+void MemoryFreezer::SetTickRate(unsigned int ticksPerSecond)
+{
+    if (ticksPerSecond == 0 || ticksPerSecond > MAX_TICK_RATE)
+    {
+        const std::string err = fmt::format("The tick rate must be between 1 and {}.", MAX_TICK_RATE);
+        throw std::runtime_error(err);
+    }
 
-    this->m_FrozenAddresses.clear();
-    this->m_EnabledAddressesAmount = 0;
+    // The entries which use the default interval have to be rescheduled
+    std::lock_guard<std::mutex> lock(this->m_MemoryFreezerMutex);
+    this->m_TickRate = ticksPerSecond;
+    this->NotifyListChanged(ListChange::None);
+}
 
-    this->m_MemoryFreezerMutex.unlock();
+unsigned int MemoryFreezer::GetTickRate() const
+{
+    return this->m_TickRate;
+}
+
+void MemoryFreezer::SetShardCount(unsigned int shardCount)
+{
+    if (shardCount == 0 || shardCount > MAX_SHARD_COUNT)
+    {
+        const std::string err = fmt::format("The amount of threads must be between 1 and {}.", MAX_SHARD_COUNT);
+        throw std::runtime_error(err);
+    }
+
+    // The threads are restarted with the new amount of shards
+    this->StopWorkers();
+    this->m_ShardCount = shardCount;
+    this->StartWorkersIfNeeded();
+}
+
+unsigned int MemoryFreezer::GetShardCount() const
+{
+    return this->m_ShardCount;
+}
+
+void MemoryFreezer::StartWorkersIfNeeded()
+{
+    // The threads are started only once there are enabled addresses, and then they stay until
+    // they are stopped
+    if (!this->m_Workers.empty() || this->m_EnabledAddressesAmount <= 0)
+    {
+        return;
+    }
+
+    // Every shard has its own event ring since each ring can only have one producer
+    // The rings are never destroyed so that events aren't lost when the amount of shards decreases
+    while (this->m_EventRings.size() < this->m_ShardCount)
+    {
+        this->m_EventRings.push_back(std::make_unique<SpscRing<FreezeEvent, EVENT_RING_SIZE>>());
+    }
+
+    for (uint32_t i = 0; i < this->m_ShardCount; i++)
+    {
+        this->m_Workers.emplace_back(&MemoryFreezer::ShardLoop, this, i);
+    }
 }
 
-void MemoryFreezer::StartThreadLoopIfNeeded()
+void MemoryFreezer::StopWorkers()
 {
-    // Start a thread only if there is no thread running already and if there are enabled addresses
-    if (!this->m_ThreadRunning && this->m_EnabledAddressesAmount > 0)
     {
-        this->m_ThreadRunning = true;
+        std::lock_guard<std::mutex> wakeLock(this->m_WakeMutex);
+        this->m_StopWorkers = true;
+        this->m_WakeCondition.notify_all();
+    }
 
-        std::thread th(&MemoryFreezer::ThreadLoop, this);
-        th.detach();
+    for (std::thread& worker : this->m_Workers)
+    {
+        worker.join();
     }
+    this->m_Workers.clear();
+    this->m_StopWorkers = false;
 }
 
-void MemoryFreezer::ThreadLoop()
+// Copies the addresses of the shard into its write plan
+// The addresses are sorted and split into equal parts, so every shard gets a contiguous range of
+// addresses which coalesces well, and the shards are rebalanced whenever the list changes
+// The plan is built from the latest published snapshot, so the list isn't locked
+void MemoryFreezer::BuildWritePlan(WritePlan& plan, uint32_t shardIndex)
 {
-    this->m_FrozenAddressIter = this->m_FrozenAddresses.begin();
-    while (true)
+    const std::shared_ptr<const FreezeListSnapshot> snapshot = this->m_Snapshot.load();
+    const std::vector<FrozenEntry>& entries = *snapshot->entries;
+    const std::vector<uint8_t>& payloadArena = *snapshot->payloadArena;
+
+    // The old plan is kept for carrying over the deadlines of the entries, and the values tracked by
+    // the modes Increase and Decrease
+    WritePlan oldPlan = std::move(plan);
+    std::unordered_map<uint32_t, uint32_t> oldEntries;
+    oldEntries.reserve(oldPlan.entries.size());
+    for (uint32_t i = 0; i < oldPlan.entries.size(); i++)
+    {
+        oldEntries[oldPlan.entries[i].handle.slot] = i;
+    }
+
+    plan = WritePlan();
+    plan.version = snapshot->version;
+    // Read before the controls, so that a change made while the plan is built is seen by the next sync
+    plan.controlVersion = this->m_ControlVersion;
+    plan.shardIndex = shardIndex;
+    plan.pid = snapshot->pid;
+    plan.controls = snapshot->controls;
+
+    const std::chrono::nanoseconds defaultInterval = std::chrono::seconds(1);
+    plan.tickInterval = defaultInterval / this->m_TickRate.load();
+
+    const std::vector<uint32_t>& addressOrder = snapshot->GetAddressOrder();
+    const size_t shardStart = addressOrder.size() * shardIndex / this->m_ShardCount;
+    const size_t shardEnd = addressOrder.size() * (shardIndex + 1) / this->m_ShardCount;
+
+    // The entries are copied in order of their address, along with their data
+    // Their settings are read from the controls below
+    plan.entries.reserve(shardEnd - shardStart);
+    for (size_t i = shardStart; i < shardEnd; i++)
     {
-        this->m_MemoryFreezerMutex.lock();
+        const FrozenEntry& entry = entries[addressOrder[i]];
 
-        // Stopping condition
-        if (this->m_EnabledAddressesAmount <= 0)
+        PlanEntry planEntry;
+        planEntry.address = entry.address;
+        planEntry.dataOffset = plan.payload.size();
+        planEntry.dataSize = entry.dataSize;
+        planEntry.readRequest = 0;
+        planEntry.handle = entry.handle;
+        planEntry.dataType = entry.dataType;
+        planEntry.mode = FreezeMode::Set;
+        planEntry.active = false;
+        planEntry.intervalUs = 0;
+        planEntry.interval = plan.tickInterval;
+        planEntry.scheduled = false;
+        plan.entries.push_back(planEntry);
+
+        const uint8_t* data = &payloadArena[entry.dataOffset];
+        plan.payload.insert(plan.payload.end(), data, data + entry.dataSize);
+    }
+
+    plan.values = plan.payload;
+    plan.readBuffer.resize(plan.payload.size());
+
+    // Keeps the earliest deadline at the front of the heap
+    auto isLater = [](const ScheduledEntry& lhs, const ScheduledEntry& rhs)
+    {
+        return lhs.deadline > rhs.deadline;
+    };
+
+    // The entries which were already scheduled keep their deadlines, so that a change to the list
+    // doesn't make the shard write all of its entries at once, and the other active entries are due
+    // right away. The entries with the default interval start over when the tick rate changes.
+    const auto now = std::chrono::steady_clock::now();
+    plan.schedule.reserve(plan.entries.size());
+    for (uint32_t i = 0; i < plan.entries.size(); i++)
+    {
+        PlanEntry& entry = plan.entries[i];
+        const PlanEntry* oldEntry = nullptr;
+        auto oldIt = oldEntries.find(entry.handle.slot);
+        if (oldIt != oldEntries.end() 
+            && oldPlan.entries[oldIt->second].handle.generation == entry.handle.generation)
         {
-            this->m_MemoryFreezerMutex.unlock();
-            break;
+            oldEntry = &oldPlan.entries[oldIt->second];
         }
 
-        auto& it = this->m_FrozenAddressIter;
-        // Restart the iterator if it reached the end
-        if (it == this->m_FrozenAddresses.end())
+        if (oldEntry != nullptr && oldEntry->scheduled 
+            && (oldEntry->intervalUs != 0 || oldPlan.tickInterval == plan.tickInterval))
         {
-            it = this->m_FrozenAddresses.begin();
+            entry.active = oldEntry->active;
+            entry.intervalUs = oldEntry->intervalUs;
+            entry.nextDeadline = oldEntry->nextDeadline;
+            entry.scheduled = true;
+            plan.schedule.push_back({ entry.nextDeadline, i });
+            std::push_heap(plan.schedule.begin(), plan.schedule.end(), isLater);
         }
+        this->ReadControl(plan, i, now);
 
-        // Only freeze enabled addresses
-        if (it->enabled)
+        // Keep the tracked value if the entry and its data didn't change
+        const bool tracked = entry.mode == FreezeMode::Increase || entry.mode == FreezeMode::Decrease;
+        if (oldEntry != nullptr && tracked && oldEntry->mode == entry.mode && oldEntry->dataSize == entry.dataSize
+            && std::memcmp(&oldPlan.payload[oldEntry->dataOffset], &plan.payload[entry.dataOffset], 
+                entry.dataSize) == 0)
+        {
+            std::memcpy(&plan.values[entry.dataOffset], &oldPlan.values[oldEntry->dataOffset], 
+                    entry.dataSize);
+        }
+    }
+    plan.rescheduled.reserve(plan.entries.size());
+    plan.dueEntries.reserve(plan.entries.size());
+}
+
+// Reads the controls of all the entries of the plan again, which is cheaper than rebuilding the plan
+// since nothing is copied or sorted
+void MemoryFreezer::SyncControls(WritePlan& plan)
+{
+    plan.controlVersion = this->m_ControlVersion;
+
+    const auto now = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < plan.entries.size(); i++)
+    {
+        this->ReadControl(plan, i, now);
+    }
+}
+
+// Updates the settings of the entry from its control
+// An entry which got a new interval is scheduled right away, and its old deadline is skipped when it
+// comes up. An entry which became active is also scheduled right away, unless its deadline is still
+// in the schedule because it was disabled and enabled again before the deadline came up.
+void MemoryFreezer::ReadControl(WritePlan& plan, uint32_t entryIndex, std::chrono::steady_clock::time_point now)
+{
+    PlanEntry& entry = plan.entries[entryIndex];
+    const EntryControl& control = (*plan.controls)[entry.handle.slot];
+
+    // The slot may already belong to a newer entry, until the plan is rebuilt
+    const bool active = control.IsUsable(entry.handle.generation) && control.enabled;
+    const FreezeMode mode = control.mode;
+    const uint32_t intervalUs = control.intervalUs;
+
+    // The tracked value starts over from the data when the mode changes
+    if (mode != entry.mode)
+    {
+        std::memcpy(&plan.values[entry.dataOffset], &plan.payload[entry.dataOffset], entry.dataSize);
+        entry.mode = mode;
+    }
+
+    const bool shouldSchedule = active && ((!entry.active && !entry.scheduled) || intervalUs != entry.intervalUs);
+    entry.active = active;
+    entry.intervalUs = intervalUs;
+    entry.interval = intervalUs == 0 ? plan.tickInterval : std::chrono::microseconds(intervalUs);
+    if (shouldSchedule)
+    {
+        // Keeps the earliest deadline at the front of the heap
+        auto isLater = [](const ScheduledEntry& lhs, const ScheduledEntry& rhs)
         {
-            const std::vector<uint8_t>& data = it->data; 
-            const long dataSize = data.size();
-            try
+            return lhs.deadline > rhs.deadline;
+        };
+
+        entry.nextDeadline = now;
+        entry.scheduled = true;
+        plan.schedule.push_back({ now, entryIndex });
+        std::push_heap(plan.schedule.begin(), plan.schedule.end(), isLater);
+    }
+}
+
+// Sends an event about the failed entry and stops processing it
+// The address is disabled by the thread of the user when it takes the event, so that this thread
+// never has to wait for the lock or allocate memory
+void MemoryFreezer::ReportFailure(WritePlan& plan, uint32_t entryIndex, const MemIoRequest& req, 
+        bool readFailed)
+{
+    PlanEntry& entry = plan.entries[entryIndex];
+    entry.active = false;
+
+    // The flag keeps the entry from being written again when the plan is rebuilt before the
+    // address is disabled
+    (*plan.controls)[entry.handle.slot].SetFailed(entry.handle.generation);
+
+    FreezeEvent event;
+    event.handle = entry.handle;
+    event.address = req.address;
+    event.readFailed = readFailed;
+    event.err = req.result < 0 ? -req.result : 0;
+    event.bytesTransferred = req.result < 0 ? 0 : req.result;
+    event.bytesExpected = req.length;
+    event.timestamp = std::chrono::system_clock::now();
+    this->m_EventRings[plan.shardIndex]->Push(event);
+}
+
+// Takes the entries which are due before the given time out of the schedule and schedules their next run
+void MemoryFreezer::TakeDueEntries(WritePlan& plan, std::chrono::steady_clock::time_point now)
+{
+    plan.dueEntries.clear();
+    plan.rescheduled.clear();
+
+    // Keeps the earliest deadline at the front of the heap
+    auto isLater = [](const ScheduledEntry& lhs, const ScheduledEntry& rhs)
+    {
+        return lhs.deadline > rhs.deadline;
+    };
+
+    const auto dueTime = now + GROUPING_WINDOW;
+    while (!plan.schedule.empty() && plan.schedule.front().deadline <= dueTime)
+    {
+        std::pop_heap(plan.schedule.begin(), plan.schedule.end(), isLater);
+        ScheduledEntry scheduled = plan.schedule.back();
+        plan.schedule.pop_back();
+
+        // The deadlines which were replaced are dropped, and so are inactive entries until they
+        // become active again
+        PlanEntry& entry = plan.entries[scheduled.entryIndex];
+        if (scheduled.deadline != entry.nextDeadline)
+        {
+            continue;
+        }
+        if (!entry.active)
+        {
+            entry.scheduled = false;
+            continue;
+        }
+        plan.dueEntries.push_back(scheduled.entryIndex);
+
+        // Schedule the next run, without trying to catch up on runs that were missed
+        scheduled.deadline += entry.interval;
+        if (scheduled.deadline <= now)
+        {
+            scheduled.deadline = now + entry.interval;
+        }
+        entry.nextDeadline = scheduled.deadline;
+        plan.rescheduled.push_back(scheduled);
+    }
+
+    for (const ScheduledEntry& scheduled : plan.rescheduled)
+    {
+        plan.schedule.push_back(scheduled);
+        std::push_heap(plan.schedule.begin(), plan.schedule.end(), isLater);
+    }
+
+    // The entries are sorted by address, so sorting their indices lets the transfers coalesce
+    std::sort(plan.dueEntries.begin(), plan.dueEntries.end());
+}
+
+// Processes the entries which are due in the current tick
+void MemoryFreezer::ProcessTick(WritePlan& plan)
+{
+    // The current values of the entries which need them are read in one batch
+    plan.readRequests.clear();
+    for (uint32_t i : plan.dueEntries)
+    {
+        PlanEntry& entry = plan.entries[i];
+        if (entry.mode != FreezeMode::Set)
+        {
+            entry.readRequest = plan.readRequests.size();
+            plan.readRequests.push_back({ entry.address, entry.dataSize, &plan.readBuffer[entry.dataOffset], 0 });
+        }
+    }
+    if (!plan.readRequests.empty())
+    {
+        MemoryFuncs::ReadProcessMemoryBatch(plan.pid, plan.readRequests);
+    }
+
+    // Then all the values that need to be written are written in one batch
+    plan.writeRequests.clear();
+    plan.writeEntries.clear();
+    for (uint32_t i : plan.dueEntries)
+    {
+        PlanEntry& entry = plan.entries[i];
+        uint8_t* value = &plan.values[entry.dataOffset];
+        if (entry.mode != FreezeMode::Set)
+        {
+            const MemIoRequest& readReq = plan.readRequests[entry.readRequest];
+            if (readReq.result != (ssize_t)readReq.length)
             {
-                ssize_t nread = MemoryFuncs::WriteToProcessMemory(this->m_pid, it->memAddress.address, dataSize, (void*)&data[0]);
-                // Check for partial write
-                if (nread != dataSize)
-                {
-                    const std::string msg = fmt::format(
-                            "WARNING: Disabling address {:#018x} due to a partial write of {}/{}.",
-                            it->memAddress.address, nread, data.size());
-                    this->m_MessageQueue.push(msg);
-                    it->enabled = false;
-                    this->m_EnabledAddressesAmount -= 1;
-                }
+                this->ReportFailure(plan, i, readReq, true);
+                continue;
             }
-            catch (const std::exception& e)
+
+            if (!ShouldWriteValue(entry.mode, entry.dataType, (const uint8_t*)readReq.buffer, value, 
+                    entry.dataSize))
             {
-                const std::string msg = fmt::format("Error writing to memory location {:#018x}: {}", 
-                        it->memAddress.address, e.what());
-                this->m_MessageQueue.push(msg);
-                it->enabled = false; // Disable the address which caused an exception
-                this->m_EnabledAddressesAmount -= 1;
+                continue;
+            }
+        }
+        plan.writeRequests.push_back({ entry.address, entry.dataSize, value, 0 });
+        plan.writeEntries.push_back(i);
+    }
+
+    if (plan.writeRequests.empty())
+    {
+        return;
+    }
+
+    size_t written = MemoryFuncs::WriteToProcessMemoryBatch(plan.pid, plan.writeRequests);
+    if (written != plan.writeRequests.size())
+    {
+        for (size_t i = 0; i < plan.writeRequests.size(); i++)
+        {
+            const MemIoRequest& req = plan.writeRequests[i];
+            if (req.result != (ssize_t)req.length)
+            {
+                this->ReportFailure(plan, plan.writeEntries[i], req, false);
             }
         }
-        this->m_MemoryFreezerMutex.unlock();
-        // Move forward
-        std::advance(it, 1);
     }
-    this->m_ThreadRunning = false;
 }
 
-size_t MemoryFreezer::GetMessageQueueSize() const
+void MemoryFreezer::ShardLoop(uint32_t shardIndex)
 {
-    return this->m_MessageQueue.size();
+    WritePlan plan;
+    this->BuildWritePlan(plan, shardIndex);
+
+    while (!this->m_StopWorkers)
+    {
+        // Rebuild the plan only if the freeze list was changed since the last tick, and only read
+        // the controls again if just they were changed
+        if (plan.version != this->m_Version)
+        {
+            this->BuildWritePlan(plan, shardIndex);
+        }
+        else if (plan.controlVersion != this->m_ControlVersion)
+        {
+            this->SyncControls(plan);
+        }
+
+        this->TakeDueEntries(plan, std::chrono::steady_clock::now());
+        if (!plan.dueEntries.empty())
+        {
+            this->ProcessTick(plan);
+        }
+
+        // Sleep until the next deadline, or until the list is changed or the thread is stopped
+        std::unique_lock<std::mutex> wakeLock(this->m_WakeMutex);
+        auto shouldWake = [&]()
+        {
+            return plan.version != this->m_Version || plan.controlVersion != this->m_ControlVersion
+                || this->m_StopWorkers;
+        };
+        if (plan.schedule.empty())
+        {
+            this->m_WakeCondition.wait(wakeLock, shouldWake);
+        }
+        else
+        {
+            this->m_WakeCondition.wait_until(wakeLock, plan.schedule.front().deadline, shouldWake);
+        }
+    }
 }
 
-std::string MemoryFreezer::MessageQueuePop()
+std::vector<FreezeEvent> MemoryFreezer::PollEvents()
 {
-    std::string msg = this->m_MessageQueue.front();
-    this->m_MessageQueue.pop();
-    return msg;
+    std::vector<FreezeEvent> events;
+
+    std::lock_guard<std::mutex> lock(this->m_MemoryFreezerMutex);
+
+    // Counted before the rings are drained, so every failure of a dropped event counted here is
+    // already flagged in the controls
+    uint64_t droppedEvents = 0;
+    for (const auto& eventRing : this->m_EventRings)
+    {
+        droppedEvents += eventRing->GetOverflowAmount();
+    }
+
+    FreezeEvent event;
+    for (auto& eventRing : this->m_EventRings)
+    {
+        while (eventRing->Pop(event))
+        {
+            // Skip entries which were removed or disabled since the event was sent
+            // The same failure may also be sent more than once if the plan was rebuilt in the meantime
+            if (!this->IsHandleValid(event.handle))
+            {
+                continue;
+            }
+
+            EntryControl& control = (*this->m_Controls)[event.handle.slot];
+            if (!control.enabled)
+            {
+                continue;
+            }
+
+            // Disable the address which failed
+            // The threads already stopped writing it when it failed, so nothing has to be published
+            control.enabled = false;
+            this->m_EnabledAddressesAmount -= 1;
+
+            events.push_back(event);
+        }
+    }
+
+    // The events of some failures didn't fit in the rings, so the failed flags are checked instead
+    if (droppedEvents != this->m_SweptDroppedEvents)
+    {
+        this->m_SweptDroppedEvents = droppedEvents;
+        for (const FrozenEntry& entry : this->m_Entries)
+        {
+            EntryControl& control = (*this->m_Controls)[entry.handle.slot];
+            if (entry.used && control.enabled && control.HasFailed())
+            {
+                control.enabled = false;
+                this->m_EnabledAddressesAmount -= 1;
+            }
+        }
+    }
+
+    // Every shard has its own ring, so the events are put back in the order they happened
+    std::stable_sort(events.begin(), events.end(),
+        [](const FreezeEvent& lhs, const FreezeEvent& rhs)
+        {
+            return lhs.timestamp < rhs.timestamp;
+        });
+    return events;
 }
 
+uint64_t MemoryFreezer::PollDroppedEventsAmount()
+{
+    uint64_t dropped = 0;
+    for (const auto& eventRing : this->m_EventRings)
+    {
+        dropped += eventRing->GetOverflowAmount();
+    }
+    const uint64_t newlyDropped = dropped - this->m_ReportedDroppedEvents;
+
+    this->m_ReportedDroppedEvents = dropped;
+    return newlyDropped;
+}
@@ -1,11 +1,15 @@
 #include "MemoryFuncs.h"
 #include <sys/uio.h>
+#include <algorithm>
+#include <climits>
+#include <cerrno>
 #include <fmt/core.h>
 #include <vector>
+#include "OfflineTarget.h"
 
 // Returns an error message when process_vm_readv/process_vm_writev fail
 // Parameter expects errno
-static std::string GetErrorMessage(int err)
+std::string MemoryFuncs::GetErrorMessage(int err)
 {
     std::string errMsg;
     switch (err)
@@ -44,9 +48,36 @@ std::vector<uint8_t> MemoryFuncs::ReadProcessMemory(pid_t pid, unsigned long bas
 {
     // Creates a vector of the size given in `length`
     std::vector<uint8_t> buffer(length);
+    MemoryFuncs::ReadProcessMemory(pid, baseAddr, length, buffer.data());
+    return buffer;
+}
+
+// Offline targets are read and written directly instead of through the syscalls
+static std::shared_ptr<OfflineTarget> GetOfflineTarget(pid_t pid)
+{
+    std::shared_ptr<OfflineTarget> target = OfflineTarget::Find(pid);
+    if (target == nullptr)
+    {
+        throw std::runtime_error(MemoryFuncs::GetErrorMessage(ESRCH));
+    }
+    return target;
+}
+
+// Reads into the given buffer instead of allocating one, and returns the amount of bytes that were read
+ssize_t MemoryFuncs::ReadProcessMemory(pid_t pid, unsigned long baseAddr, long length, void* buffer)
+{
+    if (OfflineTarget::IsOfflineId(pid))
+    {
+        const ssize_t nread = GetOfflineTarget(pid)->Read(baseAddr, length, buffer);
+        if (nread < 0)
+        {
+            throw std::runtime_error(GetErrorMessage(-nread));
+        }
+        return nread;
+    }
 
     iovec local[1];
-    local[0].iov_base = &buffer[0]; // Pass a pointer to the beginning of the buffer
+    local[0].iov_base = buffer;
     local[0].iov_len = length;
 
     iovec remote[1];
@@ -58,12 +89,21 @@ std::vector<uint8_t> MemoryFuncs::ReadProcessMemory(pid_t pid, unsigned long bas
     {
         throw std::runtime_error(GetErrorMessage(errno));
     }
-
-    return buffer;
+    return nread;
 }
 
 ssize_t MemoryFuncs::WriteToProcessMemory(pid_t pid, unsigned long baseAddr, long dataSize, void* data)
 {
+    if (OfflineTarget::IsOfflineId(pid))
+    {
+        const ssize_t nwritten = GetOfflineTarget(pid)->Write(baseAddr, dataSize, data);
+        if (nwritten < 0)
+        {
+            throw std::runtime_error(GetErrorMessage(-nwritten));
+        }
+        return nwritten;
+    }
+
     iovec local[1];
     local[0].iov_base = data;
     local[0].iov_len = dataSize;
@@ -80,6 +120,141 @@ ssize_t MemoryFuncs::WriteToProcessMemory(pid_t pid, unsigned long baseAddr, lon
     return nread;
 }
 
+static ssize_t TransferMemory(pid_t pid, const iovec* local, size_t localCount, 
+        const iovec* remote, size_t remoteCount, bool write)
+{
+    if (write)
+    {
+        return process_vm_writev(pid, local, localCount, remote, remoteCount, 0);
+    }
+    return process_vm_readv(pid, local, localCount, remote, remoteCount, 0);
+}
+
+static size_t TransferOfflineBatch(pid_t pid, std::vector<MemIoRequest>& requests, bool write)
+{
+    const std::shared_ptr<OfflineTarget> target = OfflineTarget::Find(pid);
+
+    size_t transferred = 0;
+    for (MemIoRequest& req : requests)
+    {
+        if (target == nullptr)
+        {
+            req.result = -ESRCH;
+            continue;
+        }
+
+        req.result = write ? target->Write(req.address, req.length, req.buffer) 
+            : target->Read(req.address, req.length, req.buffer);
+        if (req.result == (ssize_t)req.length)
+        {
+            transferred++;
+        }
+    }
+    return transferred;
+}
+
+// Transfers all the requests in groups of up to IOV_MAX iovecs per syscall
+static size_t TransferMemoryBatch(pid_t pid, std::vector<MemIoRequest>& requests, bool write)
+{
+    if (OfflineTarget::IsOfflineId(pid))
+    {
+        return TransferOfflineBatch(pid, requests, write);
+    }
+
+    std::vector<iovec> local;
+    std::vector<iovec> remote;
+    local.reserve(IOV_MAX);
+    remote.reserve(IOV_MAX);
+
+    size_t transferred = 0;
+    size_t i = 0;
+    while (i < requests.size())
+    {
+        local.clear();
+        remote.clear();
+
+        // Build a group of requests, coalescing requests which are adjacent in the remote process
+        size_t end = i;
+        while (end < requests.size() && local.size() < IOV_MAX)
+        {
+            const MemIoRequest& req = requests[end];
+            if (!remote.empty() && (unsigned long)remote.back().iov_base + remote.back().iov_len == req.address)
+            {
+                remote.back().iov_len += req.length;
+            }
+            else if (remote.size() < IOV_MAX)
+            {
+                remote.push_back({ (void*)req.address, req.length });
+            }
+            else
+            {
+                break;
+            }
+            local.push_back({ req.buffer, req.length });
+            end++;
+        }
+
+        ssize_t nbytes = TransferMemory(pid, local.data(), local.size(), remote.data(), remote.size(), write);
+        // Errors other than EFAULT are not specific to an address, so nothing else will succeed either
+        if (nbytes < 0 && errno != EFAULT)
+        {
+            const int err = errno;
+            for (; i < requests.size(); i++)
+            {
+                requests[i].result = -err;
+            }
+            break;
+        }
+
+        // Mark every request which was fully transferred
+        size_t remaining = nbytes < 0 ? 0 : nbytes;
+        while (i < end && requests[i].length <= remaining)
+        {
+            requests[i].result = requests[i].length;
+            remaining -= requests[i].length;
+            transferred++;
+            i++;
+        }
+
+        // The transfer stopped at this request, so transfer it on its own to find out exactly why
+        // and continue with the requests after it
+        if (i < end)
+        {
+            MemIoRequest& req = requests[i];
+            const iovec reqLocal = { req.buffer, req.length };
+            const iovec reqRemote = { (void*)req.address, req.length };
+
+            ssize_t reqBytes = TransferMemory(pid, &reqLocal, 1, &reqRemote, 1, write);
+            req.result = reqBytes < 0 ? -errno : reqBytes;
+            if (req.result == (ssize_t)req.length)
+            {
+                transferred++;
+            }
+            i++;
+        }
+    }
+    return transferred;
+}
+
+size_t MemoryFuncs::ReadProcessMemoryBatch(pid_t pid, std::vector<MemIoRequest>& requests)
+{
+    return TransferMemoryBatch(pid, requests, false);
+}
+
+size_t MemoryFuncs::WriteToProcessMemoryBatch(pid_t pid, std::vector<MemIoRequest>& requests)
+{
+    return TransferMemoryBatch(pid, requests, true);
+}
+
+const uint8_t* MemoryFuncs::GetMappedMemory(pid_t pid, unsigned long baseAddr, size_t length)
+{
+    if (!OfflineTarget::IsOfflineId(pid))
+    {
+        return nullptr;
+    }
+    return GetOfflineTarget(pid)->GetData(baseAddr, length);
+}
+
 template <>
 bool MemoryFuncs::CompareData<std::string>(const void* lhs, const void* rhs, 
             size_t dataSize, ComparisonType cmpType)
@@ -91,3 +266,276 @@ bool MemoryFuncs::CompareData<std::string>(const void* lhs, const void* rhs,
     return std::memcmp(lhs, rhs, dataSize) == 0;
 }
 
+template <>
+bool MemoryFuncs::CompareData<AobPattern>(const void* lhs, const void* rhs, 
+            size_t dataSize, ComparisonType cmpType)
+{
+    (void)dataSize; // The pattern has its own size
+    if (cmpType != ComparisonType::Equal)
+    {
+        throw std::runtime_error("Comparing byte patterns for equality is the only supported comparison type.");
+    }
+    return ((const AobPattern*)rhs)->Matches((const uint8_t*)lhs);
+}
+
+template <>
+std::vector<MemAddress> MemoryFuncs::FindDataInMemory<AobPattern>(pid_t pid, const std::vector<MemRegion>& memRegions, 
+        size_t dataSize, const void* dataToFind, ComparisonType cmpType)
+{
+    (void)dataSize; // The pattern has its own size
+    if (cmpType != ComparisonType::Equal)
+    {
+        throw std::runtime_error("Comparing byte patterns for equality is the only supported comparison type.");
+    }
+    const AobPattern& pattern = *(const AobPattern*)dataToFind;
+
+    std::vector<MemAddress> addrs;
+    MemoryFuncs::ForEachRegionMemory(pid, memRegions, [&](const MemRegion& region, const uint8_t* data, size_t length)
+    {
+        const uint8_t* end = data + length;
+        for (const uint8_t* match = pattern.FindNext(data, end); match != nullptr; match = pattern.FindNext(match + 1, end))
+        {
+            MemAddress addrStruct = { region.startAddr + (match - data), region };
+            addrs.push_back(addrStruct);
+        }
+    });
+    return addrs;
+}
+
+template <>
+bool MemoryFuncs::CompareData<MultiMatcher>(const void* lhs, const void* rhs, 
+            size_t dataSize, ComparisonType cmpType)
+{
+    if (cmpType != ComparisonType::Equal)
+    {
+        throw std::runtime_error("Comparing multiple values for equality is the only supported comparison type.");
+    }
+    return ((const MultiMatcher*)rhs)->MatchesAny((const uint8_t*)lhs, dataSize);
+}
+
+template <>
+bool MemoryFuncs::CompareData<StructPattern>(const void* lhs, const void* rhs, 
+            size_t dataSize, ComparisonType cmpType)
+{
+    (void)dataSize; // The pattern has its own size
+    if (cmpType != ComparisonType::Equal)
+    {
+        throw std::runtime_error("Structures can only be compared by their fields.");
+    }
+    return ((const StructPattern*)rhs)->Matches((const uint8_t*)lhs);
+}
+
+template <>
+std::vector<MemAddress> MemoryFuncs::FindDataInMemory<StructPattern>(pid_t pid, const std::vector<MemRegion>& memRegions, 
+        size_t dataSize, const void* dataToFind, ComparisonType cmpType)
+{
+    (void)dataSize; // The pattern has its own size
+    if (cmpType != ComparisonType::Equal)
+    {
+        throw std::runtime_error("Structures can only be compared by their fields.");
+    }
+    const StructPattern& pattern = *(const StructPattern*)dataToFind;
+    const StructField& leadingField = pattern.GetLeadingField();
+
+    std::vector<MemAddress> addrs;
+    MemoryFuncs::ForEachRegionMemory(pid, memRegions, [&](const MemRegion& region, const uint8_t* data, size_t length)
+    {
+        if (length < pattern.GetSize())
+        {
+            return;
+        }
+
+        // The leading field is compared at every start of a structure with the range kernel, and the
+        // other fields only at the starts where it matched
+        const size_t startAmount = length - pattern.GetSize() + 1;
+        MemoryFuncs::ForEachTypedValueMatch(data + leadingField.offset, startAmount, leadingField.value, [&](size_t start)
+        {
+            if (pattern.MatchesOtherFields(data + start))
+            {
+                MemAddress addrStruct = { region.startAddr + start, region };
+                addrs.push_back(addrStruct);
+            }
+        });
+    });
+    return addrs;
+}
+
+template <>
+std::vector<MemAddress> MemoryFuncs::FindDataInMemory<MultiMatcher>(pid_t pid, const std::vector<MemRegion>& memRegions, 
+        size_t dataSize, const void* dataToFind, ComparisonType cmpType)
+{
+    (void)dataSize; // The needles have their own sizes
+    if (cmpType != ComparisonType::Equal)
+    {
+        throw std::runtime_error("Comparing multiple values for equality is the only supported comparison type.");
+    }
+    const MultiMatcher& matcher = *(const MultiMatcher*)dataToFind;
+
+    std::vector<MemAddress> addrs;
+    MemoryFuncs::ForEachRegionMemory(pid, memRegions, [&](const MemRegion& region, const uint8_t* data, size_t length)
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            if (matcher.MatchesAny(data + i, length - i))
+            {
+                MemAddress addrStruct = { region.startAddr + i, region };
+                addrs.push_back(addrStruct);
+            }
+        }
+    });
+    return addrs;
+}
+
+std::vector<MemoryFuncs::NeedleMatch> MemoryFuncs::FindNeedlesInMemory(pid_t pid, const std::vector<MemRegion>& memRegions, 
+        const MultiMatcher& matcher)
+{
+    std::vector<NeedleMatch> matches;
+    MemoryFuncs::ForEachRegionMemory(pid, memRegions, [&](const MemRegion& region, const uint8_t* data, size_t length)
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            matcher.ForEachMatch(data + i, length - i, [&](size_t needleIndex)
+            {
+                matches.push_back({ { region.startAddr + i, region }, needleIndex });
+            });
+        }
+    });
+    return matches;
+}
+
+// Compares the value at every position from start to end which is aligned to the size of the type
+template <typename T>
+static void FindTypedValueInChunk(const MemRegion& region, const uint8_t* data, size_t start, size_t end,
+        const TypedValue& value, std::vector<MemoryFuncs::TypedMatch>& matches)
+{
+    for (size_t i = start; i + sizeof(T) <= end; i += sizeof(T))
+    {
+        if (MemoryFuncs::CompareData<T>(data + i, value.data, sizeof(T), value.cmpType))
+        {
+            matches.push_back({ { region.startAddr + i, region }, value.dataType });
+        }
+    }
+}
+
+// Calls FindTypedValueInChunk with the type of the value
+static void FindTypedValueInChunk(const MemRegion& region, const uint8_t* data, size_t start, size_t end,
+        const TypedValue& value, std::vector<MemoryFuncs::TypedMatch>& matches)
+{
+    switch (value.dataType)
+    {
+        case DataType::int8:   FindTypedValueInChunk<int8_t>(region, data, start, end, value, matches);   break;
+        case DataType::int16:  FindTypedValueInChunk<int16_t>(region, data, start, end, value, matches);  break;
+        case DataType::int32:  FindTypedValueInChunk<int32_t>(region, data, start, end, value, matches);  break;
+        case DataType::int64:  FindTypedValueInChunk<int64_t>(region, data, start, end, value, matches);  break;
+        case DataType::uint8:  FindTypedValueInChunk<uint8_t>(region, data, start, end, value, matches);  break;
+        case DataType::uint16: FindTypedValueInChunk<uint16_t>(region, data, start, end, value, matches); break;
+        case DataType::uint32: FindTypedValueInChunk<uint32_t>(region, data, start, end, value, matches); break;
+        case DataType::uint64: FindTypedValueInChunk<uint64_t>(region, data, start, end, value, matches); break;
+        case DataType::f32:    FindTypedValueInChunk<float>(region, data, start, end, value, matches);    break;
+        case DataType::f64:    FindTypedValueInChunk<double>(region, data, start, end, value, matches);   break;
+        default: throw std::invalid_argument("Only numeric types can be compared as typed values.");
+    }
+}
+
+bool MemoryFuncs::CompareTypedValue(const uint8_t* data, const TypedValue& value)
+{
+    switch (value.dataType)
+    {
+        case DataType::int8:   return MemoryFuncs::CompareData<int8_t>(data, value.data, 1, value.cmpType);
+        case DataType::int16:  return MemoryFuncs::CompareData<int16_t>(data, value.data, 2, value.cmpType);
+        case DataType::int32:  return MemoryFuncs::CompareData<int32_t>(data, value.data, 4, value.cmpType);
+        case DataType::int64:  return MemoryFuncs::CompareData<int64_t>(data, value.data, 8, value.cmpType);
+        case DataType::uint8:  return MemoryFuncs::CompareData<uint8_t>(data, value.data, 1, value.cmpType);
+        case DataType::uint16: return MemoryFuncs::CompareData<uint16_t>(data, value.data, 2, value.cmpType);
+        case DataType::uint32: return MemoryFuncs::CompareData<uint32_t>(data, value.data, 4, value.cmpType);
+        case DataType::uint64: return MemoryFuncs::CompareData<uint64_t>(data, value.data, 8, value.cmpType);
+        case DataType::f32:    return MemoryFuncs::CompareData<float>(data, value.data, 4, value.cmpType);
+        case DataType::f64:    return MemoryFuncs::CompareData<double>(data, value.data, 8, value.cmpType);
+        case DataType::be_int16:  return MemoryFuncs::CompareData<BigEndian<int16_t>>(data, value.data, 2, value.cmpType);
+        case DataType::be_int32:  return MemoryFuncs::CompareData<BigEndian<int32_t>>(data, value.data, 4, value.cmpType);
+        case DataType::be_int64:  return MemoryFuncs::CompareData<BigEndian<int64_t>>(data, value.data, 8, value.cmpType);
+        case DataType::be_uint16: return MemoryFuncs::CompareData<BigEndian<uint16_t>>(data, value.data, 2, value.cmpType);
+        case DataType::be_uint32: return MemoryFuncs::CompareData<BigEndian<uint32_t>>(data, value.data, 4, value.cmpType);
+        case DataType::be_uint64: return MemoryFuncs::CompareData<BigEndian<uint64_t>>(data, value.data, 8, value.cmpType);
+        case DataType::be_f32:    return MemoryFuncs::CompareData<BigEndian<float>>(data, value.data, 4, value.cmpType);
+        case DataType::be_f64:    return MemoryFuncs::CompareData<BigEndian<double>>(data, value.data, 8, value.cmpType);
+        default: throw std::invalid_argument("Only numeric types can be compared as typed values.");
+    }
+}
+
+std::vector<MemoryFuncs::TypedMatch> MemoryFuncs::FindTypedValuesInMemory(pid_t pid, 
+        const std::vector<MemRegion>& memRegions, const std::vector<TypedValue>& values)
+{
+    // The values are compared one chunk at a time, so that the chunk stays in the cache while every
+    // value goes over it
+    constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+    std::vector<TypedMatch> matches;
+    MemoryFuncs::ForEachRegionMemory(pid, memRegions, [&](const MemRegion& region, const uint8_t* data, size_t length)
+    {
+        for (size_t start = 0; start < length; start += CHUNK_SIZE)
+        {
+            const size_t end = std::min(start + CHUNK_SIZE, length);
+            const size_t chunkMatchesStart = matches.size();
+            for (const TypedValue& value : values)
+            {
+                FindTypedValueInChunk(region, data, start, end, value, matches);
+            }
+
+            // The matches of every value are in order, the values are merged by address keeping
+            // the order of the values at the same address
+            std::stable_sort(matches.begin() + chunkMatchesStart, matches.end(),
+                    [](const TypedMatch& lhs, const TypedMatch& rhs)
+                    {
+                        return lhs.memAddress.address < rhs.memAddress.address;
+                    });
+        }
+    });
+    return matches;
+}
+
+std::vector<MemoryFuncs::TypedMatch> MemoryFuncs::FindTypedValuesInMemory(pid_t pid, 
+        const std::vector<MemAddress>& memAddrs, const std::vector<DataType>& dataTypes, 
+        const std::vector<TypedValue>& values)
+{
+    std::vector<TypedMatch> matches;
+    uint8_t addrMemory[sizeof(uint64_t)];
+    for (size_t i = 0; i < memAddrs.size(); i++)
+    {
+        const MemAddress& memAddress = memAddrs[i];
+        auto valueIt = std::find_if(values.cbegin(), values.cend(),
+                [&](const TypedValue& value) { return value.dataType == dataTypes[i]; });
+        // Skip unreadable addresses and the types which the value can't be compared as
+        if (!memAddress.memRegion.perms.readFlag || valueIt == values.cend())
+        {
+            continue;
+        }
+
+        // The addresses may no longer be used by the process
+        const size_t dataSize = GetDataTypeSize(dataTypes[i]);
+        ssize_t readAmount;
+        try
+        {
+            readAmount = MemoryFuncs::ReadProcessMemory(pid, memAddress.address, dataSize, addrMemory);
+        }
+        catch (const std::exception& e)
+        {
+            fmt::print(stderr, "WARNING: Error reading memory address {:#018x}: {}\n", 
+                    memAddress.address, e.what());
+            continue;
+        }
+
+        if (readAmount != (ssize_t)dataSize)
+        {
+            fmt::print("WARNING: Partial read of {}/{} at memory address {:#018x}.\n",
+                    readAmount, dataSize, memAddress.address);
+            continue;
+        }
+
+        if (MemoryFuncs::CompareTypedValue(addrMemory, *valueIt))
+        {
+            matches.push_back({ memAddress, dataTypes[i] });
+        }
+    }
+    return matches;
+}
@@ -1,5 +1,7 @@
 #include "MemoryScanner.h"
 #include "MemoryStructs.h"
+#include <algorithm>
+#include <cstring>
 #include <exception>
 #include <stdexcept>
 
@@ -16,6 +18,10 @@ void MemoryScanner::Clear()
 {
     this->m_CurrScanVector.clear();
     this->m_PrevScanVector.clear();
+    this->m_CurrScanTypes.clear();
+    this->m_PrevScanTypes.clear();
+    this->m_CurrScanValues.clear();
+    this->m_PrevScanValues.clear();
 
     this->m_UndoFlag = false;
     this->m_ScanStartedFlag = false;
@@ -34,10 +40,202 @@ void MemoryScanner::Undo()
     else
     {
         this->m_CurrScanVector = this->m_PrevScanVector;
+        this->m_CurrScanTypes = this->m_PrevScanTypes;
+        this->m_CurrScanValues = this->m_PrevScanValues;
         this->m_UndoFlag = true;
     }
 }
 
+size_t MemoryScanner::NewScanAnyType(const std::vector<MemRegion>& memRegions, 
+        const std::vector<TypedValue>& values)
+{
+    // This should never happen
+    if (this->m_ScanStartedFlag)
+    {
+        throw std::runtime_error("Incorrect call to NewScanAnyType after a scan has already begun.");
+    }
+
+    std::vector<MemoryFuncs::TypedMatch> matches = MemoryFuncs::FindTypedValuesInMemory(this->m_pid, 
+            memRegions, values);
+    this->SplitTypedMatches(matches);
+    this->CaptureValues();
+    this->m_UndoFlag = false;
+    this->m_ScanStartedFlag = true;
+
+    return this->m_CurrScanVector.size();
+}
+
+size_t MemoryScanner::NextScanAnyType(const std::vector<TypedValue>& values)
+{
+    if (this->m_CurrScanTypes.size() != this->m_CurrScanVector.size())
+    {
+        throw std::runtime_error("The saved addresses weren't found by a scan of any type.");
+    }
+
+    std::vector<MemoryFuncs::TypedMatch> matches = MemoryFuncs::FindTypedValuesInMemory(this->m_pid, 
+            this->m_CurrScanVector, this->m_CurrScanTypes, values);
+
+    // Replace the previous scan vectors only if the scan succeeded
+    this->m_PrevScanVector = std::move(this->m_CurrScanVector);
+    this->m_PrevScanTypes = std::move(this->m_CurrScanTypes);
+    this->m_PrevScanValues = std::move(this->m_CurrScanValues);
+    this->SplitTypedMatches(matches);
+    this->CaptureValues();
+    this->m_UndoFlag = false;
+
+    return this->m_CurrScanVector.size();
+}
+
+size_t MemoryScanner::NextScanFilter(FilterExpression& filter)
+{
+    // This should never happen, the values are captured by every scan
+    if (this->m_CurrScanValues.size() != this->m_CurrScanVector.size())
+    {
+        throw std::runtime_error("The old values of the saved addresses are missing.");
+    }
+
+    constexpr size_t batchSize = FilterExpression::BATCH_SIZE;
+    const long windowOffset = filter.GetWindowOffset();
+    const size_t windowSize = filter.GetWindowSize();
+    const size_t valueSize = GetDataTypeSize(filter.GetDataType());
+
+    std::vector<MemAddress> memAddrs;
+    std::vector<uint64_t> values;
+    std::vector<uint8_t> windows(batchSize * windowSize);
+    std::vector<MemIoRequest> requests;
+    requests.reserve(batchSize);
+    unsigned long addresses[batchSize];
+    uint8_t results[batchSize];
+
+    // The windows of a whole batch are read together, and then the filter runs over all of them
+    for (size_t start = 0; start < this->m_CurrScanVector.size(); start += batchSize)
+    {
+        const size_t count = std::min(batchSize, this->m_CurrScanVector.size() - start);
+        requests.clear();
+        for (size_t i = 0; i < count; i++)
+        {
+            addresses[i] = this->m_CurrScanVector[start + i].address;
+            requests.push_back({ addresses[i] + windowOffset, windowSize, &windows[i * windowSize], 0 });
+        }
+        MemoryFuncs::ReadProcessMemoryBatch(this->m_pid, requests);
+
+        filter.Evaluate(windows.data(), &this->m_CurrScanValues[start], addresses, count, results);
+
+        // Addresses which are no longer readable are dropped
+        for (size_t i = 0; i < count; i++)
+        {
+            const MemAddress& memAddress = this->m_CurrScanVector[start + i];
+            if (!results[i] || requests[i].result != (ssize_t)windowSize || !memAddress.memRegion.perms.readFlag)
+            {
+                continue;
+            }
+
+            uint64_t value = 0;
+            std::memcpy(&value, &windows[i * windowSize - windowOffset], valueSize);
+            memAddrs.push_back(memAddress);
+            values.push_back(value);
+        }
+    }
+
+    // Replace the previous scan vectors only if the scan succeeded
+    this->m_PrevScanVector = std::move(this->m_CurrScanVector);
+    this->m_PrevScanTypes = std::move(this->m_CurrScanTypes);
+    this->m_PrevScanValues = std::move(this->m_CurrScanValues);
+    this->m_CurrScanVector = std::move(memAddrs);
+    this->m_CurrScanTypes.clear();
+    this->m_CurrScanValues = std::move(values);
+    this->m_UndoFlag = false;
+
+    return this->m_CurrScanVector.size();
+}
+
+void MemoryScanner::SplitTypedMatches(std::vector<MemoryFuncs::TypedMatch>& matches)
+{
+    this->m_CurrScanVector.clear();
+    this->m_CurrScanTypes.clear();
+    this->m_CurrScanVector.reserve(matches.size());
+    this->m_CurrScanTypes.reserve(matches.size());
+    for (MemoryFuncs::TypedMatch& match : matches)
+    {
+        this->m_CurrScanVector.push_back(std::move(match.memAddress));
+        this->m_CurrScanTypes.push_back(match.dataType);
+    }
+}
+
+// Reads 8 bytes at every address, which covers the values of every numeric type
+// Addresses which are close to each other in the same region are read as a single span, so that
+// dense results cost a few large reads instead of a transfer for every address.
+void MemoryScanner::CaptureValues()
+{
+    constexpr unsigned long maxGap = 256;
+    constexpr unsigned long maxSpanSize = 65536;
+    constexpr size_t bufferSize = 1 << 20;
+
+    const std::vector<MemAddress>& memAddrs = this->m_CurrScanVector;
+    this->m_CurrScanValues.assign(memAddrs.size(), 0);
+
+    std::vector<uint8_t> buffer(bufferSize);
+    std::vector<MemIoRequest> requests;
+    std::vector<size_t> spanStarts; // The index of the first address of every span
+    size_t i = 0;
+    while (i < memAddrs.size())
+    {
+        // Fill the buffer with spans
+        requests.clear();
+        spanStarts.clear();
+        size_t bufferUsed = 0;
+        while (i < memAddrs.size() && bufferUsed + maxSpanSize + sizeof(uint64_t) <= bufferSize)
+        {
+            const MemRegion& region = memAddrs[i].memRegion;
+            const unsigned long spanStart = memAddrs[i].address;
+            unsigned long spanEnd = std::min(spanStart + sizeof(uint64_t), region.endAddr);
+            spanStarts.push_back(i);
+            i++;
+            while (i < memAddrs.size() && memAddrs[i].memRegion.startAddr == region.startAddr
+                    && memAddrs[i].address >= memAddrs[i - 1].address && memAddrs[i].address <= spanEnd + maxGap
+                    && memAddrs[i].address - spanStart < maxSpanSize)
+            {
+                spanEnd = std::max(spanEnd, std::min(memAddrs[i].address + sizeof(uint64_t), region.endAddr));
+                i++;
+            }
+            requests.push_back({ spanStart, spanEnd - spanStart, &buffer[bufferUsed], 0 });
+            bufferUsed += spanEnd - spanStart;
+        }
+        spanStarts.push_back(i);
+        MemoryFuncs::ReadProcessMemoryBatch(this->m_pid, requests);
+
+        // Values which can't be read stay 0, and the values at the end of a region only get the
+        // bytes which are in it, which still leaves the smaller values complete
+        for (size_t span = 0; span < requests.size(); span++)
+        {
+            const MemIoRequest& req = requests[span];
+            const size_t readAmount = req.result > 0 ? req.result : 0;
+            for (size_t addrIndex = spanStarts[span]; addrIndex < spanStarts[span + 1]; addrIndex++)
+            {
+                const size_t offset = memAddrs[addrIndex].address - req.address;
+                if (offset < readAmount)
+                {
+                    std::memcpy(&this->m_CurrScanValues[addrIndex], (const uint8_t*)req.buffer + offset,
+                            std::min(sizeof(uint64_t), readAmount - offset));
+                }
+            }
+        }
+    }
+}
+
+void MemoryScanner::SetScanVector(std::vector<MemAddress> memAddrs)
+{
+    // The addresses which were saved before can be restored with undo
+    this->m_PrevScanVector = std::move(this->m_CurrScanVector);
+    this->m_CurrScanVector = std::move(memAddrs);
+    this->m_PrevScanTypes = std::move(this->m_CurrScanTypes);
+    this->m_CurrScanTypes.clear();
+    this->m_PrevScanValues = std::move(this->m_CurrScanValues);
+    this->CaptureValues();
+    this->m_UndoFlag = false;
+    this->m_ScanStartedFlag = true;
+}
+
 void MemoryScanner::SetPid(pid_t pid)
 {
     this->m_pid = pid;
@@ -49,6 +247,11 @@ const std::vector<MemAddress>& MemoryScanner::GetCurrScanVector() const
     return this->m_CurrScanVector;
 }
 
+const std::vector<DataType>& MemoryScanner::GetCurrScanTypes() const
+{
+    return this->m_CurrScanTypes;
+}
+
 bool MemoryScanner::GetScanStartedFlag() const
 {
     return this->m_ScanStartedFlag;
@@ -0,0 +1,69 @@
+#include "MultiMatcher.h"
+#include <stdexcept>
+
+MultiMatcher::MultiMatcher(const std::vector<std::vector<uint8_t>>& needles)
+{
+    if (needles.empty())
+    {
+        throw std::invalid_argument("At least one value is needed.");
+    }
+
+    this->m_Needles = needles;
+    this->m_StartFilter.resize((1 << 16) / 64, 0);
+    this->m_MaxNeedleSize = 0;
+    for (size_t i = 0; i < needles.size(); i++)
+    {
+        if (needles[i].empty())
+        {
+            throw std::invalid_argument("Empty values can't be searched.");
+        }
+
+        // The start is in little endian, like the first two bytes are loaded when searching
+        for (unsigned int second = 0; second < 256; second++)
+        {
+            if (needles[i].size() > 1 && second != needles[i][1])
+            {
+                continue;
+            }
+            const uint16_t start = needles[i][0] | (second << 8);
+            this->m_StartFilter[start / 64] |= 1ULL << (start % 64);
+        }
+
+        const size_t prefixSize = std::min(needles[i].size(), MAX_PREFIX_SIZE);
+        PrefixGroup& group = this->m_Groups[prefixSize - 1];
+        if (group.filter.empty())
+        {
+            group.filter.resize((1 << FILTER_BITS) / 64, 0);
+        }
+
+        const uint64_t prefix = LoadPrefix(needles[i].data(), prefixSize, prefixSize);
+        const uint32_t hash = HashPrefix(prefix);
+        group.filter[hash / 64] |= 1ULL << (hash % 64);
+        group.entries.push_back({ prefix, (uint32_t)i });
+
+        this->m_MaxNeedleSize = std::max(this->m_MaxNeedleSize, needles[i].size());
+    }
+
+    for (PrefixGroup& group : this->m_Groups)
+    {
+        std::stable_sort(group.entries.begin(), group.entries.end(), 
+                [](const PrefixEntry& lhs, const PrefixEntry& rhs) { return lhs.prefix < rhs.prefix; });
+    }
+}
+
+bool MultiMatcher::MatchesAny(const uint8_t* data, size_t available) const
+{
+    bool found = false;
+    this->ForEachMatch(data, available, [&](size_t) { found = true; });
+    return found;
+}
+
+size_t MultiMatcher::GetNeedleAmount() const
+{
+    return this->m_Needles.size();
+}
+
+size_t MultiMatcher::GetMaxNeedleSize() const
+{
+    return this->m_MaxNeedleSize;
+}
@@ -0,0 +1,453 @@
+#include "OfflineTarget.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <elf.h>
+#include <fcntl.h>
+#include <mutex>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <fmt/core.h>
+#include <fmt/chrono.h>
+#include "Snapshot.h"
+
+// The open targets by their ids, the ids count down from -1 so they never collide with real pids
+static std::mutex targetsMutex;
+static std::unordered_map<pid_t, std::shared_ptr<OfflineTarget>> targets;
+static pid_t nextTargetId = -1;
+
+// The type of the note which lists the files mapped by the process in a core file
+constexpr uint32_t NOTE_TYPE_FILE = 0x46494c45; // NT_FILE
+
+OfflineTarget::OfflineTarget(const std::string& path)
+{
+    this->m_Path = path;
+    this->m_Mapping = nullptr;
+    this->m_MappingSize = 0;
+
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        const std::string err = fmt::format("Failed to open file '{}': {}.", path, std::strerror(errno));
+        throw std::runtime_error(err);
+    }
+
+    struct stat fileStat = {};
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+    {
+        close(fd);
+        throw std::runtime_error("The file is empty or can't be accessed.");
+    }
+
+    // A private mapping lets the commands which write memory work on the image without changing the file
+    void* mapping = mmap(nullptr, fileStat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        const std::string err = fmt::format("Failed to map file '{}': {}.", path, std::strerror(errno));
+        throw std::runtime_error(err);
+    }
+    this->m_Mapping = (uint8_t*)mapping;
+    this->m_MappingSize = fileStat.st_size;
+
+    try
+    {
+        if (this->m_MappingSize >= sizeof(SNAPSHOT_MAGIC) 
+                && std::memcmp(this->m_Mapping, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0)
+        {
+            this->LoadSnapshot();
+        }
+        else if (this->m_MappingSize >= SELFMAG && std::memcmp(this->m_Mapping, ELFMAG, SELFMAG) == 0)
+        {
+            this->LoadCoreFile();
+        }
+        else
+        {
+            throw std::runtime_error("The file is not a snapshot or an ELF core file.");
+        }
+    }
+    catch (const std::exception&)
+    {
+        // The destructor isn't called when the constructor throws
+        munmap(this->m_Mapping, this->m_MappingSize);
+        throw;
+    }
+
+    std::sort(this->m_Segments.begin(), this->m_Segments.end(), 
+        [](const Segment& lhs, const Segment& rhs)
+        {
+            return lhs.startAddr < rhs.startAddr;
+        });
+}
+
+OfflineTarget::~OfflineTarget()
+{
+    if (this->m_Mapping != nullptr)
+    {
+        munmap(this->m_Mapping, this->m_MappingSize);
+    }
+}
+
+// Makes sure that a part of the file which the headers point to is really in the file
+void OfflineTarget::CheckRange(uint64_t offset, uint64_t size) const
+{
+    if (offset > this->m_MappingSize || size > this->m_MappingSize - offset)
+    {
+        throw std::runtime_error("The file is truncated or corrupted.");
+    }
+}
+
+// Makes sure that a table of count elements is really in the file
+// The count comes from the file, so it is checked by dividing the space left instead of multiplying,
+// which could wrap around.
+void OfflineTarget::CheckTable(uint64_t offset, uint64_t count, uint64_t elementSize) const
+{
+    if (offset > this->m_MappingSize || count > (this->m_MappingSize - offset) / elementSize)
+    {
+        throw std::runtime_error("The file is truncated or corrupted.");
+    }
+}
+
+void OfflineTarget::LoadSnapshot()
+{
+    this->CheckRange(0, sizeof(SnapshotHeader));
+    SnapshotHeader header;
+    std::memcpy(&header, this->m_Mapping, sizeof(header));
+    if (header.version != SNAPSHOT_VERSION || header.pageSize != SNAPSHOT_PAGE_SIZE)
+    {
+        throw std::runtime_error("Unsupported snapshot version.");
+    }
+    this->CheckTable(header.regionTableOffset, header.regionCount, sizeof(SnapshotRegion));
+    this->CheckTable(header.stringTableOffset, header.stringTableSize, sizeof(char));
+    this->CheckTable(header.hashTableOffset, header.hashCount, sizeof(uint64_t));
+    this->CheckRange(0, header.fileSize);
+
+    const char* stringTable = (const char*)this->m_Mapping + header.stringTableOffset;
+    auto getString = [&](uint32_t offset) -> std::string
+        {
+            if (offset >= header.stringTableSize)
+            {
+                throw std::runtime_error("The file is truncated or corrupted.");
+            }
+            return std::string(stringTable + offset, strnlen(stringTable + offset, header.stringTableSize - offset));
+        };
+
+    for (uint32_t i = 0; i < header.regionCount; i++)
+    {
+        SnapshotRegion region;
+        std::memcpy(&region, this->m_Mapping + header.regionTableOffset + i * sizeof(SnapshotRegion), sizeof(region));
+        if (region.endAddr < region.startAddr)
+        {
+            throw std::runtime_error("The file is truncated or corrupted.");
+        }
+
+        MemRegion memRegion;
+        memRegion.startAddr = region.startAddr;
+        memRegion.endAddr = region.endAddr;
+        memRegion.rangeLength = region.endAddr - region.startAddr;
+        memRegion.permsStr = getString(region.permsOffset);
+        memRegion.pathName = getString(region.pathNameOffset);
+        // Regions which weren't captured have no data to read
+        memRegion.perms.readFlag = region.flags & SnapshotRegion::Captured;
+        memRegion.perms.writeFlag = region.flags & SnapshotRegion::Writable;
+        memRegion.perms.executeFlag = region.flags & SnapshotRegion::Executable;
+        memRegion.perms.sharedFlag = region.flags & SnapshotRegion::Shared;
+        this->m_MemRegions.push_back(memRegion);
+
+        if (region.flags & SnapshotRegion::Captured)
+        {
+            const uint64_t pageCount = (memRegion.rangeLength + SNAPSHOT_PAGE_SIZE - 1) / SNAPSHOT_PAGE_SIZE;
+            if (region.firstHash > header.hashCount || pageCount > header.hashCount - region.firstHash)
+            {
+                throw std::runtime_error("The file is truncated or corrupted.");
+            }
+            this->CheckRange(region.dataOffset, memRegion.rangeLength);
+
+            const uint64_t* pageHashes = (const uint64_t*)(this->m_Mapping + header.hashTableOffset) + region.firstHash;
+            this->m_Segments.push_back({ region.startAddr, region.endAddr, this->m_Mapping + region.dataOffset, pageHashes });
+        }
+    }
+
+    const auto timestamp = std::chrono::system_clock::time_point(std::chrono::seconds(header.timestamp));
+    this->m_Description = fmt::format("Snapshot of pid {} taken at {:%Y-%m-%d %H:%M:%S}", header.pid, 
+            std::chrono::time_point_cast<std::chrono::seconds>(timestamp));
+}
+
+void OfflineTarget::LoadCoreFile()
+{
+    this->CheckRange(0, sizeof(Elf64_Ehdr));
+    Elf64_Ehdr elfHeader;
+    std::memcpy(&elfHeader, this->m_Mapping, sizeof(elfHeader));
+    if (elfHeader.e_ident[EI_CLASS] != ELFCLASS64 || elfHeader.e_type != ET_CORE)
+    {
+        throw std::runtime_error("Only 64-bit ELF core files are supported.");
+    }
+    if (elfHeader.e_phentsize != sizeof(Elf64_Phdr))
+    {
+        throw std::runtime_error("The file is truncated or corrupted.");
+    }
+    this->CheckRange(elfHeader.e_phoff, (uint64_t)elfHeader.e_phnum * sizeof(Elf64_Phdr));
+
+    std::vector<Elf64_Phdr> programHeaders(elfHeader.e_phnum);
+    std::memcpy(programHeaders.data(), this->m_Mapping + elfHeader.e_phoff, programHeaders.size() * sizeof(Elf64_Phdr));
+
+    // The mapped files are listed in the NT_FILE note as (start, end, offset) triplets followed by their names
+    struct MappedFile
+    {
+        unsigned long startAddr;
+        unsigned long endAddr;
+        std::string pathName;
+    };
+    std::vector<MappedFile> mappedFiles;
+    for (const Elf64_Phdr& programHeader : programHeaders)
+    {
+        if (programHeader.p_type != PT_NOTE)
+        {
+            continue;
+        }
+        this->CheckRange(programHeader.p_offset, programHeader.p_filesz);
+
+        const uint8_t* note = this->m_Mapping + programHeader.p_offset;
+        const uint8_t* notesEnd = note + programHeader.p_filesz;
+        while (note + sizeof(Elf64_Nhdr) <= notesEnd)
+        {
+            Elf64_Nhdr noteHeader;
+            std::memcpy(&noteHeader, note, sizeof(noteHeader));
+
+            // The sizes come from the file, so they are checked against the space left before any
+            // pointer is made from them
+            const size_t notesLeft = notesEnd - note - sizeof(Elf64_Nhdr);
+            const size_t nameSize = ((size_t)noteHeader.n_namesz + 3) & ~(size_t)3;
+            if (nameSize > notesLeft || noteHeader.n_descsz > notesLeft - nameSize)
+            {
+                break;
+            }
+            const uint8_t* desc = note + sizeof(Elf64_Nhdr) + nameSize;
+            const uint8_t* descEnd = desc + noteHeader.n_descsz;
+
+            // NT_FILE holds the amount of files and the page size, then a triplet of start, end and
+            // file offset for every file, and then the names of the files
+            constexpr size_t tripletSize = 3 * sizeof(uint64_t);
+            if (noteHeader.n_type == NOTE_TYPE_FILE && noteHeader.n_descsz >= 2 * sizeof(uint64_t))
+            {
+                uint64_t count;
+                std::memcpy(&count, desc, sizeof(count));
+                const uint8_t* entries = desc + 2 * sizeof(uint64_t);
+
+                // A truncated or corrupted note is skipped, the names of the mapped files are optional
+                if (count > (noteHeader.n_descsz - 2 * sizeof(uint64_t)) / tripletSize)
+                {
+                    note = desc + ((noteHeader.n_descsz + 3) & ~3u);
+                    continue;
+                }
+
+                const char* name = (const char*)(entries + count * tripletSize);
+                for (uint64_t i = 0; i < count && name < (const char*)descEnd; i++)
+                {
+                    const uint8_t* triplet = entries + i * tripletSize;
+                    if (triplet + tripletSize > descEnd)
+                    {
+                        break;
+                    }
+
+                    uint64_t range[2];
+                    std::memcpy(range, triplet, sizeof(range));
+                    const size_t nameLength = strnlen(name, (const char*)descEnd - name);
+                    mappedFiles.push_back({ range[0], range[1], std::string(name, nameLength) });
+                    name += nameLength + 1;
+                }
+            }
+            note = desc + ((noteHeader.n_descsz + 3) & ~3u);
+        }
+    }
+
+    for (const Elf64_Phdr& programHeader : programHeaders)
+    {
+        if (programHeader.p_type != PT_LOAD || programHeader.p_memsz == 0)
+        {
+            continue;
+        }
+
+        MemRegion memRegion;
+        memRegion.startAddr = programHeader.p_vaddr;
+        memRegion.endAddr = programHeader.p_vaddr + programHeader.p_memsz;
+        memRegion.rangeLength = programHeader.p_memsz;
+        memRegion.perms.readFlag = (programHeader.p_flags & PF_R) && programHeader.p_filesz != 0;
+        memRegion.perms.writeFlag = programHeader.p_flags & PF_W;
+        memRegion.perms.executeFlag = programHeader.p_flags & PF_X;
+        memRegion.perms.sharedFlag = false;
+        memRegion.permsStr = fmt::format("{}{}{}p", (programHeader.p_flags & PF_R) ? 'r' : '-',
+                memRegion.perms.writeFlag ? 'w' : '-', memRegion.perms.executeFlag ? 'x' : '-');
+
+        memRegion.pathName = "unknown";
+        for (const MappedFile& mappedFile : mappedFiles)
+        {
+            if (memRegion.startAddr >= mappedFile.startAddr && memRegion.startAddr < mappedFile.endAddr)
+            {
+                memRegion.pathName = mappedFile.pathName;
+                break;
+            }
+        }
+        this->m_MemRegions.push_back(memRegion);
+
+        // Core files may leave out the data of some segments, such as read-only mappings of files
+        if (programHeader.p_filesz != 0)
+        {
+            const uint64_t dataSize = std::min(programHeader.p_filesz, programHeader.p_memsz);
+            this->CheckRange(programHeader.p_offset, dataSize);
+            this->m_Segments.push_back({ memRegion.startAddr, memRegion.startAddr + dataSize, 
+                    this->m_Mapping + programHeader.p_offset, nullptr });
+        }
+    }
+
+    std::sort(this->m_MemRegions.begin(), this->m_MemRegions.end(), 
+        [](const MemRegion& lhs, const MemRegion& rhs)
+        {
+            return lhs.startAddr < rhs.startAddr;
+        });
+    this->m_Description = "ELF core file";
+}
+
+pid_t OfflineTarget::Open(const std::string& path)
+{
+    std::shared_ptr<OfflineTarget> target(new OfflineTarget(path));
+
+    std::lock_guard<std::mutex> lock(targetsMutex);
+    const pid_t id = nextTargetId--;
+    targets[id] = std::move(target);
+    return id;
+}
+
+// The target stays alive until the threads which still use it are done with it
+void OfflineTarget::Close(pid_t id)
+{
+    std::lock_guard<std::mutex> lock(targetsMutex);
+    targets.erase(id);
+}
+
+std::shared_ptr<OfflineTarget> OfflineTarget::Find(pid_t id)
+{
+    std::lock_guard<std::mutex> lock(targetsMutex);
+    auto it = targets.find(id);
+    return it != targets.end() ? it->second : nullptr;
+}
+
+bool OfflineTarget::IsOfflineId(pid_t pid)
+{
+    return pid < 0;
+}
+
+ssize_t OfflineTarget::FindSegment(unsigned long address) const
+{
+    // The first segment which starts after the address
+    auto it = std::upper_bound(this->m_Segments.begin(), this->m_Segments.end(), address, 
+        [](unsigned long address, const Segment& segment)
+        {
+            return address < segment.startAddr;
+        });
+    if (it == this->m_Segments.begin() || address >= std::prev(it)->endAddr)
+    {
+        return -1;
+    }
+    return std::prev(it) - this->m_Segments.begin();
+}
+
+// Copies between the buffer and the image, like in a process a transfer continues into the next
+// segment if they are adjacent
+ssize_t OfflineTarget::Transfer(unsigned long address, size_t length, uint8_t* buffer, bool write) const
+{
+    ssize_t segmentIndex = this->FindSegment(address);
+    if (segmentIndex < 0)
+    {
+        return -EFAULT;
+    }
+
+    size_t transferred = 0;
+    while (transferred < length && segmentIndex < (ssize_t)this->m_Segments.size())
+    {
+        const Segment& segment = this->m_Segments[segmentIndex];
+        const unsigned long currAddr = address + transferred;
+        if (currAddr < segment.startAddr || currAddr >= segment.endAddr)
+        {
+            break;
+        }
+
+        const size_t amount = std::min<size_t>(length - transferred, segment.endAddr - currAddr);
+        uint8_t* segmentData = segment.data + (currAddr - segment.startAddr);
+        if (write)
+        {
+            std::memcpy(segmentData, buffer + transferred, amount);
+        }
+        else
+        {
+            std::memcpy(buffer + transferred, segmentData, amount);
+        }
+        transferred += amount;
+        segmentIndex++;
+    }
+    return transferred;
+}
+
+ssize_t OfflineTarget::Read(unsigned long address, size_t length, void* buffer) const
+{
+    return this->Transfer(address, length, (uint8_t*)buffer, false);
+}
+
+ssize_t OfflineTarget::Write(unsigned long address, size_t length, const void* data)
+{
+    return this->Transfer(address, length, (uint8_t*)data, true);
+}
+
+const uint8_t* OfflineTarget::GetData(unsigned long address, size_t length) const
+{
+    const ssize_t segmentIndex = this->FindSegment(address);
+    if (segmentIndex < 0)
+    {
+        return nullptr;
+    }
+
+    const Segment& segment = this->m_Segments[segmentIndex];
+    if (length > segment.endAddr - address)
+    {
+        return nullptr;
+    }
+    return segment.data + (address - segment.startAddr);
+}
+
+const uint64_t* OfflineTarget::GetPageHashes(unsigned long address, size_t pageCount) const
+{
+    const ssize_t segmentIndex = this->FindSegment(address);
+    if (segmentIndex < 0)
+    {
+        return nullptr;
+    }
+
+    const Segment& segment = this->m_Segments[segmentIndex];
+    const unsigned long pageOffset = address - segment.startAddr;
+    if (segment.pageHashes == nullptr || pageOffset % SNAPSHOT_PAGE_SIZE != 0 
+            || pageCount * SNAPSHOT_PAGE_SIZE > segment.endAddr - address)
+    {
+        return nullptr;
+    }
+    return segment.pageHashes + pageOffset / SNAPSHOT_PAGE_SIZE;
+}
+
+const std::vector<MemRegion>& OfflineTarget::GetMemoryRegions() const
+{
+    return this->m_MemRegions;
+}
+
+const std::string& OfflineTarget::GetPath() const
+{
+    return this->m_Path;
+}
+
+const std::string& OfflineTarget::GetDescription() const
+{
+    return this->m_Description;
+}
+
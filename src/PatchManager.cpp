@@ -0,0 +1,252 @@
+#include "PatchManager.h"
+#include <cstring>
+#include <utility>
+#include <fstream>
+#include <stdexcept>
+#include <fmt/core.h>
+#include "DataType.h"
+#include "MemoryFuncs.h"
+#include "ProcessStopper.h"
+#include "Utils.h"
+
+PatchManager::PatchManager()
+{
+    this->m_pid = 0;
+}
+
+PatchManager::~PatchManager() {}
+
+
+void PatchManager::LoadPatchSet(const std::string& name, const std::string& path)
+{
+    std::ifstream patchFile(path);
+    if (!patchFile.is_open())
+    {
+        const std::string err = fmt::format("Failed to open file '{}': {}.", path, std::strerror(errno));
+        throw std::runtime_error(err);
+    }
+
+    PatchSet patchSet = { path, {}, false, {} };
+
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(patchFile, line))
+    {
+        lineNumber++;
+
+        std::vector<std::string> tokens = Utils::SplitString(line, ' ');
+        if (tokens.empty() || tokens[0][0] == '#')
+        {
+            continue;
+        }
+        if (tokens.size() < 3)
+        {
+            const std::string err = fmt::format("Line {}: Expected <address> <type> <value>.", lineNumber);
+            throw std::runtime_error(err);
+        }
+
+        // Strings may contain spaces, so the value is the rest of the line
+        PatchEntry entry;
+        entry.typeStr = tokens[1];
+        entry.dataStr = Utils::JoinVectorOfStrings(tokens, 2, ' ');
+        try
+        {
+            entry.address = Utils::StrToNumber<unsigned long>(tokens[0], "address");
+            entry.data = Utils::DataToByteVector(ParseDataType(entry.typeStr), entry.dataStr);
+        }
+        catch (const std::exception& e)
+        {
+            const std::string err = fmt::format("Line {}: {}", lineNumber, e.what());
+            throw std::runtime_error(err);
+        }
+        patchSet.entries.push_back(std::move(entry));
+    }
+
+    if (patchSet.entries.empty())
+    {
+        throw std::runtime_error("The patch file has no entries.");
+    }
+
+    // Loading a patch set with an existing name replaces it
+    this->m_PatchSets[name] = std::move(patchSet);
+}
+
+void PatchManager::RemovePatchSet(const std::string& name)
+{
+    this->FindPatchSet(name);
+    this->m_PatchSets.erase(name);
+}
+
+void PatchManager::RemoveAllPatchSets()
+{
+    this->m_PatchSets.clear();
+}
+
+static std::string FormatTransferError(const char* action, const MemIoRequest& req)
+{
+    if (req.result < 0)
+    {
+        return fmt::format("Error during {} of memory location {:#018x}: {}", 
+                action, req.address, MemoryFuncs::GetErrorMessage(-req.result));
+    }
+    return fmt::format("Partial {} of {}/{} bytes at memory address {:#018x}.", 
+            action, req.result, req.length, req.address);
+}
+
+PatchResult PatchManager::ApplyPatchSet(const std::string& name, bool saveBackup)
+{
+    PatchSet& patchSet = this->FindPatchSet(name);
+
+    // Everything is prepared before the process is stopped, so that only the transfers are
+    // done while it is stopped
+    size_t backupSize = 0;
+    for (const PatchEntry& entry : patchSet.entries)
+    {
+        backupSize += entry.data.size();
+    }
+    std::vector<uint8_t> backup(saveBackup ? backupSize : 0);
+
+    std::vector<MemIoRequest> writeRequests;
+    std::vector<MemIoRequest> readRequests;
+    writeRequests.reserve(patchSet.entries.size());
+    size_t backupOffset = 0;
+    for (PatchEntry& entry : patchSet.entries)
+    {
+        writeRequests.push_back({ entry.address, entry.data.size(), entry.data.data(), 0 });
+        if (saveBackup)
+        {
+            readRequests.push_back({ entry.address, entry.data.size(), &backup[backupOffset], 0 });
+            backupOffset += entry.data.size();
+        }
+    }
+
+    PatchResult result = { 0, patchSet.entries.size(), false, {}, std::chrono::nanoseconds(0) };
+    std::vector<MemIoRequest> restoreRequests;
+    bool backupFailed = false;
+
+    ProcessStopper stopper(this->m_pid);
+    const auto stopStart = std::chrono::steady_clock::now();
+    stopper.Stop();
+
+    // Nothing is written if the old bytes of one of the entries can't be saved
+    if (saveBackup && MemoryFuncs::ReadProcessMemoryBatch(this->m_pid, readRequests) != readRequests.size())
+    {
+        backupFailed = true;
+    }
+    else
+    {
+        result.written = MemoryFuncs::WriteToProcessMemoryBatch(this->m_pid, writeRequests);
+
+        // Undo the entries that were written when others failed
+        if (saveBackup && result.written != result.total)
+        {
+            // In reverse, so that entries which overlap end up with the oldest bytes
+            for (size_t i = writeRequests.size(); i-- > 0;)
+            {
+                if (writeRequests[i].result > 0)
+                {
+                    restoreRequests.push_back(readRequests[i]);
+                }
+            }
+            MemoryFuncs::WriteToProcessMemoryBatch(this->m_pid, restoreRequests);
+            result.restored = true;
+        }
+    }
+
+    stopper.Resume();
+    result.stopDuration = std::chrono::steady_clock::now() - stopStart;
+
+    // The errors are only formatted once the process continues
+    const std::vector<MemIoRequest>& failedRequests = backupFailed ? readRequests : writeRequests;
+    const char* action = backupFailed ? "read" : "write";
+    for (const MemIoRequest& req : failedRequests)
+    {
+        if (req.result != (ssize_t)req.length)
+        {
+            result.errors.push_back(FormatTransferError(action, req));
+        }
+    }
+    for (const MemIoRequest& req : restoreRequests)
+    {
+        if (req.result != (ssize_t)req.length)
+        {
+            result.errors.push_back(FormatTransferError("restore", req));
+        }
+    }
+
+    patchSet.hasBackup = saveBackup && !backupFailed && !result.restored;
+    patchSet.backup = patchSet.hasBackup ? std::move(backup) : std::vector<uint8_t>();
+    return result;
+}
+
+PatchResult PatchManager::RollbackPatchSet(const std::string& name)
+{
+    PatchSet& patchSet = this->FindPatchSet(name);
+    if (!patchSet.hasBackup)
+    {
+        throw std::runtime_error("The patch set has no saved bytes to roll back to.");
+    }
+
+    // The entries are written back in reverse, so that entries which overlap end up with the oldest bytes
+    std::vector<MemIoRequest> writeRequests;
+    writeRequests.reserve(patchSet.entries.size());
+    size_t backupOffset = patchSet.backup.size();
+    for (auto it = patchSet.entries.crbegin(); it != patchSet.entries.crend(); it++)
+    {
+        backupOffset -= it->data.size();
+        writeRequests.push_back({ it->address, it->data.size(), &patchSet.backup[backupOffset], 0 });
+    }
+
+    PatchResult result = { 0, patchSet.entries.size(), false, {}, std::chrono::nanoseconds(0) };
+
+    ProcessStopper stopper(this->m_pid);
+    const auto stopStart = std::chrono::steady_clock::now();
+    stopper.Stop();
+    result.written = MemoryFuncs::WriteToProcessMemoryBatch(this->m_pid, writeRequests);
+    stopper.Resume();
+    result.stopDuration = std::chrono::steady_clock::now() - stopStart;
+
+    for (const MemIoRequest& req : writeRequests)
+    {
+        if (req.result != (ssize_t)req.length)
+        {
+            result.errors.push_back(FormatTransferError("write", req));
+        }
+    }
+
+    patchSet.hasBackup = false;
+    patchSet.backup.clear();
+    return result;
+}
+
+const std::map<std::string, PatchSet>& PatchManager::GetPatchSets() const
+{
+    return this->m_PatchSets;
+}
+
+const PatchSet& PatchManager::GetPatchSet(const std::string& name) const
+{
+    auto it = this->m_PatchSets.find(name);
+    if (it == this->m_PatchSets.end())
+    {
+        const std::string err = fmt::format("There is no patch set named '{}'.", name);
+        throw std::runtime_error(err);
+    }
+    return it->second;
+}
+
+PatchSet& PatchManager::FindPatchSet(const std::string& name)
+{
+    return const_cast<PatchSet&>(std::as_const(*this).GetPatchSet(name));
+}
+
+void PatchManager::SetPid(pid_t pid)
+{
+    this->m_pid = pid;
+    for (auto& [name, patchSet] : this->m_PatchSets)
+    {
+        patchSet.hasBackup = false;
+        patchSet.backup.clear();
+    }
+}
+
@@ -0,0 +1,280 @@
+#include "PointerIndex.h"
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include "MemoryFuncs.h"
+
+// Regions are read in chunks of this size, so every thread only needs a buffer of this size
+constexpr unsigned long INDEX_CHUNK_SIZE = 4 << 20;
+constexpr int RADIX_BITS = 8;
+constexpr size_t RADIX_BUCKETS = 1 << RADIX_BITS;
+constexpr int RADIX_PASSES = sizeof(unsigned long) * 8 / RADIX_BITS;
+
+namespace
+{
+    struct IndexChunk
+    {
+        unsigned long address;
+        unsigned long length;
+    };
+}
+
+PointerIndex::PointerIndex()
+{
+    this->m_pid = 0;
+    this->m_Built = false;
+    this->m_Compact = false;
+}
+
+PointerIndex::~PointerIndex() {}
+
+
+// A stable LSD radix sort by the value, so the pointers with the same value stay sorted by location
+// The counts of all the passes are taken in one pass over the entries, and the passes where all the
+// values have the same digit (like the high bytes of user space addresses) are skipped.
+static void RadixSortByValue(std::vector<PointerEntry>& entries)
+{
+    std::vector<std::array<size_t, RADIX_BUCKETS>> counts(RADIX_PASSES);
+    for (std::array<size_t, RADIX_BUCKETS>& passCounts : counts)
+    {
+        passCounts.fill(0);
+    }
+    for (const PointerEntry& entry : entries)
+    {
+        for (int pass = 0; pass < RADIX_PASSES; pass++)
+        {
+            counts[pass][(entry.value >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++;
+        }
+    }
+
+    std::vector<PointerEntry> sorted(entries.size());
+    for (int pass = 0; pass < RADIX_PASSES; pass++)
+    {
+        const int shift = pass * RADIX_BITS;
+        std::array<size_t, RADIX_BUCKETS>& passCounts = counts[pass];
+        if (passCounts[(entries[0].value >> shift) & (RADIX_BUCKETS - 1)] == entries.size())
+        {
+            continue;
+        }
+
+        // Turns the counts into the positions where every bucket starts
+        size_t position = 0;
+        for (size_t& count : passCounts)
+        {
+            const size_t bucketSize = count;
+            count = position;
+            position += bucketSize;
+        }
+
+        for (const PointerEntry& entry : entries)
+        {
+            sorted[passCounts[(entry.value >> shift) & (RADIX_BUCKETS - 1)]++] = entry;
+        }
+        entries.swap(sorted);
+    }
+}
+
+void PointerIndex::Build(pid_t pid, const std::vector<MemRegion>& memRegions, unsigned int threadCount, bool compact)
+{
+    if (threadCount == 0)
+    {
+        throw std::invalid_argument("The amount of threads must be at least 1.");
+    }
+
+    // The maps are sorted by address, so the mapped ranges can be searched with a binary search
+    std::vector<std::pair<unsigned long, unsigned long>> mappedRanges;
+    std::vector<IndexChunk> chunks;
+    for (const MemRegion& region : memRegions)
+    {
+        mappedRanges.emplace_back(region.startAddr, region.endAddr);
+        if (!region.perms.readFlag || !region.perms.writeFlag)
+        {
+            continue;
+        }
+        for (unsigned long offset = 0; offset < region.rangeLength; offset += INDEX_CHUNK_SIZE)
+        {
+            chunks.push_back({ region.startAddr + offset, std::min(INDEX_CHUNK_SIZE, region.rangeLength - offset) });
+        }
+    }
+
+    const unsigned long lowestAddr = mappedRanges.empty() ? 0 : mappedRanges.front().first;
+    const unsigned long highestAddr = mappedRanges.empty() ? 0 : mappedRanges.back().second;
+    auto isMapped = [&](unsigned long value)
+    {
+        if (value < lowestAddr || value >= highestAddr)
+        {
+            return false;
+        }
+        auto it = std::upper_bound(mappedRanges.begin(), mappedRanges.end(), value, 
+                [](unsigned long val, const auto& range) { return val < range.first; });
+        return value < std::prev(it)->second;
+    };
+
+    // The pointers of every chunk are kept apart, so that joining them in order leaves them sorted by
+    // location before they are sorted by value
+    std::vector<std::vector<PointerEntry>> chunkPointers(chunks.size());
+    std::atomic<size_t> nextChunk = 0;
+    auto collect = [&]()
+    {
+        std::vector<uint8_t> buffer;
+        for (size_t chunkIndex = nextChunk++; chunkIndex < chunks.size(); chunkIndex = nextChunk++)
+        {
+            const IndexChunk& chunk = chunks[chunkIndex];
+
+            // Offline targets are scanned in place, without copying the chunk
+            const uint8_t* data = MemoryFuncs::GetMappedMemory(pid, chunk.address, chunk.length);
+            size_t length = chunk.length;
+            if (data == nullptr)
+            {
+                buffer.resize(chunk.length);
+                try
+                {
+                    length = MemoryFuncs::ReadProcessMemory(pid, chunk.address, chunk.length, buffer.data());
+                }
+                catch (const std::exception&)
+                {
+                    continue;
+                }
+                data = buffer.data();
+            }
+
+            std::vector<PointerEntry>& pointers = chunkPointers[chunkIndex];
+            for (size_t offset = 0; offset + sizeof(unsigned long) <= length; offset += sizeof(unsigned long))
+            {
+                unsigned long value;
+                std::memcpy(&value, data + offset, sizeof(value));
+                if (isMapped(value))
+                {
+                    pointers.push_back({ value, chunk.address + offset });
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < threadCount; i++)
+    {
+        threads.emplace_back(collect);
+    }
+    collect();
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    size_t pointerAmount = 0;
+    for (const std::vector<PointerEntry>& pointers : chunkPointers)
+    {
+        pointerAmount += pointers.size();
+    }
+    std::vector<PointerEntry> entries;
+    entries.reserve(pointerAmount);
+    for (std::vector<PointerEntry>& pointers : chunkPointers)
+    {
+        entries.insert(entries.end(), pointers.begin(), pointers.end());
+        std::vector<PointerEntry>().swap(pointers);
+    }
+    if (!entries.empty())
+    {
+        RadixSortByValue(entries);
+    }
+
+    this->Clear();
+    this->m_pid = pid;
+    this->m_Built = true;
+    this->m_Compact = compact;
+    if (compact)
+    {
+        this->Compact(entries);
+    }
+    else
+    {
+        this->m_Entries = std::move(entries);
+    }
+}
+
+void PointerIndex::Compact(const std::vector<PointerEntry>& entries)
+{
+    const size_t blockAmount = (entries.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    this->m_BlockValues.reserve(blockAmount);
+    this->m_BlockOffsets.reserve(blockAmount);
+    this->m_Locations.reserve(entries.size());
+
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        if (i % BLOCK_SIZE == 0)
+        {
+            this->m_BlockValues.push_back(entries[i].value);
+            this->m_BlockOffsets.push_back(this->m_Deltas.size());
+        }
+        else
+        {
+            unsigned long diff = entries[i].value - entries[i - 1].value;
+            do
+            {
+                const uint8_t byte = diff & 0x7f;
+                diff >>= 7;
+                this->m_Deltas.push_back(diff != 0 ? (byte | 0x80) : byte);
+            } while (diff != 0);
+        }
+        this->m_Locations.push_back(entries[i].location);
+    }
+    this->m_Deltas.shrink_to_fit();
+}
+
+void PointerIndex::Clear()
+{
+    this->m_Built = false;
+    this->m_Compact = false;
+    std::vector<PointerEntry>().swap(this->m_Entries);
+    std::vector<unsigned long>().swap(this->m_BlockValues);
+    std::vector<uint64_t>().swap(this->m_BlockOffsets);
+    std::vector<uint8_t>().swap(this->m_Deltas);
+    std::vector<unsigned long>().swap(this->m_Locations);
+}
+
+std::vector<PointerEntry> PointerIndex::FindInRange(unsigned long lowest, unsigned long highest, size_t maxResults) const
+{
+    std::vector<PointerEntry> results;
+    this->ForEachInRange(lowest, highest, [&](unsigned long value, unsigned long location)
+    {
+        if (results.size() == maxResults)
+        {
+            return false;
+        }
+        results.push_back({ value, location });
+        return true;
+    });
+    return results;
+}
+
+bool PointerIndex::IsBuilt() const
+{
+    return this->m_Built;
+}
+
+bool PointerIndex::IsCompact() const
+{
+    return this->m_Compact;
+}
+
+pid_t PointerIndex::GetPid() const
+{
+    return this->m_pid;
+}
+
+size_t PointerIndex::GetSize() const
+{
+    return this->m_Compact ? this->m_Locations.size() : this->m_Entries.size();
+}
+
+size_t PointerIndex::GetMemoryUsage() const
+{
+    return this->m_Entries.capacity() * sizeof(PointerEntry) 
+        + this->m_BlockValues.capacity() * sizeof(unsigned long) 
+        + this->m_BlockOffsets.capacity() * sizeof(uint64_t) 
+        + this->m_Deltas.capacity() 
+        + this->m_Locations.capacity() * sizeof(unsigned long);
+}
@@ -0,0 +1,487 @@
+#include "PointerScanner.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <elf.h>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <fmt/core.h>
+#include "MemoryFuncs.h"
+#include "Utils.h"
+
+// The addresses of a depth are handed out to the threads in blocks of this size
+constexpr size_t SEARCH_BLOCK_SIZE = 256;
+constexpr uint32_t NO_PARENT = std::numeric_limits<uint32_t>::max();
+
+namespace
+{
+    struct Module
+    {
+        std::string path;
+        unsigned long baseAddr;
+        unsigned long endAddr; // The end of the .bss section, or 0 if it isn't known
+    };
+
+    // A range of memory where the pointers don't move between runs
+    struct StaticRange
+    {
+        unsigned long startAddr;
+        unsigned long endAddr;
+        size_t moduleIndex;
+    };
+
+    // An address which was reached while searching backwards from the target
+    struct SearchNode
+    {
+        unsigned long address;
+        unsigned long offset; // The offset from the pointer stored here to the address of the parent
+        uint32_t parent;
+    };
+}
+
+PointerScanner::PointerScanner()
+{
+    this->m_pid = 0;
+}
+
+PointerScanner::~PointerScanner() {}
+
+
+static bool IsAnonymousRegion(const MemRegion& region)
+{
+    return region.pathName == "unknown" || region.pathName.empty();
+}
+
+// The base of a module is the start of its first region
+static std::unordered_map<std::string, unsigned long> FindModuleBases(const std::vector<MemRegion>& memRegions)
+{
+    std::unordered_map<std::string, unsigned long> bases;
+    for (const MemRegion& region : memRegions)
+    {
+        if (region.pathName[0] == '/')
+        {
+            bases.try_emplace(region.pathName, region.startAddr);
+        }
+    }
+    return bases;
+}
+
+// Returns the end of the last segment of the module, using the ELF header at its base
+// Returns 0 if the header can't be read
+static unsigned long FindModuleEnd(pid_t pid, unsigned long baseAddr)
+{
+    Elf64_Ehdr header;
+    std::vector<Elf64_Phdr> programHeaders;
+    try
+    {
+        if (MemoryFuncs::ReadProcessMemory(pid, baseAddr, sizeof(header), &header) != sizeof(header)
+                || std::memcmp(header.e_ident, ELFMAG, SELFMAG) != 0 || header.e_ident[EI_CLASS] != ELFCLASS64
+                || header.e_phentsize != sizeof(Elf64_Phdr))
+        {
+            return 0;
+        }
+
+        programHeaders.resize(header.e_phnum);
+        const long length = programHeaders.size() * sizeof(Elf64_Phdr);
+        if (MemoryFuncs::ReadProcessMemory(pid, baseAddr + header.e_phoff, length, programHeaders.data()) != length)
+        {
+            return 0;
+        }
+    }
+    catch (const std::exception&)
+    {
+        return 0;
+    }
+
+    unsigned long lowestAddr = std::numeric_limits<unsigned long>::max();
+    unsigned long highestAddr = 0;
+    for (const Elf64_Phdr& programHeader : programHeaders)
+    {
+        if (programHeader.p_type == PT_LOAD)
+        {
+            lowestAddr = std::min(lowestAddr, programHeader.p_vaddr & ~(programHeader.p_align - 1));
+            highestAddr = std::max(highestAddr, programHeader.p_vaddr + programHeader.p_memsz);
+        }
+    }
+    if (highestAddr == 0)
+    {
+        return 0;
+    }
+
+    // The addresses in executables which aren't position independent are absolute
+    if (header.e_type == ET_EXEC)
+    {
+        return highestAddr;
+    }
+    return baseAddr - lowestAddr + highestAddr;
+}
+
+// The static ranges are the writable regions of the modules, along with the part of the anonymous
+// region right after them which holds the .bss section of the module
+// Other anonymous mappings can be placed right after a module, so the end of the .bss section is
+// taken from the ELF header of the module.
+static void FindStaticRanges(pid_t pid, const std::vector<MemRegion>& memRegions, std::vector<Module>& modules, 
+        std::vector<StaticRange>& staticRanges)
+{
+    const std::unordered_map<std::string, unsigned long> bases = FindModuleBases(memRegions);
+    std::unordered_map<std::string, size_t> moduleIndices;
+
+    for (size_t i = 0; i < memRegions.size(); i++)
+    {
+        const MemRegion& region = memRegions[i];
+        if (!region.perms.readFlag || !region.perms.writeFlag)
+        {
+            continue;
+        }
+
+        if (region.pathName[0] == '/')
+        {
+            auto [it, inserted] = moduleIndices.try_emplace(region.pathName, modules.size());
+            if (inserted)
+            {
+                const unsigned long baseAddr = bases.at(region.pathName);
+                modules.push_back({ region.pathName, baseAddr, FindModuleEnd(pid, baseAddr) });
+            }
+            staticRanges.push_back({ region.startAddr, region.endAddr, it->second });
+        }
+        else if (IsAnonymousRegion(region) && !staticRanges.empty() 
+                && staticRanges.back().endAddr == region.startAddr)
+        {
+            const size_t moduleIndex = staticRanges.back().moduleIndex;
+            const unsigned long bssEnd = std::min(region.endAddr, modules[moduleIndex].endAddr);
+            if (bssEnd > region.startAddr)
+            {
+                staticRanges.push_back({ region.startAddr, bssEnd, moduleIndex });
+            }
+        }
+    }
+}
+
+static const StaticRange* FindStaticRange(const std::vector<StaticRange>& staticRanges, unsigned long address)
+{
+    auto it = std::upper_bound(staticRanges.begin(), staticRanges.end(), address, 
+            [](unsigned long addr, const StaticRange& range) { return addr < range.startAddr; });
+    if (it == staticRanges.begin() || address >= std::prev(it)->endAddr)
+    {
+        return nullptr;
+    }
+    return &*std::prev(it);
+}
+
+PointerScanStats PointerScanner::Scan(const PointerIndex& pointerIndex, const std::vector<MemRegion>& memRegions, 
+        unsigned long target, unsigned int maxDepth, unsigned long maxOffset, unsigned int threadCount)
+{
+    std::vector<Module> modules;
+    std::vector<StaticRange> staticRanges;
+    FindStaticRanges(this->m_pid, memRegions, modules, staticRanges);
+    if (staticRanges.empty())
+    {
+        throw std::runtime_error("The process has no writable module regions.");
+    }
+
+    PointerScanStats stats = { 0, false };
+
+    // The search goes backwards from the target, every depth finds the pointers which point up to
+    // maxOffset bytes before the addresses of the previous depth
+    // Every address is only searched once, the first path which reaches it is the one that is kept
+    std::vector<SearchNode> nodes = { { target, 0, NO_PARENT } };
+    std::unordered_set<unsigned long> visited = { target };
+    std::vector<PointerChain> chains;
+
+    size_t depthStart = 0;
+    for (unsigned int depth = 0; depth < maxDepth && depthStart < nodes.size(); depth++)
+    {
+        const size_t depthEnd = nodes.size();
+
+        std::vector<std::vector<SearchNode>> threadFound(threadCount);
+        std::atomic<size_t> nextBlock = depthStart;
+        std::atomic<size_t> foundAmount = 0;
+        std::atomic<bool> truncated = false;
+        auto search = [&](unsigned int threadIndex)
+        {
+            std::vector<SearchNode>& found = threadFound[threadIndex];
+            for (size_t blockStart = nextBlock.fetch_add(SEARCH_BLOCK_SIZE); blockStart < depthEnd; 
+                    blockStart = nextBlock.fetch_add(SEARCH_BLOCK_SIZE))
+            {
+                const size_t blockEnd = std::min(blockStart + SEARCH_BLOCK_SIZE, depthEnd);
+                for (size_t i = blockStart; i < blockEnd; i++)
+                {
+                    const unsigned long address = nodes[i].address;
+                    const unsigned long lowest = address > maxOffset ? address - maxOffset : 0;
+                    pointerIndex.ForEachInRange(lowest, address, [&](unsigned long value, unsigned long location)
+                    {
+                        if (foundAmount++ >= MAX_ADDRESSES_PER_DEPTH)
+                        {
+                            truncated = true;
+                            return false;
+                        }
+                        found.push_back({ location, address - value, (uint32_t)i });
+                        return true;
+                    });
+                    if (truncated)
+                    {
+                        return;
+                    }
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (unsigned int i = 1; i < threadCount; i++)
+        {
+            threads.emplace_back(search, i);
+        }
+        search(0);
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+        stats.truncated |= truncated;
+
+        // The blocks are taken by the threads in any order, so the results are sorted to make the
+        // chain that is kept for every address the same in every scan
+        std::vector<SearchNode> found;
+        for (std::vector<SearchNode>& threadNodes : threadFound)
+        {
+            found.insert(found.end(), threadNodes.begin(), threadNodes.end());
+            std::vector<SearchNode>().swap(threadNodes);
+        }
+        std::sort(found.begin(), found.end(), [](const SearchNode& lhs, const SearchNode& rhs)
+        {
+            return lhs.parent < rhs.parent || (lhs.parent == rhs.parent && lhs.address < rhs.address);
+        });
+
+        for (const SearchNode& node : found)
+        {
+            // Chains end at the first static address, the pointers which point to it aren't searched
+            // A static address is kept on every path which reaches it, since it doesn't add to the search
+            const StaticRange* staticRange = FindStaticRange(staticRanges, node.address);
+            if (staticRange == nullptr)
+            {
+                if (visited.insert(node.address).second)
+                {
+                    nodes.push_back(node);
+                }
+                continue;
+            }
+            if (chains.size() == MAX_CHAINS)
+            {
+                stats.truncated = true;
+                continue;
+            }
+
+            const Module& module = modules[staticRange->moduleIndex];
+            PointerChain chain = { module.path, node.address - module.baseAddr, { node.offset } };
+            for (uint32_t parent = node.parent; nodes[parent].parent != NO_PARENT; parent = nodes[parent].parent)
+            {
+                chain.offsets.push_back(nodes[parent].offset);
+            }
+            chains.push_back(std::move(chain));
+        }
+        depthStart = depthEnd;
+    }
+
+    this->m_Chains = std::move(chains);
+    stats.chainsFound = this->m_Chains.size();
+    return stats;
+}
+
+std::vector<unsigned long> PointerScanner::Resolve(const std::vector<MemRegion>& memRegions) const
+{
+    const std::unordered_map<std::string, unsigned long> bases = FindModuleBases(memRegions);
+
+    // Holds the next address to read for every chain, and then the address it leads to
+    std::vector<unsigned long> addresses(this->m_Chains.size(), 0);
+    std::vector<unsigned long> values(this->m_Chains.size());
+    std::vector<size_t> activeChains;
+    for (size_t i = 0; i < this->m_Chains.size(); i++)
+    {
+        auto it = bases.find(this->m_Chains[i].modulePath);
+        if (it != bases.end())
+        {
+            addresses[i] = it->second + this->m_Chains[i].moduleOffset;
+            activeChains.push_back(i);
+        }
+    }
+
+    // Every step reads the next pointer of all the chains which can still be followed in one batch
+    std::vector<MemIoRequest> requests;
+    for (size_t step = 0; !activeChains.empty(); step++)
+    {
+        requests.clear();
+        for (size_t i : activeChains)
+        {
+            requests.push_back({ addresses[i], sizeof(unsigned long), &values[i], 0 });
+        }
+        MemoryFuncs::ReadProcessMemoryBatch(this->m_pid, requests);
+
+        size_t activeAmount = 0;
+        for (size_t j = 0; j < activeChains.size(); j++)
+        {
+            const size_t i = activeChains[j];
+            if (requests[j].result != sizeof(unsigned long))
+            {
+                addresses[i] = 0;
+                continue;
+            }
+
+            const std::vector<unsigned long>& offsets = this->m_Chains[i].offsets;
+            addresses[i] = values[i] + offsets[step];
+            if (step + 1 < offsets.size())
+            {
+                activeChains[activeAmount++] = i;
+            }
+        }
+        activeChains.resize(activeAmount);
+    }
+    return addresses;
+}
+
+size_t PointerScanner::Validate(const std::vector<MemRegion>& memRegions, unsigned long target)
+{
+    const std::vector<unsigned long> addresses = this->Resolve(memRegions);
+    std::vector<bool> keep(addresses.size());
+    for (size_t i = 0; i < addresses.size(); i++)
+    {
+        keep[i] = addresses[i] == target;
+    }
+    return this->KeepChains(keep);
+}
+
+size_t PointerScanner::ValidateData(const std::vector<MemRegion>& memRegions, const std::vector<uint8_t>& data)
+{
+    const std::vector<unsigned long> addresses = this->Resolve(memRegions);
+
+    std::vector<uint8_t> buffer(addresses.size() * data.size());
+    std::vector<MemIoRequest> requests;
+    std::vector<size_t> requestChains;
+    for (size_t i = 0; i < addresses.size(); i++)
+    {
+        if (addresses[i] != 0)
+        {
+            requests.push_back({ addresses[i], data.size(), &buffer[i * data.size()], 0 });
+            requestChains.push_back(i);
+        }
+    }
+    MemoryFuncs::ReadProcessMemoryBatch(this->m_pid, requests);
+
+    std::vector<bool> keep(addresses.size(), false);
+    for (size_t j = 0; j < requests.size(); j++)
+    {
+        keep[requestChains[j]] = requests[j].result == (ssize_t)data.size() 
+            && std::memcmp(requests[j].buffer, data.data(), data.size()) == 0;
+    }
+    return this->KeepChains(keep);
+}
+
+size_t PointerScanner::KeepChains(const std::vector<bool>& keep)
+{
+    size_t keptAmount = 0;
+    for (size_t i = 0; i < this->m_Chains.size(); i++)
+    {
+        if (keep[i])
+        {
+            if (keptAmount != i)
+            {
+                this->m_Chains[keptAmount] = std::move(this->m_Chains[i]);
+            }
+            keptAmount++;
+        }
+    }
+    this->m_Chains.resize(keptAmount);
+    return keptAmount;
+}
+
+// Every line holds the path of the module, a tab, and then the offset in the module followed by the
+// offsets of the chain
+void PointerScanner::Save(const std::string& path) const
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        const std::string err = fmt::format("Failed to open file '{}': {}.", path, std::strerror(errno));
+        throw std::runtime_error(err);
+    }
+
+    for (const PointerChain& chain : this->m_Chains)
+    {
+        std::string line = fmt::format("{}\t{:#x}", chain.modulePath, chain.moduleOffset);
+        for (unsigned long offset : chain.offsets)
+        {
+            line += fmt::format(" {:#x}", offset);
+        }
+        file << line << '\n';
+    }
+
+    if (!file.flush())
+    {
+        throw std::runtime_error(fmt::format("Failed to write to file '{}'.", path));
+    }
+}
+
+void PointerScanner::Load(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        const std::string err = fmt::format("Failed to open file '{}': {}.", path, std::strerror(errno));
+        throw std::runtime_error(err);
+    }
+
+    std::vector<PointerChain> chains;
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(file, line))
+    {
+        lineNumber++;
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+
+        const size_t tabPos = line.rfind('\t');
+        const std::vector<std::string> tokens = Utils::SplitString(line.substr(tabPos + 1), ' ');
+        if (tabPos == std::string::npos || tabPos == 0 || tokens.size() < 2)
+        {
+            const std::string err = fmt::format("Line {}: Expected <module>\\t<module offset> <offsets...>.", lineNumber);
+            throw std::runtime_error(err);
+        }
+
+        PointerChain chain = { line.substr(0, tabPos), 0, {} };
+        try
+        {
+            chain.moduleOffset = Utils::StrToNumber<unsigned long>(tokens[0], "module offset");
+            for (size_t i = 1; i < tokens.size(); i++)
+            {
+                chain.offsets.push_back(Utils::StrToNumber<unsigned long>(tokens[i], "offset"));
+            }
+        }
+        catch (const std::exception& e)
+        {
+            throw std::runtime_error(fmt::format("Line {}: {}", lineNumber, e.what()));
+        }
+        chains.push_back(std::move(chain));
+    }
+
+    this->m_Chains = std::move(chains);
+}
+
+void PointerScanner::Clear()
+{
+    this->m_Chains.clear();
+}
+
+const std::vector<PointerChain>& PointerScanner::GetChains() const
+{
+    return this->m_Chains;
+}
+
+void PointerScanner::SetPid(pid_t pid)
+{
+    this->m_pid = pid;
+}
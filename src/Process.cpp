@@ -6,6 +6,9 @@
 #include <stdexcept>
 #include <fstream>
 #include <fmt/core.h>
+#include <fmt/chrono.h>
+#include "MemoryFuncs.h"
+#include "OfflineTarget.h"
 
 Process::Process() 
     : m_MemoryFreezer(MemoryFreezer())
@@ -16,6 +19,7 @@ Process::Process()
 
 Process::Process(pid_t pid)
 {
+    this->m_pid = 0;
     this->SetProcessPid(pid);
 }
 
@@ -28,9 +32,7 @@ void Process::SetProcessPid(pid_t pid)
     // This doesn't check if the pid actually exists
     if (pid > 0 && pid != getpid())
     {
-        this->m_pid = pid;
-        this->m_MemoryScanner.SetPid(pid);
-        this->m_MemoryFreezer.SetPid(pid);
+        this->SetTarget(pid);
     }
     else
     {
@@ -38,6 +40,29 @@ void Process::SetProcessPid(pid_t pid)
     }
 }
 
+void Process::OpenOfflineTarget(const std::string& path)
+{
+    this->SetTarget(OfflineTarget::Open(path));
+}
+
+// The offline target which was used before is closed, since nothing can refer to its id anymore
+void Process::SetTarget(pid_t pid)
+{
+    const pid_t oldPid = this->m_pid;
+
+    this->m_pid = pid;
+    this->m_MemoryScanner.SetPid(pid);
+    this->m_MemoryFreezer.SetPid(pid);
+    this->m_PatchManager.SetPid(pid);
+    this->m_PointerScanner.SetPid(pid);
+    this->m_PointerIndex.Clear();
+
+    if (OfflineTarget::IsOfflineId(oldPid))
+    {
+        OfflineTarget::Close(oldPid);
+    }
+}
+
 void Process::SetMemoryRangeBoundaries(MemRegion& reg, const std::string& addressRange) const
 {
     // The delimiter in the address range is '-', as seen in any maps file
@@ -88,6 +113,10 @@ const std::vector<MemRegion> Process::GetMemoryRegions() const
     {
         throw std::runtime_error("A pid has not been set. (see command `pid`)");
     }
+    if (OfflineTarget::IsOfflineId(this->m_pid))
+    {
+        return OfflineTarget::Find(this->m_pid)->GetMemoryRegions();
+    }
 
     // Make sure we are returning the most up to date memory region structs
     std::string processMapPath = fmt::format("/proc/{}/maps", this->m_pid);
@@ -160,18 +189,53 @@ MemoryFreezer& Process::GetMemoryFreezer()
     return this->m_MemoryFreezer;
 }
 
+PatchManager& Process::GetPatchManager()
+{
+    return this->m_PatchManager;
+}
+
+PointerIndex& Process::GetPointerIndex()
+{
+    return this->m_PointerIndex;
+}
+
+PointerScanner& Process::GetPointerScanner()
+{
+    return this->m_PointerScanner;
+}
+
+static std::string FormatFreezeEvent(const FreezeEvent& event)
+{
+    const std::string time = fmt::format("{:%H:%M:%S}", 
+            std::chrono::time_point_cast<std::chrono::seconds>(event.timestamp));
+
+    const char* action = event.readFailed ? "read" : "write";
+    if (event.err != 0)
+    {
+        return fmt::format("[{}] Error during {} of memory location {:#018x}: {}", 
+                time, action, event.address, MemoryFuncs::GetErrorMessage(event.err));
+    }
+    return fmt::format("[{}] WARNING: Disabling address {:#018x} due to a partial {} of {}/{}.",
+            time, event.address, action, event.bytesTransferred, event.bytesExpected);
+}
+
 void Process::PrintMessageQueues()
 {
-    size_t memFreezerQueueSize = this->m_MemoryFreezer.GetMessageQueueSize();
-    if (memFreezerQueueSize == 0)
+    const std::vector<FreezeEvent> events = this->m_MemoryFreezer.PollEvents();
+    const uint64_t droppedEvents = this->m_MemoryFreezer.PollDroppedEventsAmount();
+    if (events.empty() && droppedEvents == 0)
     {
         return;
     }
 
     fmt::print("\nMessages from MemoryFreezer:\n");
-    while (memFreezerQueueSize--)
+    for (const FreezeEvent& event : events)
     {
-        fmt::print("{}\n", this->m_MemoryFreezer.MessageQueuePop());
+        fmt::print("{}\n", FormatFreezeEvent(event));
+    }
+    if (droppedEvents != 0)
+    {
+        fmt::print("WARNING: {} messages were dropped because too many were sent at once. "
+                "Their addresses were disabled as well.\n", droppedEvents);
     }
 }
-
@@ -0,0 +1,152 @@
+#include "ProcessStopper.h"
+#include "OfflineTarget.h"
+#include <algorithm>
+#include <cerrno>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <sys/ptrace.h>
+#include <sys/wait.h>
+#include <fmt/core.h>
+
+ProcessStopper::ProcessStopper(pid_t pid)
+{
+    this->m_pid = pid;
+    this->m_Stopped = false;
+
+    // Offline targets never run, so there is nothing to stop
+    if (OfflineTarget::IsOfflineId(pid))
+    {
+        return;
+    }
+
+    // Attaching with PTRACE_SEIZE doesn't stop the threads, so it is done before the stop window starts
+    try
+    {
+        this->AttachNewThreads();
+    }
+    catch (const std::exception&)
+    {
+        this->Resume();
+        throw;
+    }
+
+    if (this->m_Threads.empty())
+    {
+        throw std::runtime_error("Invalid PID (process doesn't exist).");
+    }
+}
+
+ProcessStopper::~ProcessStopper()
+{
+    this->Resume();
+}
+
+bool ProcessStopper::AttachNewThreads()
+{
+    const std::string taskDir = fmt::format("/proc/{}/task", this->m_pid);
+    std::error_code ec;
+    std::filesystem::directory_iterator it(taskDir, ec);
+    if (ec)
+    {
+        // The process exited, which is noticed by the caller when no threads were attached
+        return false;
+    }
+
+    bool foundNewThread = false;
+    for (const auto& taskEntry : it)
+    {
+        const pid_t tid = std::stoi(taskEntry.path().filename().string());
+
+        auto isSameThread = [tid](const AttachedThread& thread) { return thread.tid == tid; };
+        if (std::find_if(this->m_Threads.begin(), this->m_Threads.end(), isSameThread) != this->m_Threads.end())
+        {
+            continue;
+        }
+
+        if (ptrace(PTRACE_SEIZE, tid, nullptr, nullptr) == -1)
+        {
+            // The thread exited after it was listed
+            if (errno == ESRCH)
+            {
+                continue;
+            }
+            else if (errno == EPERM)
+            {
+                throw std::runtime_error("Permission denied while attaching to the process.");
+            }
+            throw std::runtime_error(fmt::format("Failed to attach to thread {}.", tid));
+        }
+        this->m_Threads.push_back({ tid, 0, false });
+        foundNewThread = true;
+    }
+    return foundNewThread;
+}
+
+void ProcessStopper::StopThread(AttachedThread& thread)
+{
+    if (ptrace(PTRACE_INTERRUPT, thread.tid, nullptr, nullptr) == -1)
+    {
+        // The thread exited
+        thread.stopped = false;
+        return;
+    }
+
+    int status = 0;
+    if (waitpid(thread.tid, &status, __WALL) == -1 || !WIFSTOPPED(status))
+    {
+        // The thread exited before it stopped
+        thread.stopped = false;
+        return;
+    }
+
+    // A stop which isn't caused by the interrupt means a signal arrived first, it is kept so that
+    // it isn't lost when detaching
+    if ((status >> 16) != PTRACE_EVENT_STOP)
+    {
+        thread.pendingSignal = WSTOPSIG(status);
+    }
+    thread.stopped = true;
+}
+
+void ProcessStopper::Stop()
+{
+    if (this->m_Stopped)
+    {
+        return;
+    }
+    this->m_Stopped = true;
+
+    // Threads which were created before the others stopped are stopped as well
+    size_t nextThread = 0;
+    do
+    {
+        for (; nextThread < this->m_Threads.size(); nextThread++)
+        {
+            this->StopThread(this->m_Threads[nextThread]);
+        }
+    } while (this->AttachNewThreads());
+}
+
+void ProcessStopper::Resume()
+{
+    // The threads can only be detached while they are stopped
+    if (!this->m_Stopped)
+    {
+        for (AttachedThread& thread : this->m_Threads)
+        {
+            this->StopThread(thread);
+        }
+    }
+
+    // Detaching continues the stopped threads
+    for (const AttachedThread& thread : this->m_Threads)
+    {
+        if (thread.stopped)
+        {
+            ptrace(PTRACE_DETACH, thread.tid, nullptr, (void*)(long)thread.pendingSignal);
+        }
+    }
+    this->m_Threads.clear();
+    this->m_Stopped = false;
+}
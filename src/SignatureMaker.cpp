@@ -0,0 +1,206 @@
+#include "SignatureMaker.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <fmt/core.h>
+#include "AobPattern.h"
+#include "MemoryFuncs.h"
+#include "X86Decoder.h"
+
+namespace
+{
+    // The memory of a region where the pattern is searched
+    struct ScopeRegion
+    {
+        unsigned long startAddr;
+        const uint8_t* data;
+        size_t length;
+        std::vector<uint8_t> buffer; // Holds the data when it had to be read
+    };
+
+    // A place where the pattern was found, which is checked again when the pattern grows
+    struct Candidate
+    {
+        size_t regionIndex;
+        size_t offset;
+    };
+}
+
+// Reads the readable regions with the same pathname as the region of the address
+static std::vector<ScopeRegion> ReadScope(pid_t pid, const std::vector<MemRegion>& memRegions, const MemRegion& region)
+{
+    const bool isModule = region.pathName[0] == '/';
+
+    std::vector<ScopeRegion> scope;
+    for (const MemRegion& memRegion : memRegions)
+    {
+        const bool inScope = isModule ? memRegion.pathName == region.pathName : memRegion.startAddr == region.startAddr;
+        if (!inScope || !memRegion.perms.readFlag)
+        {
+            continue;
+        }
+
+        ScopeRegion scopeRegion = { memRegion.startAddr, nullptr, memRegion.rangeLength, {} };
+        scopeRegion.data = MemoryFuncs::GetMappedMemory(pid, memRegion.startAddr, memRegion.rangeLength);
+        if (scopeRegion.data == nullptr)
+        {
+            scopeRegion.buffer.resize(memRegion.rangeLength);
+            try
+            {
+                scopeRegion.length = MemoryFuncs::ReadProcessMemory(pid, memRegion.startAddr, memRegion.rangeLength, 
+                        scopeRegion.buffer.data());
+            }
+            catch (const std::exception&)
+            {
+                continue;
+            }
+            scopeRegion.data = scopeRegion.buffer.data();
+        }
+        scope.push_back(std::move(scopeRegion));
+    }
+    return scope;
+}
+
+SignatureResult SignatureMaker::MakeSignature(pid_t pid, const std::vector<MemRegion>& memRegions, 
+        unsigned long address, size_t maxSize)
+{
+    auto regionIt = std::find_if(memRegions.begin(), memRegions.end(), 
+            [&](const MemRegion& region) { return address >= region.startAddr && address < region.endAddr; });
+    if (regionIt == memRegions.end() || !regionIt->perms.readFlag)
+    {
+        throw std::runtime_error(fmt::format("The address {:#018x} isn't in a readable memory region.", address));
+    }
+    const MemRegion& region = *regionIt;
+
+    // The signature is taken from the same copy of the memory that it is searched in, so it always
+    // matches at the address
+    const std::vector<ScopeRegion> scope = ReadScope(pid, memRegions, region);
+    auto scopeIt = std::find_if(scope.begin(), scope.end(), [&](const ScopeRegion& scopeRegion) 
+            { return address >= scopeRegion.startAddr && address < scopeRegion.startAddr + scopeRegion.length; });
+    if (scopeIt == scope.end())
+    {
+        throw std::runtime_error(fmt::format("Failed to read the memory at {:#018x}.", address));
+    }
+    const size_t addressRegion = scopeIt - scope.begin();
+    const size_t addressOffset = address - scopeIt->startAddr;
+    const uint8_t* code = scopeIt->data + addressOffset;
+    const size_t available = std::min(maxSize, scopeIt->length - addressOffset);
+
+    auto isMapped = [&](unsigned long value)
+    {
+        return std::any_of(memRegions.begin(), memRegions.end(), 
+                [&](const MemRegion& memRegion) { return value >= memRegion.startAddr && value < memRegion.endAddr; });
+    };
+    auto readValue = [&](size_t offset, size_t size)
+    {
+        // Values of 4 bytes are sign extended, like displacements and immediates are
+        int32_t value32 = 0;
+        unsigned long value = 0;
+        if (size == 4)
+        {
+            std::memcpy(&value32, code + offset, sizeof(value32));
+            value = (unsigned long)(long)value32;
+        }
+        else
+        {
+            std::memcpy(&value, code + offset, sizeof(value));
+        }
+        return value;
+    };
+
+    SignatureResult result = { {}, {}, region.pathName, false, 0 };
+    std::vector<Candidate> candidates;
+    bool searched = false;
+    size_t size = 0;
+    while (size < available)
+    {
+        // The next part of the pattern, and which of its bytes are wildcards
+        size_t partSize = 0;
+        std::vector<std::pair<size_t, size_t>> wildcards;
+        X86Instruction instruction;
+        if (region.perms.executeFlag && X86Decoder::DecodeInstruction(code + size, available - size, instruction))
+        {
+            partSize = instruction.length;
+            if (instruction.dispSize == 4 && (instruction.ripRelative 
+                        || isMapped(readValue(size + instruction.dispOffset, 4))))
+            {
+                wildcards.emplace_back(instruction.dispOffset, 4);
+            }
+            if (instruction.immSize >= 4 && (instruction.relativeBranch 
+                        || isMapped(readValue(size + instruction.immOffset, instruction.immSize))))
+            {
+                wildcards.emplace_back(instruction.immOffset, instruction.immSize);
+            }
+        }
+        else if (region.perms.executeFlag)
+        {
+            // Bytes which aren't a valid instruction, or an instruction which is cut off by the maximum size
+            partSize = 1;
+        }
+        else
+        {
+            // Data grows by aligned 8 byte values, so the pointers are wildcards as a whole
+            partSize = 8 - ((address + size) % 8);
+            if (partSize == 8 && size + 8 <= available && isMapped(readValue(size, 8)))
+            {
+                wildcards.emplace_back(0, 8);
+            }
+        }
+        partSize = std::min(partSize, available - size);
+
+        result.bytes.insert(result.bytes.end(), code + size, code + size + partSize);
+        result.mask.insert(result.mask.end(), partSize, 0xff);
+        for (const auto& [offset, length] : wildcards)
+        {
+            std::fill_n(result.mask.begin() + size + offset, length, 0);
+            std::fill_n(result.bytes.begin() + size + offset, length, 0);
+        }
+        size += partSize;
+
+        // A pattern needs a fixed byte to be searched
+        if (std::find(result.mask.begin(), result.mask.end(), 0xff) == result.mask.end())
+        {
+            continue;
+        }
+        const AobPattern pattern(result.bytes, result.mask);
+
+        // The first search goes over the whole scope, then only the places where the shorter pattern
+        // was found are checked again
+        if (!searched)
+        {
+            for (size_t i = 0; i < scope.size(); i++)
+            {
+                const uint8_t* end = scope[i].data + scope[i].length;
+                for (const uint8_t* match = pattern.FindNext(scope[i].data, end); match != nullptr; 
+                        match = pattern.FindNext(match + 1, end))
+                {
+                    candidates.push_back({ i, (size_t)(match - scope[i].data) });
+                }
+            }
+            searched = true;
+        }
+        else
+        {
+            std::erase_if(candidates, [&](const Candidate& candidate)
+            {
+                const ScopeRegion& scopeRegion = scope[candidate.regionIndex];
+                return candidate.offset + size > scopeRegion.length || !pattern.Matches(scopeRegion.data + candidate.offset);
+            });
+        }
+
+        result.matches = candidates.size();
+        if (candidates.size() == 1 && candidates[0].regionIndex == addressRegion && candidates[0].offset == addressOffset)
+        {
+            result.unique = true;
+            break;
+        }
+    }
+
+    // Wildcards at the end don't make the pattern more unique
+    while (!result.mask.empty() && result.mask.back() == 0)
+    {
+        result.bytes.pop_back();
+        result.mask.pop_back();
+    }
+    return result;
+}
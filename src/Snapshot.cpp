@@ -0,0 +1,332 @@
+#include "Snapshot.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unistd.h>
+#include <fmt/core.h>
+#include "MemoryFuncs.h"
+
+// Regions are read in chunks of this size, so every thread only needs a buffer of this size
+constexpr uint64_t CAPTURE_CHUNK_SIZE = 4 << 20;
+
+static uint64_t RotateLeft(uint64_t value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+// Based on the rounds of xxHash64, with 4 independent lanes so that they can run in parallel
+uint64_t Snapshot::HashPage(const uint8_t* data, size_t length)
+{
+    constexpr uint64_t PRIME1 = 0x9e3779b185ebca87ULL;
+    constexpr uint64_t PRIME2 = 0xc2b2ae3d27d4eb4fULL;
+    constexpr uint64_t PRIME3 = 0x165667b19e3779f9ULL;
+
+    uint64_t lanes[4] = { PRIME1 + PRIME2, PRIME2, 0, 0 - PRIME1 };
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32)
+    {
+        for (int lane = 0; lane < 4; lane++)
+        {
+            uint64_t word;
+            std::memcpy(&word, data + i + lane * 8, sizeof(word));
+            lanes[lane] = RotateLeft(lanes[lane] + word * PRIME2, 31) * PRIME1;
+        }
+    }
+
+    uint64_t hash = RotateLeft(lanes[0], 1) + RotateLeft(lanes[1], 7) + RotateLeft(lanes[2], 12) 
+        + RotateLeft(lanes[3], 18) + length;
+    for (; i < length; i++)
+    {
+        hash = RotateLeft(hash ^ (data[i] * PRIME3), 11) * PRIME1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME2;
+    hash ^= hash >> 29;
+    hash *= PRIME3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+static void WriteAt(int fd, const void* data, size_t length, uint64_t offset)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    while (length > 0)
+    {
+        const ssize_t written = pwrite(fd, bytes, length, offset);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            const std::string err = fmt::format("Failed to write the snapshot: {}.", std::strerror(errno));
+            throw std::runtime_error(err);
+        }
+        bytes += written;
+        length -= written;
+        offset += written;
+    }
+}
+
+namespace
+{
+    struct CaptureChunk
+    {
+        size_t regionIndex;
+        uint64_t offset; // From the start of the region
+        uint64_t length;
+    };
+
+    // The state shared by the capturing threads
+    struct CaptureState
+    {
+        pid_t pid;
+        int fd;
+        const std::vector<SnapshotRegion>* regions;
+        std::vector<CaptureChunk> chunks;
+        std::atomic<size_t> nextChunk;
+
+        // Every thread writes the hashes of different pages, so they don't need to be synchronized
+        std::vector<uint64_t> hashes;
+        std::unique_ptr<std::atomic<bool>[]> incompleteRegions;
+
+        std::atomic<uint64_t> bytesRead;
+        std::atomic<uint64_t> bytesWritten;
+
+        std::mutex errorMutex;
+        std::string error; // The first error which stopped the capture
+        std::atomic<bool> failed;
+    };
+}
+
+// Reads chunks until there are none left, hashing every page and writing the pages which aren't zeros
+static void CaptureChunks(CaptureState& state)
+{
+    static const uint8_t zeroPage[SNAPSHOT_PAGE_SIZE] = {};
+    std::vector<uint8_t> buffer(CAPTURE_CHUNK_SIZE);
+
+    try
+    {
+        for (size_t chunkIndex = state.nextChunk++; chunkIndex < state.chunks.size() && !state.failed;
+                chunkIndex = state.nextChunk++)
+        {
+            const CaptureChunk& chunk = state.chunks[chunkIndex];
+            const SnapshotRegion& region = (*state.regions)[chunk.regionIndex];
+
+            ssize_t nread = 0;
+            try
+            {
+                nread = MemoryFuncs::ReadProcessMemory(state.pid, region.startAddr + chunk.offset, 
+                        chunk.length, buffer.data());
+            }
+            catch (const std::exception&) {}
+
+            // The parts that couldn't be read are left as zeros
+            if ((uint64_t)nread != chunk.length)
+            {
+                state.incompleteRegions[chunk.regionIndex] = true;
+                std::memset(buffer.data() + nread, 0, chunk.length - nread);
+            }
+            state.bytesRead += nread;
+
+            // Pages which aren't zeros are written in runs, the zero pages are left as holes
+            const uint64_t firstPage = region.firstHash + chunk.offset / SNAPSHOT_PAGE_SIZE;
+            uint64_t runStart = 0;
+            uint64_t runLength = 0;
+            for (uint64_t pageOffset = 0; pageOffset < chunk.length; pageOffset += SNAPSHOT_PAGE_SIZE)
+            {
+                const uint8_t* page = buffer.data() + pageOffset;
+                state.hashes[firstPage + pageOffset / SNAPSHOT_PAGE_SIZE] = Snapshot::HashPage(page, SNAPSHOT_PAGE_SIZE);
+
+                if (std::memcmp(page, zeroPage, SNAPSHOT_PAGE_SIZE) != 0)
+                {
+                    if (runLength == 0)
+                    {
+                        runStart = pageOffset;
+                    }
+                    runLength += SNAPSHOT_PAGE_SIZE;
+                }
+                else if (runLength != 0)
+                {
+                    WriteAt(state.fd, buffer.data() + runStart, runLength, region.dataOffset + chunk.offset + runStart);
+                    state.bytesWritten += runLength;
+                    runLength = 0;
+                }
+            }
+            if (runLength != 0)
+            {
+                WriteAt(state.fd, buffer.data() + runStart, runLength, region.dataOffset + chunk.offset + runStart);
+                state.bytesWritten += runLength;
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::lock_guard<std::mutex> lock(state.errorMutex);
+        if (!state.failed)
+        {
+            state.error = e.what();
+            state.failed = true;
+        }
+    }
+}
+
+Snapshot::CaptureStats Snapshot::Capture(pid_t pid, const std::vector<MemRegion>& memRegions, 
+        const std::string& path, unsigned int threadCount)
+{
+    SnapshotHeader header = {};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.pageSize = SNAPSHOT_PAGE_SIZE;
+    header.pid = pid;
+    header.regionCount = memRegions.size();
+    header.timestamp = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+
+    // Build the region table and the string table, and give every readable region its place in the file
+    std::vector<SnapshotRegion> regions;
+    std::string stringTable;
+    uint64_t hashCount = 0;
+    for (const MemRegion& memRegion : memRegions)
+    {
+        SnapshotRegion region = {};
+        region.startAddr = memRegion.startAddr;
+        region.endAddr = memRegion.endAddr;
+        if (memRegion.perms.readFlag)
+        {
+            region.flags |= SnapshotRegion::Readable;
+        }
+        if (memRegion.perms.writeFlag)
+        {
+            region.flags |= SnapshotRegion::Writable;
+        }
+        if (memRegion.perms.executeFlag)
+        {
+            region.flags |= SnapshotRegion::Executable;
+        }
+        if (memRegion.perms.sharedFlag)
+        {
+            region.flags |= SnapshotRegion::Shared;
+        }
+
+        region.permsOffset = stringTable.size();
+        stringTable.append(memRegion.permsStr).push_back('\0');
+        region.pathNameOffset = stringTable.size();
+        stringTable.append(memRegion.pathName).push_back('\0');
+
+        if (memRegion.perms.readFlag)
+        {
+            region.flags |= SnapshotRegion::Captured;
+            region.firstHash = hashCount;
+            hashCount += (memRegion.rangeLength + SNAPSHOT_PAGE_SIZE - 1) / SNAPSHOT_PAGE_SIZE;
+        }
+        regions.push_back(region);
+    }
+
+    header.regionTableOffset = sizeof(SnapshotHeader);
+    header.hashTableOffset = header.regionTableOffset + regions.size() * sizeof(SnapshotRegion);
+    header.hashCount = hashCount;
+    header.stringTableOffset = header.hashTableOffset + hashCount * sizeof(uint64_t);
+    header.stringTableSize = stringTable.size();
+
+    uint64_t dataOffset = header.stringTableOffset + header.stringTableSize;
+    dataOffset = (dataOffset + SNAPSHOT_PAGE_SIZE - 1) / SNAPSHOT_PAGE_SIZE * SNAPSHOT_PAGE_SIZE;
+
+    CaptureState state;
+    state.pid = pid;
+    state.regions = &regions;
+    for (size_t i = 0; i < regions.size(); i++)
+    {
+        SnapshotRegion& region = regions[i];
+        if (!(region.flags & SnapshotRegion::Captured))
+        {
+            continue;
+        }
+
+        region.dataOffset = dataOffset;
+        const uint64_t regionLength = region.endAddr - region.startAddr;
+        for (uint64_t offset = 0; offset < regionLength; offset += CAPTURE_CHUNK_SIZE)
+        {
+            state.chunks.push_back({ i, offset, std::min(CAPTURE_CHUNK_SIZE, regionLength - offset) });
+        }
+        dataOffset += (regionLength + SNAPSHOT_PAGE_SIZE - 1) / SNAPSHOT_PAGE_SIZE * SNAPSHOT_PAGE_SIZE;
+    }
+    header.fileSize = dataOffset;
+
+    state.fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (state.fd < 0)
+    {
+        const std::string err = fmt::format("Failed to open file '{}': {}.", path, std::strerror(errno));
+        throw std::runtime_error(err);
+    }
+
+    // The whole file is created as a hole, so only the pages which are written take disk space
+    if (ftruncate(state.fd, header.fileSize) != 0)
+    {
+        const std::string err = fmt::format("Failed to resize file '{}': {}.", path, std::strerror(errno));
+        close(state.fd);
+        throw std::runtime_error(err);
+    }
+
+    state.nextChunk = 0;
+    state.hashes.resize(hashCount);
+    state.incompleteRegions = std::make_unique<std::atomic<bool>[]>(regions.size());
+    state.bytesRead = 0;
+    state.bytesWritten = 0;
+    state.failed = false;
+
+    threadCount = std::clamp<unsigned int>(threadCount, 1, std::max<size_t>(state.chunks.size(), 1));
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < threadCount; i++)
+    {
+        threads.emplace_back(CaptureChunks, std::ref(state));
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    CaptureStats stats = { 0, 0, state.bytesRead, state.bytesWritten };
+    for (size_t i = 0; i < regions.size(); i++)
+    {
+        if (state.incompleteRegions[i])
+        {
+            regions[i].flags |= SnapshotRegion::Incomplete;
+            stats.regionsIncomplete++;
+        }
+        if (regions[i].flags & SnapshotRegion::Captured)
+        {
+            stats.regionsCaptured++;
+        }
+    }
+
+    // The tables are written last, so a file which wasn't fully written has no valid header
+    try
+    {
+        if (state.failed)
+        {
+            throw std::runtime_error(state.error);
+        }
+        WriteAt(state.fd, regions.data(), regions.size() * sizeof(SnapshotRegion), header.regionTableOffset);
+        WriteAt(state.fd, state.hashes.data(), state.hashes.size() * sizeof(uint64_t), header.hashTableOffset);
+        WriteAt(state.fd, stringTable.data(), stringTable.size(), header.stringTableOffset);
+        WriteAt(state.fd, &header, sizeof(header), 0);
+    }
+    catch (const std::exception&)
+    {
+        close(state.fd);
+        unlink(path.c_str());
+        throw;
+    }
+    close(state.fd);
+    return stats;
+}
+
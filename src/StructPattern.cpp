@@ -0,0 +1,87 @@
+#include "StructPattern.h"
+#include <algorithm>
+#include <stdexcept>
+#include <fmt/core.h>
+#include "MemoryFuncs.h"
+
+// Ranks the comparisons by how few values they usually accept, lower ranks are more selective
+static int GetSelectivityRank(ComparisonType cmpType)
+{
+    switch (cmpType)
+    {
+        case ComparisonType::Equal:        return 0;
+        case ComparisonType::Between:      return 1;
+        case ComparisonType::Greater:      return 2;
+        case ComparisonType::Less:         return 2;
+        case ComparisonType::GreaterEqual: return 2;
+        case ComparisonType::LessEqual:    return 2;
+        case ComparisonType::Outside:      return 3;
+        default:                           return 4;
+    }
+}
+
+StructPattern::StructPattern(const std::vector<StructField>& fields)
+{
+    if (fields.empty())
+    {
+        throw std::invalid_argument("A structure needs at least one field.");
+    }
+
+    this->m_Fields = fields;
+    this->m_Size = 0;
+    for (const StructField& field : this->m_Fields)
+    {
+        const size_t fieldSize = GetDataTypeSize(field.value.dataType);
+        if (fieldSize == 0)
+        {
+            throw std::invalid_argument("The fields of a structure must have numeric types.");
+        }
+        // Also keeps the size from wrapping around, which would make the fields be read out of the buffer
+        if (field.offset > MAX_FIELD_OFFSET)
+        {
+            throw std::invalid_argument(fmt::format("The offsets of the fields can't be larger than {}.", 
+                    MAX_FIELD_OFFSET));
+        }
+        this->m_Size = std::max(this->m_Size, field.offset + fieldSize);
+    }
+
+    // Values of larger types are less likely to match by chance
+    std::stable_sort(this->m_Fields.begin(), this->m_Fields.end(), [](const StructField& lhs, const StructField& rhs)
+    {
+        const int lhsRank = GetSelectivityRank(lhs.value.cmpType);
+        const int rhsRank = GetSelectivityRank(rhs.value.cmpType);
+        if (lhsRank != rhsRank)
+        {
+            return lhsRank < rhsRank;
+        }
+        return GetDataTypeSize(lhs.value.dataType) > GetDataTypeSize(rhs.value.dataType);
+    });
+}
+
+bool StructPattern::Matches(const uint8_t* data) const
+{
+    return MemoryFuncs::CompareTypedValue(data + this->m_Fields[0].offset, this->m_Fields[0].value)
+        && this->MatchesOtherFields(data);
+}
+
+bool StructPattern::MatchesOtherFields(const uint8_t* data) const
+{
+    for (size_t i = 1; i < this->m_Fields.size(); i++)
+    {
+        if (!MemoryFuncs::CompareTypedValue(data + this->m_Fields[i].offset, this->m_Fields[i].value))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+const StructField& StructPattern::GetLeadingField() const
+{
+    return this->m_Fields[0];
+}
+
+size_t StructPattern::GetSize() const
+{
+    return this->m_Size;
+}
@@ -118,3 +118,31 @@ MemRegion Utils::FindRegionOfAddress(const std::vector<MemRegion> &memRegions, u
     throw std::runtime_error(err);
 }
 
+
+std::vector<uint8_t> Utils::DataToByteVector(DataType dataType, const std::string& data)
+{
+    switch (dataType)
+    {
+        case DataType::int8:   return Utils::DataToByteVector<int8_t>(data);
+        case DataType::int16:  return Utils::DataToByteVector<int16_t>(data);
+        case DataType::int32:  return Utils::DataToByteVector<int32_t>(data);
+        case DataType::int64:  return Utils::DataToByteVector<int64_t>(data);
+        case DataType::uint8:  return Utils::DataToByteVector<uint8_t>(data);
+        case DataType::uint16: return Utils::DataToByteVector<uint16_t>(data);
+        case DataType::uint32: return Utils::DataToByteVector<uint32_t>(data);
+        case DataType::uint64: return Utils::DataToByteVector<uint64_t>(data);
+        case DataType::f32:    return Utils::DataToByteVector<float>(data);
+        case DataType::f64:    return Utils::DataToByteVector<double>(data);
+        case DataType::string: return Utils::DataToByteVector<std::string>(data);
+        case DataType::aob:    return Utils::DataToByteVector<AobPattern>(data);
+        case DataType::be_int16:  return Utils::DataToByteVector<BigEndian<int16_t>>(data);
+        case DataType::be_int32:  return Utils::DataToByteVector<BigEndian<int32_t>>(data);
+        case DataType::be_int64:  return Utils::DataToByteVector<BigEndian<int64_t>>(data);
+        case DataType::be_uint16: return Utils::DataToByteVector<BigEndian<uint16_t>>(data);
+        case DataType::be_uint32: return Utils::DataToByteVector<BigEndian<uint32_t>>(data);
+        case DataType::be_uint64: return Utils::DataToByteVector<BigEndian<uint64_t>>(data);
+        case DataType::be_f32:    return Utils::DataToByteVector<BigEndian<float>>(data);
+        case DataType::be_f64:    return Utils::DataToByteVector<BigEndian<double>>(data);
+    }
+    throw std::runtime_error("Invalid data type in DataToByteVector()");
+}
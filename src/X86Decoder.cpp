@@ -0,0 +1,330 @@
+#include "X86Decoder.h"
+
+namespace
+{
+    enum class OpcodeMap
+    {
+        OneByte,
+        TwoByte, // 0F xx
+        ThreeByte38, // 0F 38 xx
+        ThreeByte3A, // 0F 3A xx
+    };
+
+    // The operands which follow an opcode
+    struct OpcodeInfo
+    {
+        bool valid;
+        bool hasModRm;
+        size_t immSize;
+        bool relativeBranch;
+    };
+}
+
+static bool InRange(uint8_t value, uint8_t low, uint8_t high)
+{
+    return value >= low && value <= high;
+}
+
+// The size of an immediate which is a word, or a dword when the operand size isn't 16 bits
+static size_t WordImmSize(bool operandSize16)
+{
+    return operandSize16 ? 2 : 4;
+}
+
+static OpcodeInfo GetOneByteOpcodeInfo(uint8_t opcode, uint8_t modRm, bool operandSize16, bool rexW, 
+        bool addressSize32)
+{
+    const size_t immZ = WordImmSize(operandSize16);
+
+    // The arithmetic instructions, every row of 8 opcodes has the same operands
+    if (opcode < 0x40)
+    {
+        switch (opcode & 7)
+        {
+            case 0: case 1: case 2: case 3: return { true, true, 0, false };
+            case 4:                         return { true, false, 1, false };
+            case 5:                         return { true, false, immZ, false };
+            default:                        return { false, false, 0, false }; // Invalid in 64-bit mode
+        }
+    }
+
+    if (InRange(opcode, 0x50, 0x5f) || InRange(opcode, 0x6c, 0x6f) || InRange(opcode, 0x90, 0x99) 
+            || InRange(opcode, 0x9b, 0x9f) || InRange(opcode, 0xa4, 0xa7) || InRange(opcode, 0xaa, 0xaf) 
+            || InRange(opcode, 0xec, 0xef) || InRange(opcode, 0xf8, 0xfd))
+    {
+        return { true, false, 0, false };
+    }
+    if (InRange(opcode, 0x84, 0x8f) || InRange(opcode, 0xd0, 0xd3) || InRange(opcode, 0xd8, 0xdf) || opcode == 0x63)
+    {
+        return { true, true, 0, false };
+    }
+    if (InRange(opcode, 0x70, 0x7f) || InRange(opcode, 0xe0, 0xe3) || opcode == 0xeb)
+    {
+        return { true, false, 1, true };
+    }
+    if (InRange(opcode, 0xb0, 0xb7) || InRange(opcode, 0xe4, 0xe7))
+    {
+        return { true, false, 1, false };
+    }
+    if (InRange(opcode, 0xb8, 0xbf))
+    {
+        return { true, false, rexW ? 8 : immZ, false };
+    }
+    if (InRange(opcode, 0xa0, 0xa3))
+    {
+        // The moffs forms hold an absolute address
+        return { true, false, addressSize32 ? 4u : 8u, false };
+    }
+
+    switch (opcode)
+    {
+        case 0x68: case 0xa9:                       return { true, false, immZ, false };
+        case 0x69: case 0x81: case 0xc7:            return { true, true, immZ, false };
+        case 0x6a: case 0xa8: case 0xcd:            return { true, false, 1, false };
+        case 0x6b: case 0x80: case 0x83:
+        case 0xc0: case 0xc1: case 0xc6:            return { true, true, 1, false };
+        case 0xc2: case 0xca:                       return { true, false, 2, false };
+        case 0xc8:                                  return { true, false, 3, false };
+        case 0xc3: case 0xc9: case 0xcb: case 0xcc:
+        case 0xcf: case 0xd7: case 0xf4: case 0xf5: return { true, false, 0, false };
+        case 0xe8: case 0xe9:                       return { true, false, 4, true };
+        case 0xfe: case 0xff:                       return { true, true, 0, false };
+        // test has an immediate, the other instructions of the group don't
+        case 0xf6: return { true, true, ((modRm >> 3) & 7) < 2 ? 1u : 0u, false };
+        case 0xf7: return { true, true, ((modRm >> 3) & 7) < 2 ? immZ : 0, false };
+        default:   return { false, false, 0, false };
+    }
+}
+
+static OpcodeInfo GetTwoByteOpcodeInfo(uint8_t opcode)
+{
+    if (InRange(opcode, 0x80, 0x8f))
+    {
+        return { true, false, 4, true };
+    }
+    if (InRange(opcode, 0x30, 0x37) || InRange(opcode, 0xc8, 0xcf))
+    {
+        return { true, false, 0, false };
+    }
+
+    switch (opcode)
+    {
+        case 0x05: case 0x06: case 0x07: case 0x08: case 0x09: case 0x0b: case 0x0e:
+        case 0x77: case 0xa0: case 0xa1: case 0xa2: case 0xa8: case 0xa9: case 0xaa:
+            return { true, false, 0, false };
+
+        case 0x0f: // 3DNow! has its opcode in the place of an immediate
+        case 0x70: case 0x71: case 0x72: case 0x73: case 0xa4: case 0xac: case 0xba:
+        case 0xc2: case 0xc4: case 0xc5: case 0xc6:
+            return { true, true, 1, false };
+
+        case 0x04: case 0x0a: case 0x0c: case 0x24: case 0x25: case 0x26: case 0x27:
+        case 0x36: case 0x39: case 0x3b: case 0x3c: case 0x3d: case 0x3e: case 0x3f:
+        case 0x7a: case 0x7b: case 0xa6: case 0xa7: case 0xb9: case 0xff:
+            return { false, false, 0, false };
+
+        default:
+            return { true, true, 0, false };
+    }
+}
+
+static OpcodeInfo GetOpcodeInfo(OpcodeMap map, uint8_t opcode, uint8_t modRm, bool operandSize16, bool rexW, 
+        bool addressSize32)
+{
+    switch (map)
+    {
+        case OpcodeMap::OneByte:     return GetOneByteOpcodeInfo(opcode, modRm, operandSize16, rexW, addressSize32);
+        case OpcodeMap::TwoByte:     return GetTwoByteOpcodeInfo(opcode);
+        case OpcodeMap::ThreeByte38: return { true, true, 0, false };
+        case OpcodeMap::ThreeByte3A: return { true, true, 1, false };
+    }
+    return { false, false, 0, false };
+}
+
+// Decodes the ModR/M byte and what follows it, up to the immediate
+// Returns the position after the displacement, or 0 if the instruction is cut off
+static size_t DecodeModRm(const uint8_t* code, size_t size, size_t pos, X86Instruction& instruction)
+{
+    const uint8_t modRm = code[pos++];
+    const uint8_t mod = modRm >> 6;
+    const uint8_t rm = modRm & 7;
+
+    size_t dispSize = 0;
+    if (mod == 3)
+    {
+        return pos;
+    }
+    if (rm == 4)
+    {
+        if (pos >= size)
+        {
+            return 0;
+        }
+        // A SIB byte without a base register has an absolute displacement
+        const uint8_t sib = code[pos++];
+        if (mod == 0 && (sib & 7) == 5)
+        {
+            dispSize = 4;
+        }
+    }
+    else if (mod == 0 && rm == 5)
+    {
+        dispSize = 4;
+        instruction.ripRelative = true;
+    }
+
+    if (mod == 1)
+    {
+        dispSize = 1;
+    }
+    else if (mod == 2)
+    {
+        dispSize = 4;
+    }
+
+    if (dispSize != 0)
+    {
+        instruction.dispOffset = pos;
+        instruction.dispSize = dispSize;
+    }
+    pos += dispSize;
+    return pos <= size ? pos : 0;
+}
+
+bool X86Decoder::DecodeInstruction(const uint8_t* code, size_t size, X86Instruction& instruction)
+{
+    instruction = { 0, 0, 0, false, 0, 0, false };
+    if (size > MAX_INSTRUCTION_LENGTH)
+    {
+        size = MAX_INSTRUCTION_LENGTH;
+    }
+
+    bool operandSize16 = false;
+    bool addressSize32 = false;
+    bool rexW = false;
+    size_t pos = 0;
+
+    // The legacy prefixes, followed by an optional REX prefix
+    for (; pos < size; pos++)
+    {
+        const uint8_t byte = code[pos];
+        if (byte == 0x66)
+        {
+            operandSize16 = true;
+        }
+        else if (byte == 0x67)
+        {
+            addressSize32 = true;
+        }
+        else if (byte != 0xf0 && byte != 0xf2 && byte != 0xf3 && byte != 0x2e && byte != 0x36 
+                && byte != 0x3e && byte != 0x26 && byte != 0x64 && byte != 0x65)
+        {
+            break;
+        }
+    }
+    if (pos < size && InRange(code[pos], 0x40, 0x4f))
+    {
+        rexW = (code[pos] & 8) != 0;
+        pos++;
+    }
+    if (pos >= size)
+    {
+        return false;
+    }
+
+    // The VEX and EVEX prefixes hold the opcode map, and are always followed by an opcode and a ModR/M
+    OpcodeMap map = OpcodeMap::OneByte;
+    bool vex = false;
+    const uint8_t first = code[pos];
+    if (first == 0xc4 || first == 0xc5 || first == 0x62)
+    {
+        const size_t prefixSize = first == 0xc5 ? 2 : (first == 0xc4 ? 3 : 4);
+        if (pos + prefixSize >= size)
+        {
+            return false;
+        }
+
+        uint8_t mapBits = 1;
+        if (first == 0xc4)
+        {
+            mapBits = code[pos + 1] & 0x1f;
+            rexW = (code[pos + 2] & 0x80) != 0;
+        }
+        else if (first == 0x62)
+        {
+            mapBits = code[pos + 1] & 0x07;
+        }
+
+        switch (mapBits)
+        {
+            case 1:  map = OpcodeMap::TwoByte;     break;
+            case 2:  map = OpcodeMap::ThreeByte38; break;
+            case 3:  map = OpcodeMap::ThreeByte3A; break;
+            default: return false;
+        }
+        pos += prefixSize;
+        vex = true;
+    }
+    else if (first == 0x0f)
+    {
+        pos++;
+        map = OpcodeMap::TwoByte;
+        if (pos < size && (code[pos] == 0x38 || code[pos] == 0x3a))
+        {
+            map = code[pos] == 0x38 ? OpcodeMap::ThreeByte38 : OpcodeMap::ThreeByte3A;
+            pos++;
+        }
+    }
+    if (pos >= size)
+    {
+        return false;
+    }
+
+    const uint8_t opcode = code[pos++];
+    const uint8_t modRm = pos < size ? code[pos] : 0;
+    OpcodeInfo info = GetOpcodeInfo(map, opcode, modRm, operandSize16, rexW, addressSize32);
+    if (vex)
+    {
+        // The instructions which are encoded with VEX or EVEX have a ModR/M except for vzeroupper and
+        // vzeroall, and the only ones in the 0F map with an immediate are the shuffles and the comparisons
+        info.hasModRm = map != OpcodeMap::TwoByte || opcode != 0x77;
+        info.relativeBranch = false;
+        info.valid = true;
+        if (map == OpcodeMap::TwoByte)
+        {
+            info.immSize = (InRange(opcode, 0x70, 0x73) || opcode == 0xc2 || InRange(opcode, 0xc4, 0xc6)) ? 1 : 0;
+        }
+    }
+    if (!info.valid)
+    {
+        return false;
+    }
+
+    if (info.hasModRm)
+    {
+        if (pos >= size)
+        {
+            return false;
+        }
+        pos = DecodeModRm(code, size, pos, instruction);
+        if (pos == 0)
+        {
+            return false;
+        }
+    }
+
+    if (info.immSize != 0)
+    {
+        instruction.immOffset = pos;
+        instruction.immSize = info.immSize;
+        instruction.relativeBranch = info.relativeBranch;
+        pos += info.immSize;
+    }
+    if (pos > size)
+    {
+        return false;
+    }
+
+    instruction.length = pos;
+    return true;
+}
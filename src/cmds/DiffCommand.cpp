@@ -0,0 +1,309 @@
+#include "cmds/DiffCommand.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <fmt/core.h>
+#include "DataType.h"
+#include "MemoryFuncs.h"
+#include "OfflineTarget.h"
+#include "Snapshot.h"
+
+// The memory of the second target is compared in chunks of this size
+constexpr unsigned long DIFF_CHUNK_SIZE = 1 << 20;
+
+struct ChangedRange
+{
+    unsigned long startAddr;
+    unsigned long endAddr;
+    size_t regionIndex; // The index of the region in the first snapshot
+};
+
+struct DiffStats
+{
+    uint64_t pagesCompared;
+    uint64_t pagesChanged;
+    uint64_t pagesMissing; // Pages which couldn't be read from the second target
+    uint64_t bytesChanged;
+};
+
+// Closes an offline target which was only opened for the diff
+class ScopedOfflineTarget
+{
+public:
+    ScopedOfflineTarget(pid_t id) : m_Id(id) {}
+    ~ScopedOfflineTarget() 
+    {
+        OfflineTarget::Close(this->m_Id);
+    }
+
+    ScopedOfflineTarget(const ScopedOfflineTarget&) = delete;
+    ScopedOfflineTarget& operator=(const ScopedOfflineTarget&) = delete;
+
+private:
+    pid_t m_Id;
+};
+
+static void AddChangedRange(std::vector<ChangedRange>& ranges, unsigned long startAddr, unsigned long endAddr,
+        size_t regionIndex)
+{
+    // Changes which continue from the previous one, even across pages, are one range
+    if (!ranges.empty() && ranges.back().endAddr == startAddr && ranges.back().regionIndex == regionIndex)
+    {
+        ranges.back().endAddr = endAddr;
+        return;
+    }
+    ranges.push_back({ startAddr, endAddr, regionIndex });
+}
+
+// Finds the bytes that are different, 8 bytes at a time until a different word is found
+static uint64_t FindChangedRanges(const uint8_t* oldData, const uint8_t* newData, size_t length, 
+        unsigned long baseAddr, size_t regionIndex, std::vector<ChangedRange>& ranges)
+{
+    uint64_t bytesChanged = 0;
+    size_t i = 0;
+    while (i < length)
+    {
+        for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t))
+        {
+            uint64_t oldWord;
+            uint64_t newWord;
+            std::memcpy(&oldWord, oldData + i, sizeof(oldWord));
+            std::memcpy(&newWord, newData + i, sizeof(newWord));
+            if (oldWord != newWord)
+            {
+                break;
+            }
+        }
+        while (i < length && oldData[i] == newData[i])
+        {
+            i++;
+        }
+        if (i == length)
+        {
+            break;
+        }
+
+        const size_t start = i;
+        while (i < length && oldData[i] != newData[i])
+        {
+            i++;
+        }
+        AddChangedRange(ranges, baseAddr + start, baseAddr + i, regionIndex);
+        bytesChanged += i - start;
+    }
+    return bytesChanged;
+}
+
+// Compares the pages by their hashes first, and only compares the bytes of the pages which changed
+// The hashes of the second target are the stored ones if it is a snapshot, otherwise they are computed
+static void DiffRegion(const OfflineTarget& oldTarget, pid_t newPid, const OfflineTarget* newTarget,
+        const MemRegion& region, size_t regionIndex, std::vector<uint8_t>& buffer, 
+        std::vector<ChangedRange>& ranges, DiffStats& stats)
+{
+    for (unsigned long offset = 0; offset < region.rangeLength; offset += DIFF_CHUNK_SIZE)
+    {
+        const unsigned long chunkAddr = region.startAddr + offset;
+        const unsigned long chunkLength = std::min(region.rangeLength - offset, DIFF_CHUNK_SIZE);
+        const size_t pageCount = (chunkLength + SNAPSHOT_PAGE_SIZE - 1) / SNAPSHOT_PAGE_SIZE;
+
+        const uint64_t* oldHashes = oldTarget.GetPageHashes(chunkAddr, pageCount);
+        const uint8_t* oldData = oldTarget.GetData(chunkAddr, chunkLength);
+        if (oldHashes == nullptr || oldData == nullptr)
+        {
+            throw std::runtime_error("The first snapshot is corrupted.");
+        }
+
+        const uint64_t* newHashes = nullptr;
+        if (newTarget != nullptr)
+        {
+            newHashes = newTarget->GetPageHashes(chunkAddr, pageCount);
+        }
+
+        // A live process has to be read, an offline target is used in place
+        const uint8_t* newData = MemoryFuncs::GetMappedMemory(newPid, chunkAddr, chunkLength);
+        unsigned long newLength = chunkLength;
+        if (newData == nullptr)
+        {
+            newLength = 0;
+            try
+            {
+                newLength = MemoryFuncs::ReadProcessMemory(newPid, chunkAddr, chunkLength, buffer.data());
+            }
+            catch (const std::exception&) {}
+            newData = buffer.data();
+        }
+
+        for (size_t page = 0; page < pageCount; page++)
+        {
+            const unsigned long pageOffset = page * SNAPSHOT_PAGE_SIZE;
+            if (pageOffset >= newLength)
+            {
+                stats.pagesMissing += pageCount - page;
+                break;
+            }
+            const size_t pageLength = std::min<unsigned long>(SNAPSHOT_PAGE_SIZE, newLength - pageOffset);
+            stats.pagesCompared++;
+
+            const uint64_t newHash = newHashes != nullptr ? newHashes[page] 
+                : Snapshot::HashPage(newData + pageOffset, pageLength);
+            if (newHash == oldHashes[page] && pageLength == SNAPSHOT_PAGE_SIZE)
+            {
+                continue;
+            }
+
+            const uint64_t bytesChanged = FindChangedRanges(oldData + pageOffset, newData + pageOffset, pageLength, 
+                    chunkAddr + pageOffset, regionIndex, ranges);
+            if (bytesChanged != 0)
+            {
+                stats.pagesChanged++;
+                stats.bytesChanged += bytesChanged;
+            }
+        }
+    }
+}
+
+// Saves every address where a value of the given size overlaps a change, for the next scan
+static size_t SeedScanner(Process& proc, const std::vector<ChangedRange>& ranges, 
+        const std::vector<MemRegion>& regions, size_t dataSize)
+{
+    std::vector<MemAddress> memAddrs;
+    unsigned long nextAddr = 0;
+    for (const ChangedRange& range : ranges)
+    {
+        const MemRegion& region = regions[range.regionIndex];
+        if (region.rangeLength < dataSize)
+        {
+            continue;
+        }
+
+        // The value has to start inside the region and end before the end of it
+        unsigned long startAddr = range.startAddr >= region.startAddr + dataSize - 1 
+            ? range.startAddr - dataSize + 1 : region.startAddr;
+        startAddr = std::max(startAddr, nextAddr);
+        const unsigned long endAddr = std::min(range.endAddr, region.endAddr - dataSize + 1);
+        for (unsigned long address = startAddr; address < endAddr; address++)
+        {
+            memAddrs.push_back({ address, region });
+        }
+        nextAddr = std::max(nextAddr, endAddr);
+    }
+
+    const size_t amount = memAddrs.size();
+    proc.GetMemoryScanner().SetScanVector(std::move(memAddrs));
+    return amount;
+}
+
+void DiffCommand::Main(Process& proc, const std::vector<std::string>& args)
+{
+    std::string seedTypeStr = "";
+    std::vector<std::string> positionalArgs;
+    for (size_t i = 1; i < args.size(); i++)
+    {
+        if (args[i] == "--seed")
+        {
+            if (i + 1 >= args.size())
+            {
+                throw std::runtime_error("Missing type argument.");
+            }
+            seedTypeStr = args[++i];
+        }
+        else
+        {
+            positionalArgs.push_back(args[i]);
+        }
+    }
+
+    if (positionalArgs.empty())
+    {
+        throw std::runtime_error("Missing arguments.");
+    }
+
+    size_t seedSize = 0;
+    if (!seedTypeStr.empty())
+    {
+        seedSize = GetDataTypeSize(ParseDataType(seedTypeStr));
+        if (seedSize == 0)
+        {
+            throw std::runtime_error("Strings and byte patterns can't be used with --seed.");
+        }
+    }
+
+    const pid_t oldId = OfflineTarget::Open(positionalArgs[0]);
+    ScopedOfflineTarget oldTargetScope(oldId);
+    std::shared_ptr<OfflineTarget> oldTarget = OfflineTarget::Find(oldId);
+
+    // The second snapshot, or the current process if it wasn't given
+    pid_t newPid = proc.GetCurrentPid();
+    std::unique_ptr<ScopedOfflineTarget> newTargetScope;
+    if (positionalArgs.size() > 1)
+    {
+        newPid = OfflineTarget::Open(positionalArgs[1]);
+        newTargetScope = std::make_unique<ScopedOfflineTarget>(newPid);
+    }
+    else if (newPid == 0)
+    {
+        throw std::runtime_error("A pid has not been set. (see command `pid`)");
+    }
+    std::shared_ptr<OfflineTarget> newTarget = OfflineTarget::Find(newPid);
+
+    const auto start = std::chrono::steady_clock::now();
+
+    const std::vector<MemRegion>& regions = oldTarget->GetMemoryRegions();
+    std::vector<uint8_t> buffer(DIFF_CHUNK_SIZE);
+    std::vector<ChangedRange> ranges;
+    DiffStats stats = {};
+    for (size_t i = 0; i < regions.size(); i++)
+    {
+        if (!regions[i].perms.readFlag)
+        {
+            continue;
+        }
+        if (oldTarget->GetPageHashes(regions[i].startAddr, 1) == nullptr)
+        {
+            throw std::runtime_error("The first file must be a snapshot made by the command `snapshot`.");
+        }
+        DiffRegion(*oldTarget, newPid, newTarget.get(), regions[i], i, buffer, ranges, stats);
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (seedSize != 0)
+    {
+        const size_t seeded = SeedScanner(proc, ranges, regions, seedSize);
+        fmt::print("Saved {} addresses where a {} overlaps a change, use `scan` to filter them.\n", seeded, seedTypeStr);
+    }
+    else
+    {
+        for (const ChangedRange& range : ranges)
+        {
+            fmt::print("{:#018x}-{:#018x} {} bytes (in {})\n", range.startAddr, range.endAddr, 
+                    range.endAddr - range.startAddr, regions[range.regionIndex].pathName);
+        }
+    }
+
+    fmt::print("{} bytes changed in {} ranges, {}/{} pages changed. ({:.2f}s)\n", stats.bytesChanged, ranges.size(),
+            stats.pagesChanged, stats.pagesCompared, seconds);
+    if (stats.pagesMissing != 0)
+    {
+        fmt::print("WARNING: {} pages could not be read from the second target.\n", stats.pagesMissing);
+    }
+}
+
+std::string DiffCommand::Help()
+{
+    return std::string(
+        "Usage: diff <snapshot> [snapshot] [--seed <type>]\n\n"
+
+        "Prints the ranges of memory which changed between two snapshots (see command `snapshot`),\n"
+        "or between a snapshot and the current process if only one is given.\n"
+        "Only the regions of the first snapshot are compared.\n\n"
+
+        "The pages are compared by the hashes that were saved with the snapshots first, so only the\n"
+        "pages which changed are compared byte by byte.\n\n"
+
+        "--seed <type> -- Instead of printing the ranges, saves every address where a value of <type>\n"
+            "\toverlaps a change as the scan list, so that the next `scan` only checks them.\n");
+}
+
@@ -1,54 +1,251 @@
 #include "cmds/DumpCommand.h"
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <exception>
+#include <filesystem>
+#include <fstream>
 #include <stdexcept>
-#include <cctype>
 #include <fmt/core.h>
 #include "MemoryFuncs.h"
 #include "Utils.h"
 
-void DumpCommand::Main(Process& proc, const std::vector<std::string>& args)
+constexpr size_t BYTES_PER_LINE = 16;
+// "0x" + 16 hex digits + ": ", 3 characters for every byte, and the printable characters between '|'
+constexpr size_t MAX_LINE_LENGTH = 20 + BYTES_PER_LINE * 3 + BYTES_PER_LINE + 3;
+
+// The range is read in chunks of this size, so that huge ranges don't have to fit in memory
+// It is a multiple of BYTES_PER_LINE so that lines never cross chunks
+constexpr unsigned long READ_CHUNK_SIZE = 1 << 20;
+// The formatted lines are collected and printed together once there are this many characters
+constexpr size_t OUTPUT_BUFFER_SIZE = 1 << 20;
+// Zeroed blocks of this size are left as holes in sparse files
+constexpr size_t SPARSE_BLOCK_SIZE = 4096;
+
+// The 2 hex digits of every byte value
+static constexpr std::array<char, 512> HEX_TABLE = []()
 {
-    if (args.size() < 3)
+    constexpr char digits[] = "0123456789abcdef";
+    std::array<char, 512> table = {};
+    for (size_t i = 0; i < 256; i++)
     {
-        throw std::runtime_error("Missing arguments.");
+        table[i * 2] = digits[i >> 4];
+        table[i * 2 + 1] = digits[i & 0xf];
     }
+    return table;
+}();
 
-    unsigned long baseAddr = Utils::StrToNumber<unsigned long>(args[1], "address");
-    unsigned long length = Utils::StrToNumber<unsigned long>(args[2], "length");
+// The character which is shown for every byte value, non-printable ASCII characters are shown as '.'
+static constexpr std::array<char, 256> PRINTABLE_TABLE = []()
+{
+    std::array<char, 256> table = {};
+    for (size_t i = 0; i < 256; i++)
+    {
+        table[i] = (i >= 0x20 && i < 0x7f) ? (char)i : '.';
+    }
+    return table;
+}();
 
-    const std::vector<uint8_t> dataVec = MemoryFuncs::ReadProcessMemory(proc.GetCurrentPid(), baseAddr, length);
-    const size_t dataLen = dataVec.size();
-    constexpr int BYTES_PER_LINE = 16;
+static char* AppendHexByte(char* out, uint8_t byte)
+{
+    std::memcpy(out, &HEX_TABLE[byte * 2], 2);
+    return out + 2;
+}
 
-    for (size_t i = 0; i < dataLen; i += BYTES_PER_LINE)
+// Formats a line of the dump into the given buffer and returns the end of the line
+static char* FormatLine(char* out, unsigned long address, const uint8_t* data, size_t length)
+{
+    // The memory address is 16 characters long
+    *out++ = '0';
+    *out++ = 'x';
+    for (int shift = 56; shift >= 0; shift -= 8)
+    {
+        out = AppendHexByte(out, address >> shift);
+    }
+    *out++ = ':';
+    *out++ = ' ';
+
+    for (size_t i = 0; i < length; i++)
+    {
+        out = AppendHexByte(out, data[i]);
+        *out++ = ' ';
+    }
+    // Pad the last line if it is shorter, every hex byte takes 3 characters
+    const size_t padding = (BYTES_PER_LINE - length) * 3;
+    std::memset(out, ' ', padding);
+    out += padding;
+
+    *out++ = '|';
+    for (size_t i = 0; i < length; i++)
+    {
+        *out++ = PRINTABLE_TABLE[data[i]];
+    }
+    *out++ = '|';
+    *out++ = '\n';
+    return out;
+}
+
+// Reads the range in chunks and passes every chunk to the callback, along with its address
+// Reading stops at the first chunk which can't be fully read, returns the amount of bytes that were read
+template <typename Callback>
+static unsigned long ReadInChunks(pid_t pid, unsigned long baseAddr, unsigned long length, Callback callback)
+{
+    std::vector<uint8_t> chunk(std::min(length, READ_CHUNK_SIZE));
+    unsigned long offset = 0;
+    while (offset < length)
     {
-        std::string printableData = ""; // Holds printable ASCII characters 
-        // Output the memory address offset (memory address is 16 characters long)
-        fmt::print("{:#018x}: ", baseAddr + i);
+        const unsigned long chunkSize = std::min(length - offset, READ_CHUNK_SIZE);
 
-        for (int j = 0; j < BYTES_PER_LINE; j++)
+        ssize_t nread;
+        try
         {
-            // Avoid going out of bounds
-            if (i + j >= dataLen)
+            nread = MemoryFuncs::ReadProcessMemory(pid, baseAddr + offset, chunkSize, chunk.data());
+        }
+        catch (const std::exception&)
+        {
+            // Only an error at the very start means that nothing could be read
+            if (offset == 0)
+            {
+                throw;
+            }
+            break;
+        }
+
+        callback(baseAddr + offset, chunk.data(), nread);
+        offset += nread;
+        if ((unsigned long)nread != chunkSize)
+        {
+            break;
+        }
+    }
+    return offset;
+}
+
+static unsigned long PrintHexDump(pid_t pid, unsigned long baseAddr, unsigned long length)
+{
+    std::vector<char> output(OUTPUT_BUFFER_SIZE);
+    char* const outputStart = output.data();
+    char* const outputLimit = outputStart + output.size() - MAX_LINE_LENGTH;
+    char* out = outputStart;
+
+    const unsigned long dataLen = ReadInChunks(pid, baseAddr, length, 
+        [&](unsigned long chunkAddr, const uint8_t* data, size_t dataSize)
+        {
+            for (size_t i = 0; i < dataSize; i += BYTES_PER_LINE)
             {
-                // Add padding if the last line is shorter
-                for (int k = 0; k < BYTES_PER_LINE - j; k++)
+                if (out > outputLimit)
                 {
-                    // Pad with 3 spaces because there is a space inbetween every hex byte
-                    // and every hex byte takes 2 characters
-                    fmt::print("   ");
+                    std::fwrite(outputStart, 1, out - outputStart, stdout);
+                    out = outputStart;
                 }
-                break;
+                out = FormatLine(out, chunkAddr + i, data + i, std::min(BYTES_PER_LINE, dataSize - i));
             }
-            int byte = dataVec[i + j]; // Read a byte from the vector
-            fmt::print("{:02x} ", byte);
+        });
+    std::fwrite(outputStart, 1, out - outputStart, stdout);
+    return dataLen;
+}
 
-            // Save ASCII character, if it's printable
-            printableData += std::isprint(byte) ? byte : '.';
+// Writes the memory as is to the file
+// With sparse enabled, blocks which are all zeros are skipped so that they become holes in the file
+static unsigned long DumpToFile(pid_t pid, unsigned long baseAddr, unsigned long length, 
+        const std::string& path, bool sparse)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        const std::string err = fmt::format("Failed to open file '{}': {}.", path, std::strerror(errno));
+        throw std::runtime_error(err);
+    }
+
+    static const uint8_t zeroBlock[SPARSE_BLOCK_SIZE] = {};
+    unsigned long fileOffset = 0;
+    const unsigned long dataLen = ReadInChunks(pid, baseAddr, length, 
+        [&](unsigned long, const uint8_t* data, size_t dataSize)
+        {
+            if (!sparse)
+            {
+                file.write((const char*)data, dataSize);
+                return;
+            }
+
+            for (size_t i = 0; i < dataSize; i += SPARSE_BLOCK_SIZE)
+            {
+                const size_t blockSize = std::min(SPARSE_BLOCK_SIZE, dataSize - i);
+                if (std::memcmp(data + i, zeroBlock, blockSize) != 0)
+                {
+                    // Seeking past the end of the file leaves a hole before the written data
+                    file.seekp(fileOffset + i);
+                    file.write((const char*)data + i, blockSize);
+                }
+            }
+            fileOffset += dataSize;
+        });
+    file.close();
+
+    if (!file)
+    {
+        const std::string err = fmt::format("Failed to write to file '{}'.", path);
+        throw std::runtime_error(err);
+    }
+
+    // Extend the file over a hole at the end
+    if (sparse)
+    {
+        std::filesystem::resize_file(path, dataLen);
+    }
+    return dataLen;
+}
+
+void DumpCommand::Main(Process& proc, const std::vector<std::string>& args)
+{
+    std::string rawPath = "";
+    bool sparse = false;
+    std::vector<std::string> positionalArgs;
+    for (size_t i = 1; i < args.size(); i++)
+    {
+        if (args[i] == "--raw")
+        {
+            if (i + 1 >= args.size())
+            {
+                throw std::runtime_error("Missing file argument.");
+            }
+            rawPath = args[++i];
+        }
+        else if (args[i] == "--sparse")
+        {
+            sparse = true;
+        }
+        else
+        {
+            positionalArgs.push_back(args[i]);
         }
-        fmt::print("|{}|\n", printableData);
     }
+
+    if (positionalArgs.size() < 2)
+    {
+        throw std::runtime_error("Missing arguments.");
+    }
+    if (sparse && rawPath.empty())
+    {
+        throw std::runtime_error("--sparse can only be used with --raw.");
+    }
+
+    unsigned long baseAddr = Utils::StrToNumber<unsigned long>(positionalArgs[0], "address");
+    unsigned long length = Utils::StrToNumber<unsigned long>(positionalArgs[1], "length");
+
+    unsigned long dataLen;
+    if (rawPath.empty())
+    {
+        dataLen = PrintHexDump(proc.GetCurrentPid(), baseAddr, length);
+    }
+    else
+    {
+        dataLen = DumpToFile(proc.GetCurrentPid(), baseAddr, length, rawPath, sparse);
+        fmt::print("Wrote {} bytes to '{}'.\n", dataLen, rawPath);
+    }
+
     // Notify the user if the dump is partial
     if (dataLen != length)
     {
@@ -59,8 +256,10 @@ void DumpCommand::Main(Process& proc, const std::vector<std::string>& args)
 std::string DumpCommand::Help()
 {
     return std::string(
-        "Usage: dump <address> <length>\n\n"
+        "Usage: dump [--raw <file> [--sparse]] <address> <length>\n\n"
 
-        "Ouputs a hex dump with the given length of the data in the given address.\n");
-}
+        "Ouputs a hex dump with the given length of the data in the given address.\n\n"
 
+        "--raw <file> -- Writes the data as is to the file instead.\n"
+        "--sparse -- Leaves blocks of zeros as holes in the file, so that they take no disk space.\n");
+}
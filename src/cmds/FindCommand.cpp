@@ -11,46 +11,150 @@
 #include "MemoryFuncs.h"
 
 template <typename T>
-std::vector<MemAddress> FindData(const Process& proc, const std::string& dataStr)
+std::vector<MemAddress> FindData(const Process& proc, const std::vector<MemRegion>& memRegions, 
+        const std::string& dataStr)
 {
     constexpr unsigned long dataTypeSize = sizeof(T); 
     T dataValue = Utils::StrToNumber<T>(dataStr);
     
-    return MemoryFuncs::FindDataInMemory<T>(proc.GetCurrentPid(), proc.GetMemoryRegions(), 
-            dataTypeSize, &dataValue, ComparisonType::Equal);
+    return MemoryFuncs::FindDataInMemory<T>(proc.GetCurrentPid(), memRegions, dataTypeSize, &dataValue, 
+            ComparisonType::Equal);
 }
 
 template <>
-std::vector<MemAddress> FindData<std::string>(const Process& proc, const std::string& dataStr)
+std::vector<MemAddress> FindData<std::string>(const Process& proc, const std::vector<MemRegion>& memRegions, 
+        const std::string& dataStr)
 {
-    return MemoryFuncs::FindDataInMemory<std::string>(proc.GetCurrentPid(), proc.GetMemoryRegions(),
-            dataStr.size(), dataStr.c_str(), ComparisonType::Equal);
+    return MemoryFuncs::FindDataInMemory<std::string>(proc.GetCurrentPid(), memRegions, dataStr.size(), 
+            dataStr.c_str(), ComparisonType::Equal);
+}
+
+template <>
+std::vector<MemAddress> FindData<AobPattern>(const Process& proc, const std::vector<MemRegion>& memRegions, 
+        const std::string& dataStr)
+{
+    const AobPattern pattern(dataStr);
+    return MemoryFuncs::FindDataInMemory<AobPattern>(proc.GetCurrentPid(), memRegions, pattern.GetSize(), 
+            &pattern, ComparisonType::Equal);
+}
+
+// The values are given as pairs of <type> <value>, and may have different types
+static void FindMultipleValues(const Process& proc, const std::vector<MemRegion>& memRegions, 
+        const std::vector<std::string>& args, size_t argIndex)
+{
+    if (args.size() < argIndex + 2 || (args.size() - argIndex) % 2 != 0)
+    {
+        throw std::runtime_error("Expected pairs of <type> <value>.");
+    }
+
+    std::vector<std::vector<uint8_t>> needles;
+    std::vector<std::string> needleStrs;
+    for (size_t i = argIndex; i < args.size(); i += 2)
+    {
+        needles.push_back(Utils::DataToByteVector(ParseDataType(args[i]), args[i + 1]));
+        needleStrs.push_back(fmt::format("{}: {}", args[i], args[i + 1]));
+    }
+
+    const MultiMatcher matcher(needles);
+    const std::vector<MemoryFuncs::NeedleMatch> matches = MemoryFuncs::FindNeedlesInMemory(proc.GetCurrentPid(), 
+            memRegions, matcher);
+
+    // Every match is tagged with the value that was found
+    const size_t indexWidth = std::to_string(matches.size()).size();
+    for (size_t i = 0; i < matches.size(); i++)
+    {
+        const MemAddress& memAddress = matches[i].memAddress;
+        fmt::print("[{:{}}] {:#018x} [{}] (in {}) [{}]\n", i, indexWidth, memAddress.address, 
+                memAddress.memRegion.permsStr, memAddress.memRegion.pathName, needleStrs[matches[i].needleIndex]);
+    }
+}
+
+// Every character of the filter is compared with the same character of the permissions of the
+// region, and '?' matches any permission
+static bool MatchesPermsFilter(const MemRegion& region, const std::string& permsFilter)
+{
+    for (size_t i = 0; i < permsFilter.size(); i++)
+    {
+        if (permsFilter[i] != '?' && (i >= region.permsStr.size() || permsFilter[i] != region.permsStr[i]))
+        {
+            return false;
+        }
+    }
+    return true;
 }
 
 void FindCommand::Main(Process& proc, const std::vector<std::string>& args)
 {
-    if (args.size() < 3)
+    // The options come before the type
+    std::string permsFilter;
+    std::string moduleFilter;
+    size_t argIndex = 1;
+    while (argIndex < args.size() && args[argIndex].starts_with("--"))
+    {
+        if (argIndex + 1 >= args.size())
+        {
+            throw std::runtime_error(fmt::format("Missing value for {}.", args[argIndex]));
+        }
+
+        if (args[argIndex] == "--perms")
+        {
+            permsFilter = args[argIndex + 1];
+        }
+        else if (args[argIndex] == "--module")
+        {
+            moduleFilter = args[argIndex + 1];
+        }
+        else
+        {
+            throw std::runtime_error("Invalid option.");
+        }
+        argIndex += 2;
+    }
+
+    if (args.size() < argIndex + 2)
     {
         throw std::runtime_error("Missing arguments.");
     }
 
+    std::vector<MemRegion> memRegions = proc.GetMemoryRegions();
+    std::erase_if(memRegions, [&](const MemRegion& region)
+    {
+        return !MatchesPermsFilter(region, permsFilter) 
+            || (!moduleFilter.empty() && region.pathName.find(moduleFilter) == std::string::npos);
+    });
+
+    if (args[argIndex] == "multi")
+    {
+        FindMultipleValues(proc, memRegions, args, argIndex + 1);
+        return;
+    }
+
     std::vector<MemAddress> foundAddrs;
-    const std::string& typeStr = args[1]; 
-    const std::string& dataStr = args[2];
+    const std::string& typeStr = args[argIndex]; 
+    const std::string& dataStr = args[argIndex + 1];
 
     switch (ParseDataType(typeStr))
     {
-        case DataType::int8:    foundAddrs = FindData<int8_t>(proc, dataStr);      break;
-        case DataType::int16:   foundAddrs = FindData<int16_t>(proc, dataStr);     break;
-        case DataType::int32:   foundAddrs = FindData<int32_t>(proc, dataStr);     break;
-        case DataType::int64:   foundAddrs = FindData<int64_t>(proc, dataStr);     break;
-        case DataType::uint8:   foundAddrs = FindData<uint8_t>(proc, dataStr);     break;
-        case DataType::uint16:  foundAddrs = FindData<uint16_t>(proc, dataStr);    break;
-        case DataType::uint32:  foundAddrs = FindData<uint32_t>(proc, dataStr);    break;
-        case DataType::uint64:  foundAddrs = FindData<uint64_t>(proc, dataStr);    break;
-        case DataType::f32:     foundAddrs = FindData<float>(proc, dataStr);       break;
-        case DataType::f64:     foundAddrs = FindData<double>(proc, dataStr);      break;
-        case DataType::string:  foundAddrs = FindData<std::string>(proc, dataStr); break;
+        case DataType::int8:    foundAddrs = FindData<int8_t>(proc, memRegions, dataStr);      break;
+        case DataType::int16:   foundAddrs = FindData<int16_t>(proc, memRegions, dataStr);     break;
+        case DataType::int32:   foundAddrs = FindData<int32_t>(proc, memRegions, dataStr);     break;
+        case DataType::int64:   foundAddrs = FindData<int64_t>(proc, memRegions, dataStr);     break;
+        case DataType::uint8:   foundAddrs = FindData<uint8_t>(proc, memRegions, dataStr);     break;
+        case DataType::uint16:  foundAddrs = FindData<uint16_t>(proc, memRegions, dataStr);    break;
+        case DataType::uint32:  foundAddrs = FindData<uint32_t>(proc, memRegions, dataStr);    break;
+        case DataType::uint64:  foundAddrs = FindData<uint64_t>(proc, memRegions, dataStr);    break;
+        case DataType::f32:     foundAddrs = FindData<float>(proc, memRegions, dataStr);       break;
+        case DataType::f64:     foundAddrs = FindData<double>(proc, memRegions, dataStr);      break;
+        case DataType::string:  foundAddrs = FindData<std::string>(proc, memRegions, dataStr); break;
+        case DataType::aob:     foundAddrs = FindData<AobPattern>(proc, memRegions, dataStr);  break;
+        case DataType::be_int16:  foundAddrs = FindData<BigEndian<int16_t>>(proc, memRegions, dataStr);  break;
+        case DataType::be_int32:  foundAddrs = FindData<BigEndian<int32_t>>(proc, memRegions, dataStr);  break;
+        case DataType::be_int64:  foundAddrs = FindData<BigEndian<int64_t>>(proc, memRegions, dataStr);  break;
+        case DataType::be_uint16: foundAddrs = FindData<BigEndian<uint16_t>>(proc, memRegions, dataStr); break;
+        case DataType::be_uint32: foundAddrs = FindData<BigEndian<uint32_t>>(proc, memRegions, dataStr); break;
+        case DataType::be_uint64: foundAddrs = FindData<BigEndian<uint64_t>>(proc, memRegions, dataStr); break;
+        case DataType::be_f32:    foundAddrs = FindData<BigEndian<float>>(proc, memRegions, dataStr);    break;
+        case DataType::be_f64:    foundAddrs = FindData<BigEndian<double>>(proc, memRegions, dataStr);   break;
         // No default: so that the compiler can generate a warning for us in case we forget something.
     }
 
@@ -59,16 +163,28 @@ void FindCommand::Main(Process& proc, const std::vector<std::string>& args)
 std::string FindCommand::Help()
 {
     return std::string(
-        "Usage: find <type> <data>\n\n"
+        "Usage: find [--perms <perms>] [--module <name>] <type> <data>\n"
+        "       find [--perms <perms>] [--module <name>] multi <type> <data> [<type> <data>...]\n\n"
 
-        "Lists the memory addresses where the given data was found.\n\n"
+        "Lists the memory addresses where the given data was found.\n"
+        "With 'multi', all the values are searched at once in a single pass over the memory, and every\n"
+        "address is listed with the value that was found there. The values may have different types,\n"
+        "byte patterns can't have wildcards.\n\n"
 
         "The <type> argument can be one of the following:\n"
-        "[u]int8, [u]int16, [u]int32, [u]int64, float, double, string\n"
-        "The 'u' prefix tells the program to use the unsigned type.\n\n"
+        "[u]int8, [u]int16, [u]int32, [u]int64, float, double, string, aob\n"
+        "The 'u' prefix tells the program to use the unsigned type.\n"
+        "The 'be' prefix makes the types other than [u]int8, string and aob big-endian, e.g. beuint32, befloat.\n\n"
 
         "Data for [u]int8, [u]int16, [u]int32, [u]int64 can be written as decimal numbers or hexadecimal numbers.\n"
         "Data for float and double can be written as floating point numbers or hexadecimal numbers.\n"
-        "Data for string can only be a string.\n");
+        "Data for string can only be a string.\n"
+        "Data for aob is a pattern of hex bytes where '?\?' matches any byte, e.g. \"48 8B 05 ?? ?? ?? ?? 89\".\n"
+            "\tA '?' in place of one digit matches any value of that digit.\n\n"
+
+        "Options:\n"
+        "--perms <perms> -- Only searches the regions with these permissions, as shown by the map command.\n"
+            "\t'?' matches any permission, e.g. 'r?x' searches the executable regions.\n"
+        "--module <name> -- Only searches the regions which have <name> in their pathname.\n");
 }
 
@@ -1,61 +1,162 @@
 #include "cmds/FreezeCommand.h"
 #include "MemoryFreezer.h"
+#include <cerrno>
+#include <cstring>
 #include <fmt/core.h>
+#include <fstream>
 #include <stdexcept>
 #include "Utils.h"
 #include "DataType.h"
 
-template <typename T>
-std::vector<uint8_t> DataToByteVector(const std::string& data)
+// Parses an interval such as 500us, 10ms or 2s into microseconds
+// "default" gives 0, which makes the address use the tick rate
+static uint32_t ParseIntervalUs(const std::string& intervalStr)
 {
-    constexpr size_t dataSize = sizeof(T);
-    // Convert the data to the correct type (for the correct binary representation)
-    T dataValue = Utils::StrToNumber<T>(data);
+    if (intervalStr == "default")
+    {
+        return 0;
+    }
 
-    // Get a pointer to the dataValue in memory
-    uint8_t* dataValueBytePtr = (uint8_t*)&dataValue;
+    const size_t unitPos = intervalStr.find_first_not_of("0123456789");
+    if (unitPos == std::string::npos || unitPos == 0)
+    {
+        throw std::invalid_argument("Invalid interval, a unit of us, ms or s is required.");
+    }
 
-    std::vector<uint8_t> byteVector;
-    // Construct the vector of bytes
-    byteVector.insert(byteVector.end(), &dataValueBytePtr[0], &dataValueBytePtr[dataSize]);
+    const std::string unitStr = intervalStr.substr(unitPos);
+    uint64_t multiplier;
+    if (unitStr == "us")
+    {
+        multiplier = 1;
+    }
+    else if (unitStr == "ms")
+    {
+        multiplier = 1000;
+    }
+    else if (unitStr == "s")
+    {
+        multiplier = 1000000;
+    }
+    else
+    {
+        throw std::invalid_argument("Invalid interval unit.");
+    }
 
-    return byteVector;
+    const uint64_t intervalUs = Utils::StrToNumber<uint64_t>(intervalStr.substr(0, unitPos), "interval") * multiplier;
+    if (intervalUs == 0 || intervalUs > UINT32_MAX)
+    {
+        throw std::runtime_error("The interval is out of range.");
+    }
+    return intervalUs;
 }
 
-template <>
-std::vector<uint8_t> DataToByteVector<std::string>(const std::string& data)
+static std::string FormatIntervalUs(uint32_t intervalUs)
 {
-    return std::vector<uint8_t>(data.begin(), data.end());
+    if (intervalUs % 1000000 == 0)
+    {
+        return fmt::format("{}s", intervalUs / 1000000);
+    }
+    else if (intervalUs % 1000 == 0)
+    {
+        return fmt::format("{}ms", intervalUs / 1000);
+    }
+    return fmt::format("{}us", intervalUs);
 }
 
-static void ListFrozenMemoryAddresses(const std::list<FrozenMemAddress>& frozenAddrs)
+// The snapshot doesn't change while it is printed, and the list can change meanwhile without waiting
+static void ListFrozenMemoryAddresses(const FreezeListSnapshot& snapshot)
 {
-    if (frozenAddrs.size() == 0)
+    const std::vector<FrozenEntry>& entries = *snapshot.entries;
+    const auto& entryInfo = *snapshot.entryInfo;
+
+    // The rows of removed entries are skipped, the indices of the other entries stay the same
+    const size_t indexWidth = std::to_string(entries.size()).size();
+    size_t listed = 0;
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        const FrozenEntry& entry = entries[i];
+        if (!entry.used)
+        {
+            continue;
+        }
+        const FrozenEntryInfo& info = *entryInfo[i];
+        listed++;
+        const EntryControl& control = snapshot.GetControl(entry);
+        const FreezeMode mode = control.mode;
+        const uint32_t intervalUs = control.intervalUs;
+
+        fmt::print("[{:{}}][{}] {:#018x} (in {}) [{}: {}]",
+            i, indexWidth,
+            control.enabled ? 'X' : ' ', // If the address is enabled, mark it with an X
+            entry.address,
+            info.pathName,
+            info.typeStr,
+            info.dataStr);
+
+        if (mode != FreezeMode::Set)
+        {
+            fmt::print(" Mode: {}", FreezeModeToString(mode));
+        }
+        if (intervalUs != 0)
+        {
+            fmt::print(" Interval: {}", FormatIntervalUs(intervalUs));
+        }
+        if (!info.note.empty())
+        {
+            fmt::print(" Note: \"{}\"", info.note);
+        }
+
+        fmt::print("\n");
+    }
+
+    if (listed == 0)
     {
         fmt::print("No memory addresses to list.\n");
-        return;
     }
+}
 
-    const size_t indexWidth = std::to_string(frozenAddrs.size()).size();
-    int index = 0;
-    for (auto it = frozenAddrs.cbegin(); it != frozenAddrs.cend(); it++)
+// Every line holds the address, whether it is enabled (1/0), the type, the data, the mode, the
+// interval in microseconds (0 for the tick rate), the pathname and the note, separated by tabs
+// Like the listing, it is written from a snapshot so the list isn't locked while the file is written
+static size_t ExportFrozenMemoryAddresses(const FreezeListSnapshot& snapshot, const std::string& path)
+{
+    std::ofstream file(path);
+    if (!file.is_open())
     {
-        fmt::print("[{:{}}][{}] {:#018x} (in {}) [{}: {}]",
-            index, indexWidth,
-            it->enabled ? 'X' : ' ', // If the address is enabled, mark it with an X
-            it->memAddress.address,
-            it->memAddress.memRegion.pathName,
-            it->typeStr,
-            it->dataStr);
-            
-        if (!it->note.empty())
+        const std::string err = fmt::format("Failed to open file '{}': {}.", path, std::strerror(errno));
+        throw std::runtime_error(err);
+    }
+
+    const std::vector<FrozenEntry>& entries = *snapshot.entries;
+    const auto& entryInfo = *snapshot.entryInfo;
+    size_t amount = 0;
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        const FrozenEntry& entry = entries[i];
+        if (!entry.used)
         {
-            fmt::print(" Note: \"{}\"", it->note);
+            continue;
         }
+        const FrozenEntryInfo& info = *entryInfo[i];
+        const EntryControl& control = snapshot.GetControl(entry);
 
-        fmt::print("\n");
-        index++;
+        file << fmt::format("{:#x}\t{}\t{}\t{}\t{}\t{}\t{}\t{}\n",
+            entry.address,
+            control.enabled ? 1 : 0,
+            info.typeStr,
+            info.dataStr,
+            FreezeModeToString(control.mode),
+            control.intervalUs.load(),
+            info.pathName,
+            info.note);
+        amount++;
+    }
+
+    if (!file.flush())
+    {
+        throw std::runtime_error(fmt::format("Failed to write to file '{}'.", path));
     }
+    return amount;
 }
 
 void FreezeCommand::Main(Process& proc, const std::vector<std::string>& args)
@@ -70,8 +171,41 @@ void FreezeCommand::Main(Process& proc, const std::vector<std::string>& args)
     const std::string& keywordStr = args[1];
     if (keywordStr == "list")
     {
-        const std::list<FrozenMemAddress>& frozenAddrs = memFreezer.GetFrozenAddresses();
-        ListFrozenMemoryAddresses(frozenAddrs);
+        ListFrozenMemoryAddresses(*memFreezer.GetSnapshot());
+    }
+    else if (keywordStr == "rate")
+    {
+        // Print the current rate if no new rate was given
+        if (args.size() < 3)
+        {
+            fmt::print("Tick rate: {} ticks per second.\n", memFreezer.GetTickRate());
+        }
+        else
+        {
+            memFreezer.SetTickRate(Utils::StrToNumber<unsigned int>(args[2], "rate"));
+        }
+    }
+    else if (keywordStr == "threads")
+    {
+        // Print the current amount if no new amount was given
+        if (args.size() < 3)
+        {
+            fmt::print("Freezing with {} threads.\n", memFreezer.GetShardCount());
+        }
+        else
+        {
+            memFreezer.SetShardCount(Utils::StrToNumber<unsigned int>(args[2], "amount of threads"));
+        }
+    }
+    else if (keywordStr == "export")
+    {
+        if (args.size() < 3)
+        {
+            throw std::runtime_error("Missing arguments.");
+        }
+
+        const size_t amount = ExportFrozenMemoryAddresses(*memFreezer.GetSnapshot(), args[2]);
+        fmt::print("Exported {} addresses to '{}'.\n", amount, args[2]);
     }
     // Keywords that require 1 arg
     else if (keywordStr == "remove" || keywordStr == "enable" || keywordStr == "disable")
@@ -127,6 +261,40 @@ void FreezeCommand::Main(Process& proc, const std::vector<std::string>& args)
             }
         }
     }
+    else if (keywordStr == "mode")
+    {
+        if (args.size() < 4)
+        {
+            throw std::runtime_error("Missing arguments.");
+        }
+
+        const FreezeMode mode = ParseFreezeMode(args[3]);
+        if (args[2] == "all")
+        {
+            memFreezer.SetAllAddressesMode(mode);
+        }
+        else
+        {
+            memFreezer.SetAddressMode(Utils::StrToNumber<size_t>(args[2], "index"), mode);
+        }
+    }
+    else if (keywordStr == "interval")
+    {
+        if (args.size() < 4)
+        {
+            throw std::runtime_error("Missing arguments.");
+        }
+
+        const uint32_t intervalUs = ParseIntervalUs(args[3]);
+        if (args[2] == "all")
+        {
+            memFreezer.SetAllAddressesInterval(intervalUs);
+        }
+        else
+        {
+            memFreezer.SetAddressInterval(Utils::StrToNumber<size_t>(args[2], "index"), intervalUs);
+        }
+    }
     // This keyword requires 3 args
     else if (keywordStr == "add" || keywordStr == "modify")
     {
@@ -145,22 +313,7 @@ void FreezeCommand::Main(Process& proc, const std::vector<std::string>& args)
 
         const std::string& typeStr = args[3];
         const std::string& dataStr = args[4];
-        std::vector<uint8_t> byteVector;
-
-        switch (ParseDataType(typeStr))
-        {
-            case DataType::int8:   byteVector = DataToByteVector<int8_t>(dataStr);      break;
-            case DataType::int16:  byteVector = DataToByteVector<int16_t>(dataStr);     break;
-            case DataType::int32:  byteVector = DataToByteVector<int32_t>(dataStr);     break;
-            case DataType::int64:  byteVector = DataToByteVector<int64_t>(dataStr);     break;
-            case DataType::uint8:  byteVector = DataToByteVector<uint8_t>(dataStr);     break;
-            case DataType::uint16: byteVector = DataToByteVector<uint16_t>(dataStr);    break;
-            case DataType::uint32: byteVector = DataToByteVector<uint32_t>(dataStr);    break;
-            case DataType::uint64: byteVector = DataToByteVector<uint64_t>(dataStr);    break;
-            case DataType::f32:    byteVector = DataToByteVector<float>(dataStr);       break;
-            case DataType::f64:    byteVector = DataToByteVector<double>(dataStr);      break;
-            case DataType::string: byteVector = DataToByteVector<std::string>(dataStr); break;
-        }
+        std::vector<uint8_t> byteVector = Utils::DataToByteVector(ParseDataType(typeStr), dataStr);
 
         if (keywordStr == "add")
         {
@@ -198,13 +351,35 @@ std::string FreezeCommand::Help()
 
         "Keywords with no args required:\n"
         "list -- Lists the frozen memory addresses in the following format:\n"
-            "\t[index][enabled/disabled] [address] [pathname] [type] [data]\n\n"
+            "\t[index][enabled/disabled] [address] [pathname] [type] [data]\n"
+        "rate [ticks] -- Sets how many times per second the enabled addresses are written, or prints it.\n"
+            "\tThis is the default for addresses that don't have an interval of their own.\n"
+        "threads [amount] -- Sets the amount of threads which freeze the addresses, or prints it.\n"
+            "\tThe addresses are split evenly between the threads by address range.\n\n"
 
         "Keywords that require 1 argument:\n"
+        "export <file> -- Writes the frozen memory addresses to a file, one per line with the fields separated by tabs:\n"
+            "\t[address] [enabled (1/0)] [type] [data] [mode] [interval in us, 0 for the tick rate] [pathname] [note]\n"
         "remove <index/all> -- Removes the address in the given index, or removes all addresses.\n"
+            "\tThe indices of the other addresses don't change, the next added address takes the free index.\n"
         "enable <index/all> -- Enables the program to freeze the address in the given index, or all addresses.\n"
         "disable <index/all> -- Disables the program from freezing the address in the given index, or all addresses.\n\n"
 
+        "Keywords that require 2 arguments:\n"
+        "mode <index/all> <mode> -- Sets when the data is written to the address in the given index, or to all addresses.\n"
+            "\tset -- Always write the data. This is the mode of newly added addresses.\n"
+            "\tchanged -- Write the data only if the value in memory is different.\n"
+            "\tmin -- Write the data only if the value in memory is less than it.\n"
+            "\tmax -- Write the data only if the value in memory is greater than it.\n"
+            "\tincrease -- Let the value in memory only increase, decreases are reverted.\n"
+            "\tdecrease -- Let the value in memory only decrease, increases are reverted.\n"
+            "\tAll modes except set read the current values first, only set and changed can be used with strings\n"
+            "\tand byte patterns.\n"
+        "interval <index/all> <interval> -- Sets how often the address in the given index, or all addresses, are written.\n"
+            "\tThe interval is a number with a unit of us, ms or s (e.g. 500us, 10ms, 1s).\n"
+            "\tAn interval of 'default' makes the address follow the tick rate.\n"
+            "\tAddresses which are due at the same time are written together.\n\n"
+
         "Keywords that require 3 arguments:\n"
         "add <address> <type> <data> [note] -- Adds the address to the freezing list which will write <data> to <address> continuously.\n"
             "\tWhen addresses are added, they are disabled and have to be enabled manually.\n"
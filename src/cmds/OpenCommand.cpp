@@ -0,0 +1,33 @@
+#include "cmds/OpenCommand.h"
+#include <stdexcept>
+#include <fmt/core.h>
+#include "OfflineTarget.h"
+
+void OpenCommand::Main(Process& proc, const std::vector<std::string>& args)
+{
+    if (args.size() < 2)
+    {
+        throw std::runtime_error("Missing arguments.");
+    }
+
+    proc.OpenOfflineTarget(args[1]);
+
+    std::shared_ptr<OfflineTarget> target = OfflineTarget::Find(proc.GetCurrentPid());
+    fmt::print("Offline target '{}': {}\n"
+               "Loaded {} memory regions.\n", target->GetPath(), target->GetDescription(), 
+               target->GetMemoryRegions().size());
+}
+
+std::string OpenCommand::Help()
+{
+    return std::string(
+        "Usage: open <file>\n\n"
+
+        "Uses a snapshot file (see command `snapshot`) or an ELF core file (such as one made by gcore)\n"
+        "in place of a process. All the other commands work on it the same way as on a process.\n\n"
+
+        "The file is mapped into memory, so it is scanned in place without reading it.\n"
+        "Writes only change the memory of this program, the file is never modified.\n"
+        "Use the command `pid` to go back to a live process.\n");
+}
+
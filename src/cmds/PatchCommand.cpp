@@ -0,0 +1,150 @@
+#include "cmds/PatchCommand.h"
+#include "PatchManager.h"
+#include <fmt/core.h>
+#include <stdexcept>
+
+static void ListPatchSets(const PatchManager& patchManager)
+{
+    const std::map<std::string, PatchSet>& patchSets = patchManager.GetPatchSets();
+    if (patchSets.empty())
+    {
+        fmt::print("No patch sets to list.\n");
+        return;
+    }
+
+    for (const auto& [name, patchSet] : patchSets)
+    {
+        fmt::print("{} ({} entries, from '{}'){}\n", name, patchSet.entries.size(), patchSet.path,
+                patchSet.hasBackup ? " [applied, can be rolled back]" : "");
+    }
+}
+
+static void ListPatchSetEntries(const PatchSet& patchSet)
+{
+    const size_t indexWidth = std::to_string(patchSet.entries.size()).size();
+    for (size_t i = 0; i < patchSet.entries.size(); i++)
+    {
+        const PatchEntry& entry = patchSet.entries[i];
+        fmt::print("[{:{}}] {:#018x} [{}: {}]\n", i, indexWidth, entry.address, entry.typeStr, entry.dataStr);
+    }
+}
+
+static void PrintPatchResult(const PatchResult& result, const char* action)
+{
+    for (const std::string& error : result.errors)
+    {
+        fmt::print(stderr, "{}\n", error);
+    }
+
+    const double stopUs = std::chrono::duration<double, std::micro>(result.stopDuration).count();
+    if (result.restored)
+    {
+        fmt::print("{}/{} entries failed, the entries that were written have been restored. "
+                "(process stopped for {:.1f}us)\n", result.total - result.written, result.total, stopUs);
+    }
+    else
+    {
+        fmt::print("{} {}/{} entries. (process stopped for {:.1f}us)\n", action, result.written, result.total, stopUs);
+    }
+}
+
+void PatchCommand::Main(Process& proc, const std::vector<std::string>& args)
+{
+    if (args.size() < 2)
+    {
+        throw std::runtime_error("Missing keyword argument.");
+    }
+
+    PatchManager& patchManager = proc.GetPatchManager();
+    const std::string& keywordStr = args[1];
+    if (keywordStr == "list")
+    {
+        if (args.size() < 3)
+        {
+            ListPatchSets(patchManager);
+        }
+        else
+        {
+            ListPatchSetEntries(patchManager.GetPatchSet(args[2]));
+        }
+    }
+    else if (keywordStr == "load")
+    {
+        if (args.size() < 4)
+        {
+            throw std::runtime_error("Missing arguments.");
+        }
+
+        patchManager.LoadPatchSet(args[2], args[3]);
+        fmt::print("Loaded {} entries into patch set '{}'.\n", patchManager.GetPatchSet(args[2]).entries.size(), args[2]);
+    }
+    else if (keywordStr == "remove")
+    {
+        if (args.size() < 3)
+        {
+            throw std::runtime_error("Missing arguments.");
+        }
+
+        if (args[2] == "all")
+        {
+            patchManager.RemoveAllPatchSets();
+        }
+        else
+        {
+            patchManager.RemovePatchSet(args[2]);
+        }
+    }
+    else if (keywordStr == "apply")
+    {
+        if (args.size() < 3)
+        {
+            throw std::runtime_error("Missing arguments.");
+        }
+
+        bool saveBackup = true;
+        if (args.size() > 3)
+        {
+            if (args[3] != "nobackup")
+            {
+                throw std::runtime_error("Invalid option.");
+            }
+            saveBackup = false;
+        }
+        PrintPatchResult(patchManager.ApplyPatchSet(args[2], saveBackup), "Applied");
+    }
+    else if (keywordStr == "rollback")
+    {
+        if (args.size() < 3)
+        {
+            throw std::runtime_error("Missing arguments.");
+        }
+
+        PrintPatchResult(patchManager.RollbackPatchSet(args[2]), "Rolled back");
+    }
+    else
+    {
+        throw std::runtime_error("Invalid keyword.");
+    }
+}
+
+std::string PatchCommand::Help()
+{
+    return std::string(
+        "Usage: patch <keyword> [args...]\n\n"
+
+        "Applies sets of writes to the memory of the process all at once.\n"
+        "The threads of the process are stopped while the patch set is written, so the process never sees\n"
+        "it partially applied. The time that the process was stopped for is printed.\n\n"
+
+        "Keywords:\n"
+        "list [name] -- Lists the loaded patch sets, or the entries of the given patch set.\n"
+        "load <name> <file> -- Loads a patch set from a file, replacing a patch set with the same name.\n"
+            "\tEach line of the file is an entry in the format: <address> <type> <value>\n"
+            "\tThe types are the same as in the write command. Empty lines and lines starting with '#' are ignored.\n"
+        "remove <name/all> -- Removes the given patch set, or all patch sets.\n"
+        "apply <name> [nobackup] -- Writes all the entries of the patch set.\n"
+            "\tThe old bytes are saved first, so if any entry fails the other entries are restored,\n"
+            "\tand the patch set can be rolled back later. 'nobackup' skips saving them.\n"
+        "rollback <name> -- Writes back the bytes which were saved by the last apply of the patch set.\n");
+}
+
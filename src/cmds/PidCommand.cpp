@@ -3,6 +3,7 @@
 #include <string>
 #include <fmt/core.h>
 #include "Utils.h"
+#include "OfflineTarget.h"
 
 void PidCommand::Main(Process& proc, const std::vector<std::string>& args)
 {
@@ -23,6 +24,11 @@ void PidCommand::Main(Process& proc, const std::vector<std::string>& args)
         {
             fmt::print("Currently not attached to any process.\n");
         }
+        else if (OfflineTarget::IsOfflineId(currPid))
+        {
+            std::shared_ptr<OfflineTarget> target = OfflineTarget::Find(currPid);
+            fmt::print("Offline target '{}': {}\n", target->GetPath(), target->GetDescription());
+        }
         else
         {
             std::string procCmd = Utils::GetProcessCommand(currPid);
@@ -0,0 +1,201 @@
+#include "cmds/PointerCommand.h"
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <fmt/core.h>
+#include "PointerScanner.h"
+#include "Utils.h"
+
+constexpr unsigned int MAX_POINTER_DEPTH = 16;
+constexpr unsigned int MAX_POINTER_THREADS = 64;
+
+static std::string FormatPointerChain(const PointerChain& chain)
+{
+    // Only the file name of the module is shown, the full path is in the saved chains
+    const size_t nameStart = chain.modulePath.rfind('/') + 1;
+    std::string str = fmt::format("[{}+{:#x}]", chain.modulePath.substr(nameStart), chain.moduleOffset);
+    for (unsigned long offset : chain.offsets)
+    {
+        str += fmt::format(" -> +{:#x}", offset);
+    }
+    return str;
+}
+
+static void ListPointerChains(Process& proc, size_t amount)
+{
+    const PointerScanner& pointerScanner = proc.GetPointerScanner();
+    const std::vector<PointerChain>& chains = pointerScanner.GetChains();
+    if (chains.empty())
+    {
+        fmt::print("No pointer chains to list.\n");
+        return;
+    }
+
+    const std::vector<unsigned long> addresses = pointerScanner.Resolve(proc.GetMemoryRegions());
+    amount = std::min(amount, chains.size());
+    const size_t indexWidth = std::to_string(amount).size();
+    for (size_t i = 0; i < amount; i++)
+    {
+        if (addresses[i] != 0)
+        {
+            fmt::print("[{:{}}] {} = {:#018x}\n", i, indexWidth, FormatPointerChain(chains[i]), addresses[i]);
+        }
+        else
+        {
+            fmt::print("[{:{}}] {} = invalid\n", i, indexWidth, FormatPointerChain(chains[i]));
+        }
+    }
+    if (amount < chains.size())
+    {
+        fmt::print("... and {} more chains.\n", chains.size() - amount);
+    }
+}
+
+static void ScanPointers(Process& proc, const std::vector<std::string>& args)
+{
+    if (args.size() < 5)
+    {
+        throw std::runtime_error("Missing arguments.");
+    }
+
+    const unsigned long target = Utils::StrToNumber<unsigned long>(args[2], "address");
+    const unsigned int maxDepth = Utils::StrToNumber<unsigned int>(args[3], "depth");
+    const unsigned long maxOffset = Utils::StrToNumber<unsigned long>(args[4], "offset");
+    if (maxDepth == 0 || maxDepth > MAX_POINTER_DEPTH)
+    {
+        throw std::runtime_error(fmt::format("The depth must be between 1 and {}.", MAX_POINTER_DEPTH));
+    }
+
+    unsigned int threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    if (args.size() > 5)
+    {
+        threadCount = Utils::StrToNumber<unsigned int>(args[5], "thread amount");
+        if (threadCount == 0 || threadCount > MAX_POINTER_THREADS)
+        {
+            throw std::runtime_error(fmt::format("The amount of threads must be between 1 and {}.", MAX_POINTER_THREADS));
+        }
+    }
+
+    // The pointer index is rebuilt from the current memory, and kept for the refs command
+    const std::vector<MemRegion> memRegions = proc.GetMemoryRegions();
+    PointerIndex& pointerIndex = proc.GetPointerIndex();
+    const auto start = std::chrono::steady_clock::now();
+    pointerIndex.Build(proc.GetCurrentPid(), memRegions, threadCount, pointerIndex.IsCompact());
+    const PointerScanStats stats = proc.GetPointerScanner().Scan(pointerIndex, memRegions, target, maxDepth, 
+            maxOffset, threadCount);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    fmt::print("Found {} pointer chains to {:#018x} among {} pointers in {:.2f}s.\n", 
+            stats.chainsFound, target, pointerIndex.GetSize(), seconds);
+    if (stats.truncated)
+    {
+        fmt::print("WARNING: The search was cut short by the limits, try a smaller depth or offset.\n");
+    }
+}
+
+static void ValidatePointerChains(Process& proc, const std::vector<std::string>& args)
+{
+    if (args.size() < 3)
+    {
+        throw std::runtime_error("Missing arguments.");
+    }
+
+    PointerScanner& pointerScanner = proc.GetPointerScanner();
+    const size_t previousAmount = pointerScanner.GetChains().size();
+    size_t keptAmount = 0;
+    if (args.size() == 3)
+    {
+        const unsigned long target = Utils::StrToNumber<unsigned long>(args[2], "address");
+        keptAmount = pointerScanner.Validate(proc.GetMemoryRegions(), target);
+    }
+    else
+    {
+        // Strings may contain spaces, so the value is the rest of the arguments
+        const std::string dataStr = Utils::JoinVectorOfStrings(args, 3, ' ');
+        const std::vector<uint8_t> data = Utils::DataToByteVector(ParseDataType(args[2]), dataStr);
+        keptAmount = pointerScanner.ValidateData(proc.GetMemoryRegions(), data);
+    }
+    fmt::print("{}/{} pointer chains are still valid.\n", keptAmount, previousAmount);
+}
+
+void PointerCommand::Main(Process& proc, const std::vector<std::string>& args)
+{
+    if (args.size() < 2)
+    {
+        throw std::runtime_error("Missing keyword argument.");
+    }
+
+    PointerScanner& pointerScanner = proc.GetPointerScanner();
+    const std::string& keywordStr = args[1];
+    if (keywordStr == "scan")
+    {
+        ScanPointers(proc, args);
+    }
+    else if (keywordStr == "list")
+    {
+        size_t amount = pointerScanner.GetChains().size();
+        if (args.size() > 2)
+        {
+            amount = Utils::StrToNumber<size_t>(args[2], "amount");
+        }
+        ListPointerChains(proc, amount);
+    }
+    else if (keywordStr == "validate")
+    {
+        ValidatePointerChains(proc, args);
+    }
+    else if (keywordStr == "save")
+    {
+        if (args.size() < 3)
+        {
+            throw std::runtime_error("Missing arguments.");
+        }
+
+        pointerScanner.Save(args[2]);
+        fmt::print("Saved {} pointer chains to '{}'.\n", pointerScanner.GetChains().size(), args[2]);
+    }
+    else if (keywordStr == "load")
+    {
+        if (args.size() < 3)
+        {
+            throw std::runtime_error("Missing arguments.");
+        }
+
+        pointerScanner.Load(args[2]);
+        fmt::print("Loaded {} pointer chains from '{}'.\n", pointerScanner.GetChains().size(), args[2]);
+    }
+    else if (keywordStr == "clear")
+    {
+        pointerScanner.Clear();
+    }
+    else
+    {
+        throw std::runtime_error("Invalid keyword.");
+    }
+}
+
+std::string PointerCommand::Help()
+{
+    return std::string(
+        "Usage: pointer <keyword> [args...]\n\n"
+
+        "Finds chains of pointers which lead to an address and start at a static address in a module,\n"
+        "written as [module+offset] -> +offset ... The static addresses don't change between runs of the\n"
+        "process, so the chains can be saved and followed again to find the address after a restart.\n\n"
+
+        "Keywords:\n"
+        "scan <address> <depth> <max offset> [threads] -- Finds the chains of up to <depth> pointers to the address,\n"
+            "\twhere every pointer points up to <max offset> bytes before the next address.\n"
+            "\tThe chains start in the writable regions of the modules and the anonymous regions right after them.\n"
+            "\tThe pointers are indexed in parallel first, by default with a thread for every CPU core,\n"
+            "\tand the index is kept for the refs command.\n"
+        "list [amount] -- Lists the chains along with the addresses they currently lead to.\n"
+        "validate <address> -- Removes the chains which don't lead to the address anymore.\n"
+        "validate <type> <value> -- Removes the chains which don't lead to the given value.\n"
+            "\tThe types are the same as in the write command.\n"
+        "save <file> -- Saves the chains to a file.\n"
+        "load <file> -- Loads the chains from a file, replacing the current chains.\n"
+        "clear -- Removes all the chains.\n\n"
+
+        "The chains are kept when the pid changes, so that they can be validated against the new process.\n");
+}
@@ -0,0 +1,143 @@
+#include "cmds/RefsCommand.h"
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <fmt/core.h>
+#include "PointerIndex.h"
+#include "Utils.h"
+
+constexpr unsigned int MAX_INDEX_THREADS = 64;
+constexpr size_t DEFAULT_MAX_REFS = 1000;
+
+static void BuildPointerIndex(Process& proc, const std::vector<std::string>& args)
+{
+    bool compact = false;
+    size_t argIndex = 2;
+    if (args.size() > argIndex && args[argIndex] == "--compact")
+    {
+        compact = true;
+        argIndex++;
+    }
+
+    unsigned int threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    if (args.size() > argIndex)
+    {
+        threadCount = Utils::StrToNumber<unsigned int>(args[argIndex], "thread amount");
+        if (threadCount == 0 || threadCount > MAX_INDEX_THREADS)
+        {
+            throw std::runtime_error(fmt::format("The amount of threads must be between 1 and {}.", MAX_INDEX_THREADS));
+        }
+    }
+
+    PointerIndex& pointerIndex = proc.GetPointerIndex();
+    const auto start = std::chrono::steady_clock::now();
+    pointerIndex.Build(proc.GetCurrentPid(), proc.GetMemoryRegions(), threadCount, compact);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    fmt::print("Indexed {} pointers in {:.2f}s, the index takes {} bytes.\n", pointerIndex.GetSize(), 
+            seconds, pointerIndex.GetMemoryUsage());
+}
+
+static void FindReferences(Process& proc, const std::vector<std::string>& args)
+{
+    if (args.size() < 3)
+    {
+        throw std::runtime_error("Missing arguments.");
+    }
+
+    const PointerIndex& pointerIndex = proc.GetPointerIndex();
+    if (!pointerIndex.IsBuilt())
+    {
+        throw std::runtime_error("The pointer index has not been built. (see `refs build`)");
+    }
+
+    const unsigned long address = Utils::StrToNumber<unsigned long>(args[2], "address");
+    unsigned long maxOffset = 0;
+    if (args.size() > 3)
+    {
+        maxOffset = Utils::StrToNumber<unsigned long>(args[3], "offset");
+    }
+    size_t maxResults = DEFAULT_MAX_REFS;
+    if (args.size() > 4)
+    {
+        maxResults = Utils::StrToNumber<size_t>(args[4], "amount");
+    }
+
+    const unsigned long lowest = address > maxOffset ? address - maxOffset : 0;
+    const auto start = std::chrono::steady_clock::now();
+    const std::vector<PointerEntry> refs = pointerIndex.FindInRange(lowest, address, maxResults);
+    const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    const std::vector<MemRegion> memRegions = proc.GetMemoryRegions();
+    for (const PointerEntry& ref : refs)
+    {
+        std::string pathName = "unmapped";
+        try
+        {
+            pathName = Utils::FindRegionOfAddress(memRegions, ref.location).pathName;
+        }
+        catch (const std::exception&) {}
+
+        fmt::print("{:#018x} -> {:#018x} +{:#x} [{}]\n", ref.location, ref.value, address - ref.value, pathName);
+    }
+    fmt::print("Found {} references in {:.1f}us.{}\n", refs.size(), us, 
+            refs.size() == maxResults ? " (limited, more may exist)" : "");
+}
+
+void RefsCommand::Main(Process& proc, const std::vector<std::string>& args)
+{
+    if (args.size() < 2)
+    {
+        throw std::runtime_error("Missing keyword argument.");
+    }
+
+    PointerIndex& pointerIndex = proc.GetPointerIndex();
+    const std::string& keywordStr = args[1];
+    if (keywordStr == "build")
+    {
+        BuildPointerIndex(proc, args);
+    }
+    else if (keywordStr == "find")
+    {
+        FindReferences(proc, args);
+    }
+    else if (keywordStr == "info")
+    {
+        if (!pointerIndex.IsBuilt())
+        {
+            fmt::print("The pointer index has not been built.\n");
+            return;
+        }
+        fmt::print("{} pointers of pid {}, {} bytes{}.\n", pointerIndex.GetSize(), pointerIndex.GetPid(), 
+                pointerIndex.GetMemoryUsage(), pointerIndex.IsCompact() ? " (compact)" : "");
+    }
+    else if (keywordStr == "clear")
+    {
+        pointerIndex.Clear();
+    }
+    else
+    {
+        throw std::runtime_error("Invalid keyword.");
+    }
+}
+
+std::string RefsCommand::Help()
+{
+    return std::string(
+        "Usage: refs <keyword> [args...]\n\n"
+
+        "Finds the memory which holds pointers to an address, using an index of all the pointers in the process.\n"
+        "The index is built once and is then queried without reading the memory again, so it has to be\n"
+        "rebuilt when the pointers of the process change. It is also rebuilt by `pointer scan`.\n\n"
+
+        "Keywords:\n"
+        "build [--compact] [threads] -- Indexes every aligned 8 byte value in the readable writable regions\n"
+            "\twhich points into a mapped region. The memory is read in parallel, by default with a thread\n"
+            "\tfor every CPU core. --compact stores the values as deltas, which makes the index smaller\n"
+            "\tand the queries slightly slower.\n"
+        "find <address> [max offset] [amount] -- Lists the locations which point to the address, or up to\n"
+            "\t<max offset> bytes before it, along with the offset from the pointer to the address.\n"
+            "\tAt most <amount> locations are listed, 1000 by default.\n"
+        "info -- Shows the size of the index.\n"
+        "clear -- Frees the index.\n");
+}
@@ -1,13 +1,19 @@
 #include "cmds/ScanCommand.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <concepts>
 #include <cstdint>
+#include <limits>
 #include <fmt/core.h>
 #include <stdexcept>
 #include <string>
 #include "Utils.h"
 #include "DataType.h"
 #include "ComparisonType.h"
-#include "cmds/WriteCommand.h"
-#include "cmds/FreezeCommand.h"
+#include "MemoryFuncs.h"
+#include "MemoryFreezer.h"
+#include "FilterExpression.h"
 
 template <typename T>
 size_t CallScanner(Process& proc, size_t dataSize, const void* data, ComparisonType cmpType)
@@ -25,49 +31,401 @@ size_t CallScanner(Process& proc, size_t dataSize, const void* data, ComparisonT
     } 
 }
 
+// Returns the amount of decimals written in a number, which sets the precision of the rounded values
+static int CountDecimals(const std::string& dataStr)
+{
+    if (dataStr.find_first_of("xXeE") != std::string::npos)
+    {
+        throw std::invalid_argument("The value must be written in decimal without an exponent.");
+    }
+
+    const size_t pointPos = dataStr.find('.');
+    if (pointPos == std::string::npos)
+    {
+        return 0;
+    }
+    return dataStr.size() - pointPos - 1;
+}
+
+// Converts a bound to the closest value of T which is still inside the range
+template <std::floating_point T>
+T ToInnerBound(long double bound, bool isLow, bool isExclusive)
+{
+    T value = (T)bound;
+    if (isLow && ((long double)value < bound || (isExclusive && (long double)value == bound)))
+    {
+        value = std::nextafter(value, std::numeric_limits<T>::infinity());
+    }
+    else if (!isLow && ((long double)value > bound || (isExclusive && (long double)value == bound)))
+    {
+        value = std::nextafter(value, -std::numeric_limits<T>::infinity());
+    }
+    return value;
+}
+
+// Moves a float by the given amount of representable values, stopping at the infinities
+template <std::floating_point T>
+T StepUlps(T value, uint64_t ulps, bool down)
+{
+    using S = std::conditional_t<sizeof(T) == 4, int32_t, int64_t>;
+    using U = std::make_unsigned_t<S>;
+
+    // Maps the bits to integers which are ordered like the floats, with both zeros mapped to 0
+    auto toOrdered = [](S bits) { return bits >= 0 ? bits : (S)((U)std::numeric_limits<S>::min() - (U)bits); };
+    const S ordered = toOrdered(std::bit_cast<S>(value));
+    const S inf = std::bit_cast<S>(std::numeric_limits<T>::infinity());
+
+    const U limit = down ? (U)ordered + (U)inf : (U)inf - (U)ordered;
+    const U steps = (U)std::min<uint64_t>(ulps, limit);
+    // The mapping is its own inverse
+    return std::bit_cast<T>(toOrdered((S)(down ? (U)ordered - steps : (U)ordered + steps)));
+}
+
+// Turns a tolerance comparison into the range of values it accepts, range[0] holds the value
+template <std::floating_point T>
+void ToleranceToRange(ComparisonType cmpType, const std::string& dataStr, const std::string& toleranceStr,
+        T range[2])
+{
+    const T value = range[0];
+    if (std::isnan(value))
+    {
+        throw std::invalid_argument("The value of a tolerance can't be NaN.");
+    }
+
+    if (cmpType == ComparisonType::Approximate)
+    {
+        // Without an epsilon, the values within one unit of the last written decimal are accepted
+        const T epsilon = toleranceStr.empty() ? (T)std::pow(10.0L, -CountDecimals(dataStr)) :
+            Utils::StrToNumber<T>(toleranceStr, "epsilon");
+        if (!(epsilon >= 0))
+        {
+            throw std::invalid_argument("The epsilon can't be negative.");
+        }
+        range[0] = value - epsilon;
+        range[1] = value + epsilon;
+    }
+    else if (cmpType == ComparisonType::Ulps)
+    {
+        const uint64_t ulps = Utils::StrToNumber<uint64_t>(toleranceStr, "ULP distance");
+        range[0] = StepUlps(value, ulps, true);
+        range[1] = StepUlps(value, ulps, false);
+    }
+    else
+    {
+        // The bounds are calculated from the written value, since the value in T is already rounded
+        const long double exactValue = Utils::StrToNumber<long double>(dataStr);
+        const long double unit = std::pow(10.0L, -CountDecimals(dataStr));
+        if (cmpType == ComparisonType::Rounded)
+        {
+            // The values which round to the written value, halfway values are rounded up
+            range[0] = ToInnerBound<T>(exactValue - unit / 2, true, false);
+            range[1] = ToInnerBound<T>(exactValue + unit / 2, false, true);
+        }
+        else if (dataStr[0] != '-')
+        {
+            // The values which are truncated towards zero to the written value
+            range[0] = ToInnerBound<T>(exactValue, true, false);
+            range[1] = ToInnerBound<T>(exactValue + unit, false, true);
+        }
+        else
+        {
+            range[0] = ToInnerBound<T>(exactValue - unit, true, true);
+            range[1] = ToInnerBound<T>(exactValue, false, false);
+        }
+    }
+}
+
+// Parses the value, and the high bound for the ranges, into dataValues
+// Returns the comparison which the values are scanned with, the tolerances are scanned as ranges
+// secondStr is the high bound of the range comparisons or the tolerance, and is ignored by the
+// other comparisons
+template <typename T>
+ComparisonType ParseScanValues(const std::string& dataStr, const std::string& secondStr, ComparisonType cmpType,
+        T dataValues[2])
+{
+    dataValues[0] = Utils::StrToNumber<T>(dataStr);
+    dataValues[1] = 0;
+    if (IsToleranceComparison(cmpType))
+    {
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            ToleranceToRange<T>(cmpType, dataStr, secondStr, dataValues);
+            cmpType = ComparisonType::Between;
+        }
+        else
+        {
+            throw std::runtime_error("Tolerances can only be used with floats.");
+        }
+    }
+    else if (IsRangeComparison(cmpType))
+    {
+        dataValues[1] = Utils::StrToNumber<T>(secondStr, "high bound");
+        if (dataValues[1] < dataValues[0])
+        {
+            throw std::runtime_error("The low bound is greater than the high bound.");
+        }
+    }
+    return cmpType;
+}
+
+// The bounds of big-endian values are calculated in the native order and then swapped
+template <typename T> requires IsBigEndian<T>
+ComparisonType ParseScanValues(const std::string& dataStr, const std::string& secondStr, ComparisonType cmpType,
+        T dataValues[2])
+{
+    typename T::ValueType nativeValues[2];
+    cmpType = ParseScanValues(dataStr, secondStr, cmpType, nativeValues);
+    dataValues[0] = T(nativeValues[0]);
+    dataValues[1] = T(nativeValues[1]);
+    return cmpType;
+}
+
 template <typename T>
-size_t ScanForData(Process& proc, const std::string& dataStr, ComparisonType cmpType)
+size_t ScanForData(Process& proc, const std::string& dataStr, const std::string& secondStr, ComparisonType cmpType)
 {
     constexpr size_t dataSize = sizeof(T);
-    T dataValue = Utils::StrToNumber<T>(dataStr);
+    // The ranges are passed as the low bound followed by the high bound
+    T dataValues[2];
+    cmpType = ParseScanValues<T>(dataStr, secondStr, cmpType, dataValues);
 
-    return CallScanner<T>(proc, dataSize, (void*)&dataValue, cmpType);
+    return CallScanner<T>(proc, dataSize, (void*)dataValues, cmpType);
 }
 
 template <>
-size_t ScanForData<std::string>(Process& proc, const std::string& dataStr, ComparisonType cmpType)
+size_t ScanForData<std::string>(Process& proc, const std::string& dataStr, const std::string&, ComparisonType cmpType)
 {
     return CallScanner<std::string>(proc, dataStr.size(), (void*)dataStr.c_str(), cmpType);
 }
 
-static void ListSavedAddresses(const std::vector<MemAddress>& memAddrs)
+// The values are given as pairs of <type> <value>, an address is kept if any of them is found there
+static size_t ScanForMultipleValues(Process& proc, const std::vector<std::string>& args, ComparisonType cmpType)
+{
+    if (args.size() < 5 || (args.size() - 3) % 2 != 0)
+    {
+        throw std::runtime_error("Expected pairs of <type> <value>.");
+    }
+
+    std::vector<std::vector<uint8_t>> needles;
+    for (size_t i = 3; i < args.size(); i += 2)
+    {
+        needles.push_back(Utils::DataToByteVector(ParseDataType(args[i]), args[i + 1]));
+    }
+
+    const MultiMatcher matcher(needles);
+    return CallScanner<MultiMatcher>(proc, matcher.GetMaxNeedleSize(), &matcher, cmpType);
+}
+
+template <typename T>
+static TypedValue MakeTypedValue(DataType dataType, const std::string& dataStr, const std::string& secondStr, 
+        ComparisonType cmpType)
 {
+    T dataValues[2];
+    cmpType = ParseScanValues<T>(dataStr, secondStr, cmpType, dataValues);
+
+    TypedValue value = { dataType, cmpType, {} };
+    std::memcpy(value.data, dataValues, sizeof(dataValues));
+    return value;
+}
+
+static TypedValue ParseTypedValue(DataType dataType, const std::string& dataStr, const std::string& secondStr, 
+        ComparisonType cmpType)
+{
+    switch (dataType)
+    {
+        case DataType::int8:      return MakeTypedValue<int8_t>(dataType, dataStr, secondStr, cmpType);
+        case DataType::int16:     return MakeTypedValue<int16_t>(dataType, dataStr, secondStr, cmpType);
+        case DataType::int32:     return MakeTypedValue<int32_t>(dataType, dataStr, secondStr, cmpType);
+        case DataType::int64:     return MakeTypedValue<int64_t>(dataType, dataStr, secondStr, cmpType);
+        case DataType::uint8:     return MakeTypedValue<uint8_t>(dataType, dataStr, secondStr, cmpType);
+        case DataType::uint16:    return MakeTypedValue<uint16_t>(dataType, dataStr, secondStr, cmpType);
+        case DataType::uint32:    return MakeTypedValue<uint32_t>(dataType, dataStr, secondStr, cmpType);
+        case DataType::uint64:    return MakeTypedValue<uint64_t>(dataType, dataStr, secondStr, cmpType);
+        case DataType::f32:       return MakeTypedValue<float>(dataType, dataStr, secondStr, cmpType);
+        case DataType::f64:       return MakeTypedValue<double>(dataType, dataStr, secondStr, cmpType);
+        case DataType::be_int16:  return MakeTypedValue<BigEndian<int16_t>>(dataType, dataStr, secondStr, cmpType);
+        case DataType::be_int32:  return MakeTypedValue<BigEndian<int32_t>>(dataType, dataStr, secondStr, cmpType);
+        case DataType::be_int64:  return MakeTypedValue<BigEndian<int64_t>>(dataType, dataStr, secondStr, cmpType);
+        case DataType::be_uint16: return MakeTypedValue<BigEndian<uint16_t>>(dataType, dataStr, secondStr, cmpType);
+        case DataType::be_uint32: return MakeTypedValue<BigEndian<uint32_t>>(dataType, dataStr, secondStr, cmpType);
+        case DataType::be_uint64: return MakeTypedValue<BigEndian<uint64_t>>(dataType, dataStr, secondStr, cmpType);
+        case DataType::be_f32:    return MakeTypedValue<BigEndian<float>>(dataType, dataStr, secondStr, cmpType);
+        case DataType::be_f64:    return MakeTypedValue<BigEndian<double>>(dataType, dataStr, secondStr, cmpType);
+        default: throw std::invalid_argument("Only numeric types can be compared as typed values.");
+    }
+}
+
+// Adds the value as the type T, if it can be parsed as T
+template <typename T>
+static void AddTypedValue(std::vector<TypedValue>& values, DataType dataType, 
+        const std::string& dataStr, const std::string& secondStr, ComparisonType cmpType)
+{
+    if (IsToleranceComparison(cmpType) && !std::is_floating_point_v<T>)
+    {
+        return;
+    }
+
+    try
+    {
+        values.push_back(MakeTypedValue<T>(dataType, dataStr, secondStr, cmpType));
+    }
+    // The value doesn't fit in the type
+    catch (const std::exception&)
+    {
+        return;
+    }
+}
+
+static bool HasValueOfType(const std::vector<TypedValue>& values, DataType dataType)
+{
+    return std::any_of(values.cbegin(), values.cend(), 
+            [=](const TypedValue& value) { return value.dataType == dataType; });
+}
+
+// The value is compared as every numeric type it can be parsed as, in a single pass
+static size_t ScanForAnyType(Process& proc, const std::string& dataStr, const std::string& secondStr, 
+        ComparisonType cmpType)
+{
+    std::vector<TypedValue> values;
+    AddTypedValue<int8_t>(values, DataType::int8, dataStr, secondStr, cmpType);
+    AddTypedValue<int16_t>(values, DataType::int16, dataStr, secondStr, cmpType);
+    AddTypedValue<int32_t>(values, DataType::int32, dataStr, secondStr, cmpType);
+    AddTypedValue<int64_t>(values, DataType::int64, dataStr, secondStr, cmpType);
+
+    // With == and != an unsigned type compares the same bytes as the signed type of the same size,
+    // so it is only needed for the values which don't fit in the signed type
+    const bool skipSignedTwins = cmpType == ComparisonType::Equal || cmpType == ComparisonType::NotEqual;
+    if (!skipSignedTwins || !HasValueOfType(values, DataType::int8))
+    {
+        AddTypedValue<uint8_t>(values, DataType::uint8, dataStr, secondStr, cmpType);
+    }
+    if (!skipSignedTwins || !HasValueOfType(values, DataType::int16))
+    {
+        AddTypedValue<uint16_t>(values, DataType::uint16, dataStr, secondStr, cmpType);
+    }
+    if (!skipSignedTwins || !HasValueOfType(values, DataType::int32))
+    {
+        AddTypedValue<uint32_t>(values, DataType::uint32, dataStr, secondStr, cmpType);
+    }
+    if (!skipSignedTwins || !HasValueOfType(values, DataType::int64))
+    {
+        AddTypedValue<uint64_t>(values, DataType::uint64, dataStr, secondStr, cmpType);
+    }
+
+    AddTypedValue<float>(values, DataType::f32, dataStr, secondStr, cmpType);
+    AddTypedValue<double>(values, DataType::f64, dataStr, secondStr, cmpType);
+    if (values.empty())
+    {
+        throw std::runtime_error("The value can't be compared as any numeric type.");
+    }
+
+    MemoryScanner& memScanner = proc.GetMemoryScanner();
+    if (memScanner.GetScanStartedFlag())
+    {
+        return memScanner.NextScanAnyType(values);
+    }
+    else
+    {
+        return memScanner.NewScanAnyType(proc.GetMemoryRegions(), values);
+    }
+}
+
+// The fields are separated by commas, and each one is written as
+// +<offset> <type> <comparison> <value> [high bound / tolerance]
+static size_t ScanForStruct(Process& proc, const std::vector<std::string>& args)
+{
+    if (args.size() < 6)
+    {
+        throw std::runtime_error("Missing arguments for scanning.");
+    }
+
+    std::vector<StructField> fields;
+    for (const std::string& fieldStr : Utils::SplitString(Utils::JoinVectorOfStrings(args, 2, ' '), ','))
+    {
+        const std::vector<std::string> tokens = Utils::SplitString(fieldStr, ' ');
+        if (tokens.size() < 4)
+        {
+            throw std::runtime_error(fmt::format("Missing arguments in the field '{}'.", fieldStr));
+        }
+
+        const std::string offsetStr = tokens[0][0] == '+' ? tokens[0].substr(1) : tokens[0];
+        const size_t offset = Utils::StrToNumber<size_t>(offsetStr, "offset");
+        const DataType dataType = ParseDataType(tokens[1]);
+        const ComparisonType cmpType = ParseComparisonType(tokens[2]);
+        const std::string secondStr = tokens.size() > 4 ? tokens[4] : "";
+        if ((IsRangeComparison(cmpType) || cmpType == ComparisonType::Ulps) && secondStr.empty())
+        {
+            throw std::runtime_error(fmt::format("Missing arguments in the field '{}'.", fieldStr));
+        }
+        fields.push_back({ offset, ParseTypedValue(dataType, tokens[3], secondStr, cmpType) });
+    }
+
+    const StructPattern pattern(fields);
+    return CallScanner<StructPattern>(proc, pattern.GetSize(), &pattern, ComparisonType::Equal);
+}
+
+// scan filter <type> <expression>, the expression may contain spaces
+static size_t FilterSavedAddresses(Process& proc, const std::vector<std::string>& args)
+{
+    if (args.size() < 4)
+    {
+        throw std::runtime_error("Missing arguments for filtering.");
+    }
+
+    MemoryScanner& memScanner = proc.GetMemoryScanner();
+    if (!memScanner.GetScanStartedFlag())
+    {
+        throw std::runtime_error("A filter can only be used after a scan.");
+    }
+
+    FilterExpression filter(Utils::JoinVectorOfStrings(args, 3, ' '), ParseDataType(args[2]));
+    return memScanner.NextScanFilter(filter);
+}
+
+template <>
+size_t ScanForData<AobPattern>(Process& proc, const std::string& dataStr, const std::string&, ComparisonType cmpType)
+{
+    const AobPattern pattern(dataStr);
+    return CallScanner<AobPattern>(proc, pattern.GetSize(), &pattern, cmpType);
+}
+
+static void ListSavedAddresses(const MemoryScanner& memScanner)
+{
+    const std::vector<MemAddress>& memAddrs = memScanner.GetCurrScanVector();
+    const std::vector<DataType>& dataTypes = memScanner.GetCurrScanTypes();
     if (memAddrs.empty())
     {
         throw std::runtime_error("No memory addresses to list.");
     }
-    else
+    else if (dataTypes.empty())
     {
         Utils::PrintMemoryAddresses(memAddrs);
     }
+    else
+    {
+        // The addresses found by a scan of any type are tagged with their type
+        const size_t indexWidth = std::to_string(memAddrs.size()).size();
+        for (size_t i = 0; i < memAddrs.size(); i++)
+        {
+            fmt::print("[{:{}}] {:#018x} [{}] (in {}) [{}]\n", i, indexWidth, memAddrs[i].address, 
+                    memAddrs[i].memRegion.permsStr, memAddrs[i].memRegion.pathName, DataTypeToString(dataTypes[i]));
+        }
+    }
 }
 
 static void WriteToSavedAddresses(Process& proc, const std::vector<std::string>& args)
 {
-    // This is the vector of arguments which will be passed to the write command
-    // the first argument is always the command name
-    // the second argument is the address (it will be updated inside the loop)
-    // the third argument is the type of the data
-    // the fourth argument is the data itself
     // Scan command syntax: scan write <type> <data>
     if (args.size() < 4)
     {
         throw std::runtime_error("Missing arguments.");
     }
-    std::vector<std::string> writeCmdArgs = { "write", "", args[2], args[3] };
 
-    auto memAddrs = proc.GetMemoryScanner().GetCurrScanVector();
-    int writeSuccess = 0; // Tracks how many addresses were written to
+    // The data is converted only once, and the same buffer is written to every address
+    const std::vector<uint8_t> byteVector = Utils::DataToByteVector(ParseDataType(args[2]), args[3]);
+
+    const std::vector<MemAddress>& memAddrs = proc.GetMemoryScanner().GetCurrScanVector();
+    std::vector<MemIoRequest> requests;
+    requests.reserve(memAddrs.size());
 
     for (auto it = memAddrs.cbegin(); it != memAddrs.cend(); it++)
     {
@@ -76,17 +434,25 @@ static void WriteToSavedAddresses(Process& proc, const std::vector<std::string>&
         {
             continue;
         }
+        requests.push_back({ it->address, byteVector.size(), (void*)byteVector.data(), 0 });
+    }
 
-        writeCmdArgs[1] = std::to_string(it->address);       
-
-        try
-        {
-            WriteCommand::Main(proc, writeCmdArgs);
-            writeSuccess++;
-        }
-        catch (const std::exception& e)
+    // All the addresses are written with as few syscalls as possible
+    const size_t writeSuccess = MemoryFuncs::WriteToProcessMemoryBatch(proc.GetCurrentPid(), requests);
+    if (writeSuccess != requests.size())
+    {
+        for (const MemIoRequest& req : requests)
         {
-            fmt::print(stderr, "Error writing to address {:#018x}: {}\n", it->address, e.what());
+            if (req.result < 0)
+            {
+                fmt::print(stderr, "Error writing to address {:#018x}: {}\n", 
+                        req.address, MemoryFuncs::GetErrorMessage(-req.result));
+            }
+            else if (req.result != (ssize_t)req.length)
+            {
+                fmt::print("WARNING: Partial write of {}/{} bytes at address {:#018x}.\n",
+                        req.result, req.length, req.address);
+            }
         }
     }
     fmt::print("Written to {}/{} memory addresses.\n", writeSuccess, memAddrs.size());
@@ -111,32 +477,14 @@ static void AddScanListToFreezeList(Process& proc, const std::vector<std::string
     // No error handling since the argument is optional
     catch (const std::out_of_range&) {}
 
-    // The third element is the address which will be modified inside the loop
-    std::vector<std::string> freezeCmdArgs = { "freeze", "add", "", args[2], args[3], note }; 
-
-    auto memAddrs = proc.GetMemoryScanner().GetCurrScanVector();
-    int success = 0;
+    const std::string& typeStr = args[2];
+    const std::string& dataStr = args[3];
+    const std::vector<uint8_t> data = Utils::DataToByteVector(ParseDataType(typeStr), dataStr);
 
-    for (auto it = memAddrs.cbegin(); it != memAddrs.cend(); it++)
-    {
-        // Skip addresses without the write flag enabled
-        if (!it->memRegion.perms.writeFlag)
-        {
-            continue;
-        }
+    // The memory regions were attached to the addresses during the scan
+    const auto& memAddrs = proc.GetMemoryScanner().GetCurrScanVector();
+    const size_t success = proc.GetMemoryFreezer().AddAddresses(memAddrs, typeStr, dataStr, data, note);
 
-        freezeCmdArgs[2] = std::to_string(it->address);
-
-        try
-        {
-            FreezeCommand::Main(proc, freezeCmdArgs);
-            success++;
-        }
-        catch (const std::exception& e)
-        {
-            fmt::print(stderr, "Error adding address {:#018x}: {}\n", it->address, e.what());
-        }
-    }
     fmt::print("Added {}/{} addresses to the freeze list.\n", success, memAddrs.size());
 }
 
@@ -158,7 +506,7 @@ void ScanCommand::Main(Process& proc, const std::vector<std::string>& args)
     }
     else if (keywordStr == "list")
     {
-        ListSavedAddresses(proc.GetMemoryScanner().GetCurrScanVector());
+        ListSavedAddresses(proc.GetMemoryScanner());
     }
     else if (keywordStr == "write")
     {
@@ -168,14 +516,23 @@ void ScanCommand::Main(Process& proc, const std::vector<std::string>& args)
     {
         AddScanListToFreezeList(proc, args);
     }
+    else if (keywordStr == "struct")
+    {
+        fmt::print("{} addresses found.\n", ScanForStruct(proc, args));
+    }
+    else if (keywordStr == "filter")
+    {
+        fmt::print("{} addresses found.\n", FilterSavedAddresses(proc, args));
+    }
     else
     {
         // ParseComparisonType will throw if the keyword is incorrect or doesn't exist
         ComparisonType cmpType = ParseComparisonType(keywordStr);
 
         // Check if enough arguments were given
-        // scan <keyword> <type> <value>
-        if (args.size() < 4)
+        // scan <keyword> <type> <value>, or scan <keyword> <type> <low> <high> for the ranges
+        const bool needsSecondArg = IsRangeComparison(cmpType) || cmpType == ComparisonType::Ulps;
+        if (args.size() < 4 || (needsSecondArg && args.size() < 5))
         {
             throw std::runtime_error("Missing arguments for scanning.");
         }
@@ -183,19 +540,42 @@ void ScanCommand::Main(Process& proc, const std::vector<std::string>& args)
         size_t resAmount = 0;
         const std::string& typeStr = args[2];
         const std::string& dataStr = args[3];
+        // The epsilon of ~ is optional
+        const bool hasSecondArg = needsSecondArg || (cmpType == ComparisonType::Approximate && args.size() > 4);
+        const std::string secondStr = hasSecondArg ? args[4] : "";
+        if (typeStr == "multi")
+        {
+            fmt::print("{} addresses found.\n", ScanForMultipleValues(proc, args, cmpType));
+            return;
+        }
+        else if (typeStr == "any")
+        {
+            fmt::print("{} addresses found.\n", ScanForAnyType(proc, dataStr, secondStr, cmpType));
+            return;
+        }
+
         switch (ParseDataType(typeStr))
         {
-            case DataType::int8:   resAmount = ScanForData<int8_t>(proc, dataStr, cmpType);      break;
-            case DataType::int16:  resAmount = ScanForData<int16_t>(proc, dataStr, cmpType);     break;
-            case DataType::int32:  resAmount = ScanForData<int32_t>(proc, dataStr, cmpType);     break;
-            case DataType::int64:  resAmount = ScanForData<int64_t>(proc, dataStr, cmpType);     break;
-            case DataType::uint8:  resAmount = ScanForData<uint8_t>(proc, dataStr, cmpType);     break;
-            case DataType::uint16: resAmount = ScanForData<uint16_t>(proc, dataStr, cmpType);    break;
-            case DataType::uint32: resAmount = ScanForData<uint32_t>(proc, dataStr, cmpType);    break;
-            case DataType::uint64: resAmount = ScanForData<uint64_t>(proc, dataStr, cmpType);    break;
-            case DataType::f32:    resAmount = ScanForData<float>(proc, dataStr, cmpType);       break;
-            case DataType::f64:    resAmount = ScanForData<double>(proc, dataStr, cmpType);      break;
-            case DataType::string: resAmount = ScanForData<std::string>(proc, dataStr, cmpType); break;
+            case DataType::int8:   resAmount = ScanForData<int8_t>(proc, dataStr, secondStr, cmpType);      break;
+            case DataType::int16:  resAmount = ScanForData<int16_t>(proc, dataStr, secondStr, cmpType);     break;
+            case DataType::int32:  resAmount = ScanForData<int32_t>(proc, dataStr, secondStr, cmpType);     break;
+            case DataType::int64:  resAmount = ScanForData<int64_t>(proc, dataStr, secondStr, cmpType);     break;
+            case DataType::uint8:  resAmount = ScanForData<uint8_t>(proc, dataStr, secondStr, cmpType);     break;
+            case DataType::uint16: resAmount = ScanForData<uint16_t>(proc, dataStr, secondStr, cmpType);    break;
+            case DataType::uint32: resAmount = ScanForData<uint32_t>(proc, dataStr, secondStr, cmpType);    break;
+            case DataType::uint64: resAmount = ScanForData<uint64_t>(proc, dataStr, secondStr, cmpType);    break;
+            case DataType::f32:    resAmount = ScanForData<float>(proc, dataStr, secondStr, cmpType);       break;
+            case DataType::f64:    resAmount = ScanForData<double>(proc, dataStr, secondStr, cmpType);      break;
+            case DataType::string: resAmount = ScanForData<std::string>(proc, dataStr, secondStr, cmpType); break;
+            case DataType::aob:    resAmount = ScanForData<AobPattern>(proc, dataStr, secondStr, cmpType);  break;
+            case DataType::be_int16:  resAmount = ScanForData<BigEndian<int16_t>>(proc, dataStr, secondStr, cmpType);  break;
+            case DataType::be_int32:  resAmount = ScanForData<BigEndian<int32_t>>(proc, dataStr, secondStr, cmpType);  break;
+            case DataType::be_int64:  resAmount = ScanForData<BigEndian<int64_t>>(proc, dataStr, secondStr, cmpType);  break;
+            case DataType::be_uint16: resAmount = ScanForData<BigEndian<uint16_t>>(proc, dataStr, secondStr, cmpType); break;
+            case DataType::be_uint32: resAmount = ScanForData<BigEndian<uint32_t>>(proc, dataStr, secondStr, cmpType); break;
+            case DataType::be_uint64: resAmount = ScanForData<BigEndian<uint64_t>>(proc, dataStr, secondStr, cmpType); break;
+            case DataType::be_f32:    resAmount = ScanForData<BigEndian<float>>(proc, dataStr, secondStr, cmpType);    break;
+            case DataType::be_f64:    resAmount = ScanForData<BigEndian<double>>(proc, dataStr, secondStr, cmpType);   break;
         }
         fmt::print("{} addresses found.\n", resAmount);
     }
@@ -221,8 +601,38 @@ std::string ScanCommand::Help()
         "< -- Scans for addresses where the value is less than the given <value>.\n"
         ">= -- Scans for addresses where the value is greater or equal to <value>\n"
         "<= -- Scans for addresses where the value is less or equal to <value>.\n"
+        "between -- Takes <low> <high> in place of <value>, and scans for addresses where the value is\n"
+            "\tbetween them (inclusive).\n"
+        "outside -- Takes <low> <high> in place of <value>, and scans for addresses where the value is\n"
+            "\tlower than <low> or greater than <high>.\n"
+        "~ -- Takes <value> [epsilon], and scans for addresses where the value is within epsilon of\n"
+            "\t<value>. The default epsilon is one unit of the last decimal of <value>.\n"
+        "ulps -- Takes <value> <ulps>, and scans for addresses where the value is at most <ulps>\n"
+            "\trepresentable floats away from <value>.\n"
+        "rounded -- Scans for addresses where the value rounds to <value> with as many decimals as\n"
+            "\t<value> is written with.\n"
+        "truncated -- Like rounded, but for values which are truncated towards zero.\n"
+        "struct -- Takes fields separated by commas in place of <type> <value>, and scans for the addresses\n"
+            "\twhere all the fields compare true. A field is written as +<offset> <type> <keyword> <value>,\n"
+            "\twith the keywords and values of the scans above, e.g.\n"
+            "\tscan struct +0 int32 == 100, +8 float > 1.0, +16 uint64 != 0\n"
+            "\tThe most selective field is compared first, and the others only where it matched. The offsets\n"
+            "\tcan be at most 4096.\n"
+        "filter -- Takes an expression in place of <value>, and keeps the saved addresses where it is\n"
+            "\ttrue. The expression is written like a condition in C with the names value, old (the value\n"
+            "\tin the previous scan), addr and <type>[<offset>] (a field near the address), e.g.\n"
+            "\tscan filter int32 value > old && value - old <= 5\n"
+            "\tscan filter uint32 (value & 0xFF00) == 0x1200 && float[+8] > 1.0\n"
         "write -- Writes the <value> with the given <type> to all the saved memory addresses.\n"
         "freeze -- Adds all the writable addressses in the scan list to the freeze list.\n"
-            "\tAn optional note can be added as well as another argument after <value>.\n");
+            "\tAn optional note can be added as well as another argument after <value>.\n\n"
+
+        "The types are the same as in the find command. Strings and byte patterns (aob) can only be\n"
+        "scanned with ==, and ~, ulps, rounded and truncated can only be used with floats.\n"
+        "== also accepts 'multi' as the type followed by pairs of <type> <value>, which keeps the addresses\n"
+        "where any of the values is found.\n"
+        "The type 'any' compares the value as every numeric type it fits in, in a single pass where each\n"
+        "type is compared at the addresses aligned to its size. The addresses keep the type they were\n"
+        "found as, which is shown by list and used by the next scans of type 'any'.\n");
 }
 
@@ -0,0 +1,70 @@
+#include "cmds/SigmakeCommand.h"
+#include <chrono>
+#include <stdexcept>
+#include <fmt/core.h>
+#include "AobPattern.h"
+#include "SignatureMaker.h"
+#include "Utils.h"
+
+void SigmakeCommand::Main(Process& proc, const std::vector<std::string>& args)
+{
+    if (args.size() < 2)
+    {
+        throw std::runtime_error("Missing arguments.");
+    }
+
+    const unsigned long address = Utils::StrToNumber<unsigned long>(args[1], "address");
+    size_t maxSize = SignatureMaker::DEFAULT_MAX_SIGNATURE_SIZE;
+    if (args.size() > 2)
+    {
+        maxSize = Utils::StrToNumber<size_t>(args[2], "size");
+        if (maxSize == 0 || maxSize > SignatureMaker::MAX_SIGNATURE_SIZE)
+        {
+            throw std::runtime_error(fmt::format("The size must be between 1 and {}.", SignatureMaker::MAX_SIGNATURE_SIZE));
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const SignatureResult result = SignatureMaker::MakeSignature(proc.GetCurrentPid(), proc.GetMemoryRegions(), 
+            address, maxSize);
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    if (result.bytes.empty())
+    {
+        throw std::runtime_error("No pattern could be made from the memory at the address.");
+    }
+    const std::string patternStr = AobPattern(result.bytes, result.mask).ToString();
+    if (!result.unique)
+    {
+        fmt::print("No unique pattern of up to {} bytes was found, the longest pattern was found {} times in {}:\n{}\n", 
+                maxSize, result.matches, result.scopeName, patternStr);
+        return;
+    }
+
+    fmt::print("Found a unique pattern of {} bytes in {} in {:.1f}ms:\n{}\n", result.bytes.size(), 
+            result.scopeName, ms, patternStr);
+    // Modules are matched by name, so the pattern can be found after the module is loaded elsewhere
+    if (result.scopeName[0] == '/')
+    {
+        const std::string moduleName = result.scopeName.substr(result.scopeName.rfind('/') + 1);
+        fmt::print("It can be found with: find --module \"{}\" aob \"{}\"\n", moduleName, patternStr);
+    }
+}
+
+std::string SigmakeCommand::Help()
+{
+    return std::string(
+        "Usage: sigmake <address> [max size]\n\n"
+
+        "Makes the shortest byte pattern which starts at the address and is found only once in the module\n"
+        "of the address, so that the address can be found again after the module changes. Addresses which\n"
+        "aren't in a module only get a pattern which is unique in their memory region.\n\n"
+
+        "In executable memory the pattern grows one instruction at a time, and the bytes which change\n"
+        "when the module is rebuilt or loaded elsewhere are wildcards: rip-relative displacements,\n"
+        "the targets of relative jumps and calls, and values which point into mapped memory.\n"
+        "In other memory the pattern grows 8 bytes at a time, and pointers are wildcards.\n\n"
+
+        "The pattern is at most [max size] bytes long, 64 by default and up to 256.\n"
+        "The pattern is in the format of the aob type, see the find command.\n");
+}
@@ -0,0 +1,60 @@
+#include "cmds/SnapshotCommand.h"
+#include <chrono>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <thread>
+#include <fmt/core.h>
+#include "Snapshot.h"
+#include "Utils.h"
+
+constexpr unsigned int MAX_SNAPSHOT_THREADS = 64;
+
+void SnapshotCommand::Main(Process& proc, const std::vector<std::string>& args)
+{
+    if (args.size() < 2)
+    {
+        throw std::runtime_error("Missing arguments.");
+    }
+
+    const std::string& path = args[1];
+    unsigned int threadCount = std::thread::hardware_concurrency();
+    if (args.size() > 2)
+    {
+        threadCount = Utils::StrToNumber<unsigned int>(args[2], "thread amount");
+        if (threadCount == 0 || threadCount > MAX_SNAPSHOT_THREADS)
+        {
+            throw std::runtime_error(fmt::format("The amount of threads must be between 1 and {}.", MAX_SNAPSHOT_THREADS));
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const Snapshot::CaptureStats stats = Snapshot::Capture(proc.GetCurrentPid(), proc.GetMemoryRegions(), 
+            path, threadCount);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // The zero pages are holes, so the file usually takes much less disk space than its size
+    struct stat fileStat = {};
+    stat(path.c_str(), &fileStat);
+
+    fmt::print("Captured {} memory regions ({} bytes) in {:.2f}s.\n", stats.regionsCaptured, stats.bytesRead, seconds);
+    fmt::print("Snapshot '{}' takes {} bytes on disk, {} bytes of data were not zero pages.\n", 
+            path, (uint64_t)fileStat.st_blocks * 512, stats.bytesWritten);
+    if (stats.regionsIncomplete != 0)
+    {
+        fmt::print("WARNING: {} memory regions could not be fully read, the missing parts are zeros.\n", 
+                stats.regionsIncomplete);
+    }
+}
+
+std::string SnapshotCommand::Help()
+{
+    return std::string(
+        "Usage: snapshot <file> [threads]\n\n"
+
+        "Saves the memory of all the readable memory regions of the process to a file.\n"
+        "The regions are read in parallel, by default with a thread for every CPU core.\n\n"
+
+        "The file holds the memory regions map along with the data, and pages which are all zeros\n"
+        "are left as holes in the file so that they don't take disk space.\n");
+}
+
@@ -21,6 +21,21 @@ void WriteData(pid_t pid, unsigned long baseAddr, const std::string& dataStr)
     }
 }
 
+// Accepts byte patterns without wildcards
+template <>
+void WriteData<AobPattern>(pid_t pid, unsigned long baseAddr, const std::string& dataStr)
+{
+    std::vector<uint8_t> bytes = Utils::DataToByteVector<AobPattern>(dataStr);
+    const long bytesSize = bytes.size();
+
+    ssize_t nread = MemoryFuncs::WriteToProcessMemory(pid, baseAddr, bytesSize, bytes.data());
+    if (nread != bytesSize)
+    {
+        fmt::print("WARNING: Partial write of {}/{} bytes at address {:#018x}.\n",
+                nread, bytesSize, baseAddr);
+    }
+}
+
 // Accepts string
 template <>
 void WriteData<std::string>(pid_t pid, unsigned long baseAddr, const std::string& dataStr)
@@ -61,6 +76,15 @@ void WriteCommand::Main(Process& proc, const std::vector<std::string>& args)
         case DataType::f32:    WriteData<float>(pid, baseAddr, dataStr);       break;
         case DataType::f64:    WriteData<double>(pid, baseAddr, dataStr);      break;
         case DataType::string: WriteData<std::string>(pid, baseAddr, dataStr); break;
+        case DataType::aob:    WriteData<AobPattern>(pid, baseAddr, dataStr);  break;
+        case DataType::be_int16:  WriteData<BigEndian<int16_t>>(pid, baseAddr, dataStr);  break;
+        case DataType::be_int32:  WriteData<BigEndian<int32_t>>(pid, baseAddr, dataStr);  break;
+        case DataType::be_int64:  WriteData<BigEndian<int64_t>>(pid, baseAddr, dataStr);  break;
+        case DataType::be_uint16: WriteData<BigEndian<uint16_t>>(pid, baseAddr, dataStr); break;
+        case DataType::be_uint32: WriteData<BigEndian<uint32_t>>(pid, baseAddr, dataStr); break;
+        case DataType::be_uint64: WriteData<BigEndian<uint64_t>>(pid, baseAddr, dataStr); break;
+        case DataType::be_f32:    WriteData<BigEndian<float>>(pid, baseAddr, dataStr);    break;
+        case DataType::be_f64:    WriteData<BigEndian<double>>(pid, baseAddr, dataStr);   break;
         // No default: so that the compiler can generate a warning for us in case we forget something.
     }
 }
@@ -75,10 +99,12 @@ std::string WriteCommand::Help()
         "The <address> must be in hexadecimal.\n\n"
 
         "The <type> argument can be one of the following:\n"
-        "[u]int8, [u]int16, [u]int32, [u]int64, float, double, string\n"
-        "The 'u' prefix tells the program to use the unsigned type.\n\n"
+        "[u]int8, [u]int16, [u]int32, [u]int64, float, double, string, aob\n"
+        "The 'u' prefix tells the program to use the unsigned type.\n"
+        "The 'be' prefix makes the types other than [u]int8, string and aob big-endian, e.g. beuint32, befloat.\n\n"
 
         "Data for [u]int8, [u]int16, [u]int32, [u]int64 can be written as decimal numbers or hexadecimal numbers.\n"
         "Data for float and double can be written as floating point numbers or hexadecimal numbers.\n"
-        "Data for string can only be a string.\n");
+        "Data for string can only be a string.\n"
+        "Data for aob is a pattern of hex bytes without wildcards, e.g. \"90 90 90\".\n");
 }